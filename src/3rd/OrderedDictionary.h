@@ -104,6 +104,15 @@ NS_ASSUME_NONNULL_BEGIN
 /** Removes the nth object in the dictionary. */
 - (void)removeObjectAtIndex:(NSUInteger)index;
 
+/**
+ * Appends an entry without first looking up the key, for callers that know each
+ * key is only added once (e.g. IDs). Adding an existing key is a programming
+ * error. Nil objects are ignored, matching setValue:forKey:.
+ */
+- (void)appendObject:(nullable ObjectType)object forUniqueKey:(KeyType)key;
+/** Appends entries for keys known to be unique and not already present, see appendObject:forUniqueKey: */
+- (void)appendObjects:(NSArray<ObjectType> *)objects forUniqueKeys:(NSArray<KeyType> *)keys;
+
 @end
 
 NS_ASSUME_NONNULL_END
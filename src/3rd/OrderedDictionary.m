@@ -482,6 +482,29 @@
     [self setObject:object forKey:key];
 }
 
+// Music Library Exporter: append-only fast paths, skipping the key lookup done by setObject:forKey:
+
+- (void)appendObject:(id)object forUniqueKey:(id)key
+{
+    if (!object)
+    {
+        return;
+    }
+    __unused NSUInteger count = _mutableKeys.count;
+    [_mutableKeys addObject:key];
+    NSAssert(_mutableKeys.count == count + 1, @"appendObject:forUniqueKey: called with existing key %@", key);
+    [_mutableValues addObject:object];
+}
+
+- (void)appendObjects:(NSArray *)objects forUniqueKeys:(NSArray *)keys
+{
+    NSAssert(objects.count == keys.count, @"appendObjects:forUniqueKeys: requires one key per object");
+    __unused NSUInteger count = _mutableKeys.count;
+    [_mutableKeys addObjectsFromArray:keys];
+    NSAssert(_mutableKeys.count == count + keys.count, @"appendObjects:forUniqueKeys: called with existing or duplicate keys");
+    [_mutableValues addObjectsFromArray:objects];
+}
+
 @end
 
 
@@ -0,0 +1,75 @@
+//
+//  ExportBenchmark.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+@class LibrarySnapshot;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Timing + memory measurements for a single export stage
+@interface ExportBenchmarkStageResult : NSObject
+
+@property (copy) NSString* name;
+
+// Number of tracks or playlists processed in each iteration
+@property NSUInteger itemCount;
+@property NSUInteger iterations;
+
+@property NSTimeInterval medianDuration;
+@property NSTimeInterval bestDuration;
+
+// Net growth in live heap size over the median iteration, measured before the stage's autorelease pool drains.
+// Memory allocated and freed within the stage is not included, so this is not a measure of allocation volume.
+@property unsigned long long heapGrowthBytes;
+@property unsigned long long heapGrowthBlocks;
+
+// Process-wide peak resident size after the stage has completed
+@property unsigned long long peakResidentBytes;
+
+- (double)itemsPerSecond;
+
+- (NSString*)describe;
+
+@end
+
+
+// Runs each stage of an export against a library file for a number of iterations.
+//
+// The library is loaded into a `LibrarySnapshot`, so runs are reproducible and never touch the user's Music library.
+@interface ExportBenchmark : NSObject
+
+extern NSErrorDomain const __MLE_ErrorDomain_ExportBenchmark;
+
+typedef NS_ENUM(NSUInteger, ExportBenchmarkErrorCode) {
+  ExportBenchmarkErrorLoadFailed = 0,
+  ExportBenchmarkErrorExportFailed,
+};
+
+
+#pragma mark - Properties
+
+@property (readonly) NSURL* libraryURL;
+
+@property NSUInteger iterations;
+
+@property (copy) NSDictionary* customSortProperties;
+@property (copy) NSDictionary* customSortOrders;
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithLibraryURL:(NSURL*)libraryURL;
+
+
+#pragma mark - Mutators
+
+- (nullable NSArray<ExportBenchmarkStageResult*>*)runAndReturnError:(NSError**)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
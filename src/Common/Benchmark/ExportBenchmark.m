@@ -0,0 +1,343 @@
+//
+//  ExportBenchmark.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "ExportBenchmark.h"
+
+#import <malloc/malloc.h>
+#import <sys/resource.h>
+#import <time.h>
+
+#import "Logger.h"
+#import "Utils.h"
+#import "CollationKeyCache.h"
+#import "ExportConfiguration.h"
+#import "ExportManager.h"
+#import "LibrarySnapshot.h"
+#import "MediaEntityRepository.h"
+#import "MediaItemFilterGroup.h"
+#import "MediaItemSerializer.h"
+#import "MediaItemSorter.h"
+#import "PathMapper.h"
+#import "PlaylistFilterGroup.h"
+#import "PlaylistSerializer.h"
+#import "PlaylistTreeGenerator.h"
+#import "PlistWriter.h"
+
+typedef struct {
+  NSTimeInterval duration;
+  unsigned long long heapGrowthBytes;
+  unsigned long long heapGrowthBlocks;
+} ExportBenchmarkSample;
+
+// Returns NO (and sets error) to abort the benchmark
+typedef BOOL (^ExportBenchmarkStageBlock)(NSError** error);
+
+
+@implementation ExportBenchmarkStageResult
+
+- (double)itemsPerSecond {
+
+  return (_medianDuration > 0) ? (_itemCount / _medianDuration) : 0;
+}
+
+- (NSString*)describe {
+
+  return [NSString stringWithFormat:@"%-10s %8lu items  median %9.2f ms  best %9.2f ms  %12.0f items/s  heap growth %9.1f KB (%llu blocks)  peak rss %7.1f MB",
+          _name.UTF8String, _itemCount, (_medianDuration * 1000), (_bestDuration * 1000), [self itemsPerSecond],
+          (_heapGrowthBytes / 1024.0), _heapGrowthBlocks, (_peakResidentBytes / (1024.0 * 1024.0))];
+}
+
+@end
+
+
+@implementation ExportBenchmark
+
+NSErrorDomain const __MLE_ErrorDomain_ExportBenchmark = @"com.kylekingcdn.MusicLibraryExporter.ExportBenchmarkErrorDomain";
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithLibraryURL:(NSURL*)libraryURL {
+
+  if (self = [super init]) {
+
+    _libraryURL = libraryURL;
+    _iterations = 5;
+
+    _customSortProperties = [NSDictionary dictionary];
+    _customSortOrders = [NSDictionary dictionary];
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (nullable ExportBenchmarkStageResult*)measureStage:(NSString*)name withItemCount:(NSUInteger)itemCount block:(ExportBenchmarkStageBlock)block error:(NSError**)error {
+
+  NSUInteger iterations = MAX(_iterations, 1);
+  NSMutableData* sampleData = [NSMutableData dataWithLength:(iterations * sizeof(ExportBenchmarkSample))];
+  ExportBenchmarkSample* samples = sampleData.mutableBytes;
+
+  for (NSUInteger iteration = 0; iteration < iterations; iteration++) {
+
+    @autoreleasepool {
+
+      malloc_statistics_t statsBefore;
+      malloc_zone_statistics(NULL, &statsBefore);
+
+      uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+      BOOL success = block(error);
+      uint64_t endTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+
+      // sampled before the pool drains so autoreleased objects are still counted
+      malloc_statistics_t statsAfter;
+      malloc_zone_statistics(NULL, &statsAfter);
+
+      if (!success) {
+        return nil;
+      }
+
+      samples[iteration].duration = (endTime - startTime) / (double)NSEC_PER_SEC;
+      samples[iteration].heapGrowthBytes = (statsAfter.size_in_use > statsBefore.size_in_use) ? (statsAfter.size_in_use - statsBefore.size_in_use) : 0;
+      samples[iteration].heapGrowthBlocks = (statsAfter.blocks_in_use > statsBefore.blocks_in_use) ? (statsAfter.blocks_in_use - statsBefore.blocks_in_use) : 0;
+    }
+  }
+
+  qsort_b(samples, iterations, sizeof(ExportBenchmarkSample), ^int(const void* sample1, const void* sample2) {
+    NSTimeInterval duration1 = ((const ExportBenchmarkSample*)sample1)->duration;
+    NSTimeInterval duration2 = ((const ExportBenchmarkSample*)sample2)->duration;
+    return (duration1 > duration2) - (duration1 < duration2);
+  });
+
+  const ExportBenchmarkSample* medianSample = &samples[iterations / 2];
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  ExportBenchmarkStageResult* result = [[ExportBenchmarkStageResult alloc] init];
+  [result setName:name];
+  [result setItemCount:itemCount];
+  [result setIterations:iterations];
+  [result setMedianDuration:medianSample->duration];
+  [result setBestDuration:samples[0].duration];
+  [result setHeapGrowthBytes:medianSample->heapGrowthBytes];
+  [result setHeapGrowthBlocks:medianSample->heapGrowthBlocks];
+  [result setPeakResidentBytes:(unsigned long long)usage.ru_maxrss]; // bytes on macOS
+
+  MLE_Log_Info(@"ExportBenchmark [measureStage] %@", [result describe]);
+
+  return result;
+}
+
+- (NSError*)generateErrorForCode:(ExportBenchmarkErrorCode)code underlyingError:(nullable NSError*)underlyingError {
+
+  NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+  [userInfo setValue:underlyingError forKey:NSUnderlyingErrorKey];
+
+  switch (code) {
+    case ExportBenchmarkErrorLoadFailed: {
+      [userInfo setValue:[NSString stringWithFormat:@"Failed to load benchmark library: %@", (underlyingError ? underlyingError.localizedDescription : _libraryURL.path)] forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+    case ExportBenchmarkErrorExportFailed: {
+      [userInfo setValue:[NSString stringWithFormat:@"Benchmark export failed: %@", (underlyingError ? underlyingError.localizedDescription : @"unknown error")] forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+  }
+
+  return [NSError errorWithDomain:__MLE_ErrorDomain_ExportBenchmark code:code userInfo:userInfo];
+}
+
+
+#pragma mark - Mutators
+
+- (nullable NSArray<ExportBenchmarkStageResult*>*)runAndReturnError:(NSError**)error {
+
+  MLE_Log_Info(@"ExportBenchmark [runAndReturnError] library: %@, iterations: %lu", _libraryURL.path, _iterations);
+
+  NSMutableArray<ExportBenchmarkStageResult*>* results = [NSMutableArray array];
+
+  NSError* loadError;
+  LibrarySnapshot* snapshot = [LibrarySnapshot snapshotWithContentsOfURL:_libraryURL error:&loadError];
+  if (snapshot == nil) {
+    if (error) {
+      *error = [self generateErrorForCode:ExportBenchmarkErrorLoadFailed underlyingError:loadError];
+    }
+    return nil;
+  }
+
+  NSURL* libraryURL = _libraryURL;
+  NSDictionary* customSortProperties = _customSortProperties;
+  NSDictionary* customSortOrders = _customSortOrders;
+
+  // - load - //
+
+  ExportBenchmarkStageResult* loadResult = [self measureStage:@"load" withItemCount:snapshot.trackCount block:^BOOL(NSError** stageError) {
+    return [LibrarySnapshot snapshotWithContentsOfURL:libraryURL error:stageError] != nil;
+  } error:error];
+  if (loadResult == nil) {
+    return nil;
+  }
+  [results addObject:loadResult];
+
+  // - tracks - //
+
+  MediaItemFilterGroup* itemFilterGroup = [[MediaItemFilterGroup alloc] initWithBaseFilters];
+  PathMapper* pathMapper = [[PathMapper alloc] init];
+
+  ExportBenchmarkStageResult* tracksResult = [self measureStage:@"tracks" withItemCount:snapshot.trackCount block:^BOOL(NSError** stageError) {
+
+    [itemFilterGroup compileForSnapshot:snapshot];
+
+    MediaItemSerializer* itemSerializer = [[MediaItemSerializer alloc] initWithEntityRepository:[[MediaEntityRepository alloc] init]];
+    [itemSerializer setItemFilters:itemFilterGroup];
+    [itemSerializer setPathMapper:pathMapper];
+    [itemSerializer setConcurrent:(NSProcessInfo.processInfo.activeProcessorCount > 1)];
+
+    // root dict + tracks dict
+    PlistWriter* writer = [[PlistWriter alloc] initFragmentWithDepth:2];
+    [itemSerializer serializeTracksOfSnapshot:snapshot toWriter:writer];
+
+    return YES;
+  } error:error];
+  if (tracksResult == nil) {
+    return nil;
+  }
+  [results addObject:tracksResult];
+
+  // - playlists - //
+
+  PlaylistFilterGroup* playlistFilterGroup = [[PlaylistFilterGroup alloc] initWithBaseFiltersAndIncludeInternal:YES andFlattenPlaylists:NO];
+
+  ExportBenchmarkStageResult* playlistsResult = [self measureStage:@"playlists" withItemCount:snapshot.playlistCount block:^BOOL(NSError** stageError) {
+
+    [playlistFilterGroup compileForSnapshot:snapshot];
+
+    PlaylistSerializer* playlistSerializer = [[PlaylistSerializer alloc] initWithEntityRepository:[[MediaEntityRepository alloc] init]];
+    [playlistSerializer setPlaylistFilters:playlistFilterGroup];
+    [playlistSerializer setItemFilters:itemFilterGroup];
+    [playlistSerializer setPlaylistCustomSortProperties:customSortProperties];
+    [playlistSerializer setPlaylistCustomSortOrders:customSortOrders];
+
+    // root dict + playlists array
+    PlistWriter* writer = [[PlistWriter alloc] initFragmentWithDepth:2];
+    [playlistSerializer serializePlaylistsOfSnapshot:snapshot toWriter:writer];
+
+    return YES;
+  } error:error];
+  if (playlistsResult == nil) {
+    return nil;
+  }
+  [results addObject:playlistsResult];
+
+  // - sorting - //
+
+  NSMutableArray<NSNumber*>* sortedPlaylists = [NSMutableArray array];
+  NSMutableArray<MediaItemSorter*>* sorters = [NSMutableArray array];
+  NSUInteger sortedItemCount = 0;
+
+  for (NSUInteger playlist = 0; playlist < snapshot.playlistCount; playlist++) {
+
+    NSString* playlistHexID = [Utils hexStringForPersistentId:@([snapshot persistentIDOfPlaylist:playlist])];
+    NSString* sortProperty = customSortProperties[playlistHexID];
+
+    if (sortProperty != nil) {
+      PlaylistSortOrderType sortOrder = [Utils playlistSortOrderForTitle:customSortOrders[playlistHexID]];
+      [sortedPlaylists addObject:@(playlist)];
+      [sorters addObject:[[MediaItemSorter alloc] initWithSortProperty:sortProperty andSortOrder:sortOrder]];
+      sortedItemCount += [snapshot itemCountOfPlaylist:playlist];
+    }
+  }
+
+  ExportBenchmarkStageResult* sortResult = [self measureStage:@"sort" withItemCount:sortedItemCount block:^BOOL(NSError** stageError) {
+
+    CollationKeyCache* collationKeyCache = [[CollationKeyCache alloc] init];
+    NSMutableData* scratchData = [NSMutableData data];
+
+    for (NSUInteger index = 0; index < sortedPlaylists.count; index++) {
+
+      NSUInteger playlist = sortedPlaylists[index].unsignedIntegerValue;
+      NSUInteger itemCount = [snapshot itemCountOfPlaylist:playlist];
+
+      // sort a copy so each iteration starts from the original order
+      [scratchData setLength:(itemCount * sizeof(uint32_t))];
+      memcpy(scratchData.mutableBytes, [snapshot itemsOfPlaylist:playlist], scratchData.length);
+
+      MediaItemSorter* sorter = sorters[index];
+      [sorter setCollationKeyCache:collationKeyCache];
+      [sorter sortTracks:scratchData.mutableBytes count:itemCount inSnapshot:snapshot];
+    }
+
+    return YES;
+  } error:error];
+  if (sortResult == nil) {
+    return nil;
+  }
+  [results addObject:sortResult];
+
+  // - playlist tree - //
+
+  ExportBenchmarkStageResult* treeResult = [self measureStage:@"tree" withItemCount:snapshot.playlistCount block:^BOOL(NSError** stageError) {
+
+    PlaylistTreeGenerator* generator = [[PlaylistTreeGenerator alloc] initWithFilters:playlistFilterGroup];
+    [generator setCustomSortProperties:customSortProperties];
+    [generator setCustomSortOrders:customSortOrders];
+
+    return [generator generateTreeForSnapshot:snapshot] != nil;
+  } error:error];
+  if (treeResult == nil) {
+    return nil;
+  }
+  [results addObject:treeResult];
+
+  // - full export - //
+
+  NSURL* outputDirectoryURL = [NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES];
+  NSString* outputFileName = [NSString stringWithFormat:@"mle-benchmark-%@.xml", NSUUID.UUID.UUIDString];
+
+  ExportConfiguration* configuration = [[ExportConfiguration alloc] init];
+  [configuration setGeneratedPersistentLibraryId:[ExportConfiguration generatePersistentLibraryId]];
+  [configuration setMusicLibraryPath:@"/Users/Shared/Music/Media/"];
+  [configuration setOutputDirectoryUrl:outputDirectoryURL];
+  [configuration setOutputFileName:outputFileName];
+  [configuration setCustomSortPropertyDict:customSortProperties];
+  [configuration setCustomSortOrderDict:customSortOrders];
+
+  ExportBenchmarkStageResult* exportResult = [self measureStage:@"export" withItemCount:snapshot.trackCount block:^BOOL(NSError** stageError) {
+
+    ExportManager* exportManager = [[ExportManager alloc] initWithConfiguration:configuration];
+    [exportManager setOutputFileURL:configuration.outputFileUrl];
+    // every iteration rewrites the output, otherwise iterations after the first only hash and compare it
+    [exportManager setSkipIfUnchanged:NO];
+
+    NSError* exportError;
+    if (![exportManager exportSnapshot:snapshot withError:&exportError]) {
+      if (stageError) {
+        *stageError = [self generateErrorForCode:ExportBenchmarkErrorExportFailed underlyingError:exportError];
+      }
+      return NO;
+    }
+
+    return YES;
+  } error:error];
+
+  [[NSFileManager defaultManager] removeItemAtURL:configuration.outputFileUrl error:nil];
+
+  if (exportResult == nil) {
+    return nil;
+  }
+  [results addObject:exportResult];
+
+  return results;
+}
+
+@end
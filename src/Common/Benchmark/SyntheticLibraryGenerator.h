@@ -0,0 +1,71 @@
+//
+//  SyntheticLibraryGenerator.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Generates reproducible, randomized libraries in the exported library XML format.
+//
+// The output can be loaded with `LibrarySnapshot snapshotWithContentsOfURL:error:` and used in place of the user's
+// library for benchmarking. The same seed and parameters always produce the same library.
+@interface SyntheticLibraryGenerator : NSObject
+
+extern NSErrorDomain const __MLE_ErrorDomain_SyntheticLibraryGenerator;
+
+typedef NS_ENUM(NSUInteger, SyntheticLibraryGeneratorErrorCode) {
+  SyntheticLibraryGeneratorErrorInvalidSpecifier = 0,
+  SyntheticLibraryGeneratorErrorWriteFailed,
+};
+
+
+#pragma mark - Properties
+
+@property NSUInteger trackCount;
+@property NSUInteger playlistCount;
+
+// Maximum number of nested folder levels, 0 disables folders
+@property NSUInteger folderDepth;
+
+// Average number of tracks in each regular playlist
+@property NSUInteger tracksPerPlaylist;
+
+// Number of playlists that are assigned a random custom sort property + order
+@property NSUInteger sortedPlaylistCount;
+
+// Draw names from accented, CJK and emoji syllables instead of plain ASCII
+@property BOOL unicodeMetadata;
+
+@property uint64_t seed;
+
+// Custom sorting of the last generated library, in the format of `ExportConfiguration playlistCustomSortPropertyDict`
+@property (readonly, copy) NSDictionary<NSString*, NSString*>* sortProperties;
+@property (readonly, copy) NSDictionary<NSString*, NSString*>* sortOrders;
+
+
+#pragma mark - Initializers
+
+- (instancetype)init;
+
+
+#pragma mark - Accessors
+
+- (NSDictionary*)generateLibrary;
+
+- (NSString*)describeParameters;
+
+
+#pragma mark - Mutators
+
+// Applies a comma separated list of key=value pairs, e.g. "tracks=50000,playlists=500,depth=4,sorted=50,unicode=1"
+- (BOOL)applySpecifier:(NSString*)specifier error:(NSError**)error;
+
+- (BOOL)writeLibraryToURL:(NSURL*)url error:(NSError**)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,406 @@
+//
+//  SyntheticLibraryGenerator.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "SyntheticLibraryGenerator.h"
+
+#import "Logger.h"
+#import "SorterDefines.h"
+
+static NSString* const SyntheticLibraryASCIISyllables[] = {
+  @"ka", @"lo", @"mi", @"ra", @"ten", @"vel", @"sor", @"an", @"ber", @"cu", @"dri", @"fen", @"gal", @"hum", @"ist", @"jor",
+};
+
+static NSString* const SyntheticLibraryUnicodeSyllables[] = {
+  @"zé", @"Ørn", @"ßa", @"çi", @"ñu", @"東京", @"音楽", @"사랑", @"Дом", @"λύ", @"ﾊﾙ", @"🎵", @"ê̄", @"å", @"ğü", @"نور",
+};
+
+static const NSUInteger SyntheticLibrarySyllableCount = 16;
+
+@implementation SyntheticLibraryGenerator {
+
+  uint64_t _state;
+}
+
+NSErrorDomain const __MLE_ErrorDomain_SyntheticLibraryGenerator = @"com.kylekingcdn.MusicLibraryExporter.SyntheticLibraryGeneratorErrorDomain";
+
+
+#pragma mark - Initializers
+
+- (instancetype)init {
+
+  if (self = [super init]) {
+
+    _trackCount = 10000;
+    _playlistCount = 200;
+    _folderDepth = 3;
+    _tracksPerPlaylist = 100;
+    _sortedPlaylistCount = 20;
+    _unicodeMetadata = NO;
+    _seed = 1;
+
+    _sortProperties = [NSDictionary dictionary];
+    _sortOrders = [NSDictionary dictionary];
+
+    _state = 0;
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (NSDictionary*)generateLibrary {
+
+  _state = _seed;
+
+  NSMutableDictionary* libraryDict = [NSMutableDictionary dictionary];
+
+  [libraryDict setValue:@(1) forKey:@"Major Version"];
+  [libraryDict setValue:@(1) forKey:@"Minor Version"];
+  [libraryDict setValue:[NSDate dateWithTimeIntervalSinceReferenceDate:800000000] forKey:@"Date"];
+  [libraryDict setValue:@"12.0" forKey:@"Application Version"];
+  [libraryDict setValue:@(5) forKey:@"Features"];
+  [libraryDict setValue:@(NO) forKey:@"Show Content Ratings"];
+  [libraryDict setValue:[SyntheticLibraryGenerator hexStringForID:[self persistentIDWithIndex:0 inRange:0]] forKey:@"Library Persistent ID"];
+  [libraryDict setValue:@"file:///Users/Shared/Music/Media/" forKey:@"Music Folder"];
+
+  [libraryDict setValue:[self generateTracks] forKey:@"Tracks"];
+  [libraryDict setValue:[self generatePlaylists] forKey:@"Playlists"];
+
+  return libraryDict;
+}
+
+- (NSString*)describeParameters {
+
+  return [NSString stringWithFormat:@"tracks=%lu,playlists=%lu,depth=%lu,items=%lu,sorted=%lu,unicode=%d,seed=%llu",
+          _trackCount, _playlistCount, _folderDepth, _tracksPerPlaylist, _sortedPlaylistCount, _unicodeMetadata, _seed];
+}
+
+- (uint64_t)nextRandom {
+
+  // splitmix64
+  uint64_t value = (_state += 0x9E3779B97F4A7C15ULL);
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+  return value ^ (value >> 31);
+}
+
+- (NSUInteger)randomBelow:(NSUInteger)bound {
+
+  return (bound == 0) ? 0 : (NSUInteger)([self nextRandom] % bound);
+}
+
+- (uint64_t)persistentIDWithIndex:(NSUInteger)index inRange:(uint64_t)range {
+
+  // the mix function is a bijection, so distinct inputs always produce distinct IDs
+  uint64_t value = _seed + (range << 40) + index + 1;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+  return value ^ (value >> 31);
+}
+
++ (NSString*)hexStringForID:(uint64_t)persistentID {
+
+  return [NSString stringWithFormat:@"%016llX", persistentID];
+}
+
+- (NSString*)randomWords:(NSUInteger)wordCount {
+
+  NSString* const* syllables = _unicodeMetadata ? SyntheticLibraryUnicodeSyllables : SyntheticLibraryASCIISyllables;
+
+  NSMutableArray<NSString*>* words = [NSMutableArray arrayWithCapacity:wordCount];
+
+  for (NSUInteger wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+
+    NSMutableString* word = [NSMutableString string];
+    NSUInteger syllableCount = 1 + [self randomBelow:3];
+
+    for (NSUInteger syllableIndex = 0; syllableIndex < syllableCount; syllableIndex++) {
+      [word appendString:syllables[[self randomBelow:SyntheticLibrarySyllableCount]]];
+    }
+
+    [words addObject:word.capitalizedString];
+  }
+
+  return [words componentsJoinedByString:@" "];
+}
+
+- (NSDictionary<NSString*, NSDictionary*>*)generateTracks {
+
+  NSUInteger artistCount = MAX(_trackCount / 12, 1);
+  NSUInteger albumCount = MAX(_trackCount / 10, 1);
+
+  NSMutableArray<NSString*>* artists = [NSMutableArray arrayWithCapacity:artistCount];
+  for (NSUInteger artistIndex = 0; artistIndex < artistCount; artistIndex++) {
+    [artists addObject:[self randomWords:(1 + [self randomBelow:3])]];
+  }
+
+  NSMutableArray<NSString*>* albums = [NSMutableArray arrayWithCapacity:albumCount];
+  NSMutableArray<NSNumber*>* albumArtists = [NSMutableArray arrayWithCapacity:albumCount];
+  for (NSUInteger albumIndex = 0; albumIndex < albumCount; albumIndex++) {
+    [albums addObject:[self randomWords:(1 + [self randomBelow:4])]];
+    [albumArtists addObject:@([self randomBelow:artistCount])];
+  }
+
+  NSMutableArray<NSString*>* genres = [NSMutableArray arrayWithCapacity:24];
+  for (NSUInteger genreIndex = 0; genreIndex < 24; genreIndex++) {
+    [genres addObject:[self randomWords:1]];
+  }
+
+  NSMutableDictionary<NSString*, NSDictionary*>* tracksDict = [NSMutableDictionary dictionaryWithCapacity:_trackCount];
+
+  for (NSUInteger track = 0; track < _trackCount; track++) {
+    @autoreleasepool {
+
+      NSUInteger album = [self randomBelow:albumCount];
+      NSUInteger albumArtist = albumArtists[album].unsignedIntegerValue;
+      BOOL compilation = ([self randomBelow:10] == 0);
+      NSString* artist = compilation ? artists[[self randomBelow:artistCount]] : artists[albumArtist];
+      NSString* title = [self randomWords:(1 + [self randomBelow:5])];
+
+      NSUInteger trackNumber = 1 + [self randomBelow:14];
+      NSUInteger playCount = ([self randomBelow:3] == 0) ? 0 : [self randomBelow:250];
+      NSTimeInterval addedInterval = 300000000 + [self randomBelow:400000000];
+
+      NSMutableDictionary* trackDict = [NSMutableDictionary dictionary];
+
+      [trackDict setValue:@(track + 1) forKey:@"Track ID"];
+      [trackDict setValue:title forKey:@"Name"];
+      [trackDict setValue:artist forKey:@"Artist"];
+      if (compilation) {
+        [trackDict setValue:artists[albumArtist] forKey:@"Album Artist"];
+        [trackDict setValue:@(YES) forKey:@"Compilation"];
+      }
+      [trackDict setValue:albums[album] forKey:@"Album"];
+      [trackDict setValue:genres[[self randomBelow:genres.count]] forKey:@"Genre"];
+      [trackDict setValue:([self randomBelow:2] == 0 ? @"MPEG audio file" : @"AAC audio file") forKey:@"Kind"];
+      [trackDict setValue:@(1000000 + [self randomBelow:20000000]) forKey:@"Size"];
+      [trackDict setValue:@(60000 + [self randomBelow:480000]) forKey:@"Total Time"];
+      [trackDict setValue:@(1) forKey:@"Disc Number"];
+      [trackDict setValue:@(trackNumber) forKey:@"Track Number"];
+      [trackDict setValue:@(trackNumber + [self randomBelow:6]) forKey:@"Track Count"];
+      [trackDict setValue:@(1960 + [self randomBelow:66]) forKey:@"Year"];
+      [trackDict setValue:[NSDate dateWithTimeIntervalSinceReferenceDate:(addedInterval + [self randomBelow:1000000])] forKey:@"Date Modified"];
+      [trackDict setValue:[NSDate dateWithTimeIntervalSinceReferenceDate:addedInterval] forKey:@"Date Added"];
+      [trackDict setValue:@(128 + (32 * [self randomBelow:6])) forKey:@"Bit Rate"];
+      [trackDict setValue:@(44100) forKey:@"Sample Rate"];
+      if (playCount > 0) {
+        [trackDict setValue:@(playCount) forKey:@"Play Count"];
+        [trackDict setValue:[NSDate dateWithTimeIntervalSinceReferenceDate:(addedInterval + 2000000)] forKey:@"Play Date UTC"];
+      }
+      if ([self randomBelow:4] == 0) {
+        [trackDict setValue:@(20 * (1 + [self randomBelow:5])) forKey:@"Rating"];
+      }
+      if ([self randomBelow:10] == 0) {
+        [trackDict setValue:[self randomWords:1] forKey:@"Sort Name"];
+      }
+      [trackDict setValue:[SyntheticLibraryGenerator hexStringForID:[self persistentIDWithIndex:track inRange:1]] forKey:@"Persistent ID"];
+
+      NSUInteger mediaKindRoll = [self randomBelow:100];
+      if (mediaKindRoll < 3) {
+        [trackDict setValue:@(YES) forKey:@"Podcast"];
+      }
+      else if (mediaKindRoll < 5) {
+        [trackDict setValue:@(YES) forKey:@"Music Video"];
+      }
+
+      NSString* fileName = [NSString stringWithFormat:@"%02lu %@.m4a", trackNumber, title];
+      NSString* path = [NSString pathWithComponents:@[ @"/Users/Shared/Music/Media/Music", artists[albumArtist], albums[album], fileName ]];
+      [trackDict setValue:[NSURL fileURLWithPath:path].absoluteString forKey:@"Location"];
+
+      [tracksDict setObject:trackDict forKey:[NSString stringWithFormat:@"%lu", track + 1]];
+    }
+  }
+
+  return tracksDict;
+}
+
+- (NSArray<NSDictionary*>*)generatePlaylists {
+
+  NSMutableArray<NSDictionary*>* playlistDicts = [NSMutableArray arrayWithCapacity:_playlistCount];
+
+  NSMutableDictionary<NSString*, NSString*>* sortProperties = [NSMutableDictionary dictionary];
+  NSMutableDictionary<NSString*, NSString*>* sortOrders = [NSMutableDictionary dictionary];
+
+  NSArray<NSString*>* allSortProperties = [SorterDefines allProperties];
+
+  // (hex ID, nesting level) of each folder generated so far
+  NSMutableArray<NSString*>* folderIDs = [NSMutableArray array];
+  NSMutableArray<NSNumber*>* folderLevels = [NSMutableArray array];
+
+  NSUInteger sortedPlaylists = 0;
+
+  for (NSUInteger playlist = 0; playlist < _playlistCount; playlist++) {
+    @autoreleasepool {
+
+      NSString* persistentHexID = [SyntheticLibraryGenerator hexStringForID:[self persistentIDWithIndex:playlist inRange:2]];
+
+      NSMutableDictionary* playlistDict = [NSMutableDictionary dictionary];
+      NSMutableArray<NSDictionary*>* itemDicts = [NSMutableArray array];
+
+      [playlistDict setValue:@(_trackCount + playlist + 1) forKey:@"Playlist ID"];
+      [playlistDict setValue:persistentHexID forKey:@"Playlist Persistent ID"];
+      [playlistDict setValue:@(YES) forKey:@"All Items"];
+
+      // the first playlist is always the master library playlist
+      if (playlist == 0) {
+
+        [playlistDict setValue:@"Library" forKey:@"Name"];
+        [playlistDict setValue:@(YES) forKey:@"Master"];
+        [playlistDict setValue:@(NO) forKey:@"Visible"];
+
+        for (NSUInteger track = 0; track < _trackCount; track++) {
+          [itemDicts addObject:@{ @"Track ID": @(track + 1) }];
+        }
+      }
+      else {
+
+        [playlistDict setValue:[self randomWords:(1 + [self randomBelow:3])] forKey:@"Name"];
+
+        NSUInteger level = 0;
+
+        // nest inside a random folder that still has room below it
+        if (folderIDs.count > 0 && [self randomBelow:3] != 0) {
+          NSUInteger folder = [self randomBelow:folderIDs.count];
+          if (folderLevels[folder].unsignedIntegerValue < _folderDepth) {
+            [playlistDict setValue:folderIDs[folder] forKey:@"Parent Persistent ID"];
+            level = folderLevels[folder].unsignedIntegerValue;
+          }
+        }
+
+        if (_folderDepth > 0 && level < _folderDepth && [self randomBelow:6] == 0) {
+
+          [playlistDict setValue:@(YES) forKey:@"Folder"];
+
+          [folderIDs addObject:persistentHexID];
+          [folderLevels addObject:@(level + 1)];
+        }
+        else if (_trackCount > 0) {
+
+          NSUInteger itemCount = (_tracksPerPlaylist / 2) + [self randomBelow:(_tracksPerPlaylist + 1)];
+          for (NSUInteger item = 0; item < itemCount; item++) {
+            [itemDicts addObject:@{ @"Track ID": @(1 + [self randomBelow:_trackCount]) }];
+          }
+
+          if (sortedPlaylists < _sortedPlaylistCount) {
+            [sortProperties setObject:allSortProperties[[self randomBelow:allSortProperties.count]] forKey:persistentHexID];
+            [sortOrders setObject:([self randomBelow:2] == 0 ? @"Ascending" : @"Descending") forKey:persistentHexID];
+            sortedPlaylists++;
+          }
+        }
+      }
+
+      [playlistDict setValue:itemDicts forKey:@"Playlist Items"];
+      [playlistDicts addObject:playlistDict];
+    }
+  }
+
+  _sortProperties = sortProperties;
+  _sortOrders = sortOrders;
+
+  return playlistDicts;
+}
+
+
+#pragma mark - Mutators
+
+- (BOOL)applySpecifier:(NSString*)specifier error:(NSError**)error {
+
+  for (NSString* segment in [specifier componentsSeparatedByString:@","]) {
+
+    NSString* trimmedSegment = [segment stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    if (trimmedSegment.length == 0) {
+      continue;
+    }
+
+    NSArray<NSString*>* parts = [trimmedSegment componentsSeparatedByString:@"="];
+    if (parts.count != 2) {
+      if (error) {
+        *error = [self generateErrorForCode:SyntheticLibraryGeneratorErrorInvalidSpecifier withDetail:trimmedSegment underlyingError:nil];
+      }
+      return NO;
+    }
+
+    NSString* key = parts[0];
+    unsigned long long value = strtoull(parts[1].UTF8String, NULL, 10);
+
+    if ([key isEqualToString:@"tracks"]) {
+      _trackCount = (NSUInteger)value;
+    }
+    else if ([key isEqualToString:@"playlists"]) {
+      _playlistCount = (NSUInteger)value;
+    }
+    else if ([key isEqualToString:@"depth"]) {
+      _folderDepth = (NSUInteger)value;
+    }
+    else if ([key isEqualToString:@"items"]) {
+      _tracksPerPlaylist = (NSUInteger)value;
+    }
+    else if ([key isEqualToString:@"sorted"]) {
+      _sortedPlaylistCount = (NSUInteger)value;
+    }
+    else if ([key isEqualToString:@"unicode"]) {
+      _unicodeMetadata = (value != 0);
+    }
+    else if ([key isEqualToString:@"seed"]) {
+      _seed = value;
+    }
+    else {
+      if (error) {
+        *error = [self generateErrorForCode:SyntheticLibraryGeneratorErrorInvalidSpecifier withDetail:trimmedSegment underlyingError:nil];
+      }
+      return NO;
+    }
+  }
+
+  return YES;
+}
+
+- (BOOL)writeLibraryToURL:(NSURL*)url error:(NSError**)error {
+
+  NSDictionary* libraryDict = [self generateLibrary];
+
+  NSError* writeError;
+  NSData* libraryData = [NSPropertyListSerialization dataWithPropertyList:libraryDict format:NSPropertyListXMLFormat_v1_0 options:0 error:&writeError];
+
+  if (libraryData == nil || ![libraryData writeToURL:url options:NSDataWritingAtomic error:&writeError]) {
+    if (error) {
+      *error = [self generateErrorForCode:SyntheticLibraryGeneratorErrorWriteFailed withDetail:url.path underlyingError:writeError];
+    }
+    return NO;
+  }
+
+  MLE_Log_Info(@"SyntheticLibraryGenerator [writeLibraryToURL] wrote library (%@) to %@", [self describeParameters], url.path);
+
+  return YES;
+}
+
+- (NSError*)generateErrorForCode:(SyntheticLibraryGeneratorErrorCode)code withDetail:(NSString*)detail underlyingError:(nullable NSError*)underlyingError {
+
+  switch (code) {
+    case SyntheticLibraryGeneratorErrorInvalidSpecifier: {
+      return [NSError errorWithDomain:__MLE_ErrorDomain_SyntheticLibraryGenerator code:code userInfo:@{
+        NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Invalid synthetic library parameter: %@", detail],
+        NSLocalizedRecoverySuggestionErrorKey:@"Supported parameters are tracks, playlists, depth, items, sorted, unicode and seed (e.g. tracks=50000,playlists=500).",
+      }];
+    }
+    case SyntheticLibraryGeneratorErrorWriteFailed: {
+      NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+      [userInfo setValue:[NSString stringWithFormat:@"Failed to write synthetic library to %@", detail] forKey:NSLocalizedDescriptionKey];
+      [userInfo setValue:underlyingError forKey:NSUnderlyingErrorKey];
+      return [NSError errorWithDomain:__MLE_ErrorDomain_SyntheticLibraryGenerator code:code userInfo:userInfo];
+    }
+  }
+}
+
+@end
@@ -48,6 +48,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (NSDictionary*)playlistCustomSortPropertyDict;
 - (NSDictionary*)playlistCustomSortOrderDict;
 
+// The inverse of `loadValuesFromDictionary:`, unset values are omitted. The output directory URL is not included.
+- (NSDictionary*)dictionaryRepresentation;
+
 + (NSString*)generatePersistentLibraryId;
 
 - (void)dumpProperties;
@@ -164,6 +164,32 @@
   return _playlistCustomSortOrderDict;
 }
 
+- (NSDictionary*)dictionaryRepresentation {
+
+  NSMutableDictionary* dict = [NSMutableDictionary dictionary];
+
+  [dict setValue:_musicLibraryPath forKey:ExportConfigurationKeyMusicLibraryPath];
+
+  [dict setValue:_generatedPersistentLibraryId forKey:ExportConfigurationKeyGeneratedPersistentLibraryId];
+
+  [dict setValue:_outputDirectoryPath forKey:ExportConfigurationKeyOutputDirectoryPath];
+  [dict setValue:_outputFileName forKey:ExportConfigurationKeyOutputFileName];
+
+  [dict setValue:[NSNumber numberWithBool:_remapRootDirectory] forKey:ExportConfigurationKeyRemapRootDirectory];
+  [dict setValue:_remapRootDirectoryOriginalPath forKey:ExportConfigurationKeyRemapRootDirectoryOriginalPath];
+  [dict setValue:_remapRootDirectoryMappedPath forKey:ExportConfigurationKeyRemapRootDirectoryMappedPath];
+  [dict setValue:[NSNumber numberWithBool:_remapRootDirectoryLocalhostPrefix] forKey:ExportConfigurationKeyRemapRootDirectoryLocalhostPrefix];
+
+  [dict setValue:[NSNumber numberWithBool:_flattenPlaylistHierarchy] forKey:ExportConfigurationKeyFlattenPlaylistHierarchy];
+  [dict setValue:[NSNumber numberWithBool:_includeInternalPlaylists] forKey:ExportConfigurationKeyIncludeInternalPlaylists];
+  [dict setValue:_excludedPlaylistPersistentIds.allObjects forKey:ExportConfigurationKeyExcludedPlaylistPersistentIds];
+
+  [dict setValue:_playlistCustomSortPropertyDict forKey:ExportConfigurationKeyPlaylistCustomSortProperties];
+  [dict setValue:_playlistCustomSortOrderDict forKey:ExportConfigurationKeyPlaylistCustomSortOrders];
+
+  return dict;
+}
+
 + (NSString*)generatePersistentLibraryId {
 
   NSArray<NSString*>* uuidParts = [[NSUUID UUID].UUIDString componentsSeparatedByString:@"-"];
@@ -30,6 +30,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (BOOL)skipOnBattery;
 
+- (BOOL)exportOnLibraryChange;
+
+// Music library database watched for changes, nil to use `~/Music/Music/Music Library.musiclibrary`
+- (nullable NSString*)libraryPath;
+
 - (void)dumpProperties;
 
 
@@ -45,6 +50,10 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)setSkipOnBattery:(BOOL)flag;
 
+- (void)setExportOnLibraryChange:(BOOL)flag;
+
+- (void)setLibraryPath:(nullable NSString*)path;
+
 @end
 
 extern NSString* const ScheduleConfigurationKeyScheduleEnabled;
@@ -52,5 +61,7 @@ extern NSString* const ScheduleConfigurationKeyScheduleInterval;
 extern NSString* const ScheduleConfigurationKeyLastExportedAt;
 extern NSString* const ScheduleConfigurationKeyNextExportAt;
 extern NSString* const ScheduleConfigurationKeySkipOnBattery;
+extern NSString* const ScheduleConfigurationKeyExportOnLibraryChange;
+extern NSString* const ScheduleConfigurationKeyLibraryPath;
 
 NS_ASSUME_NONNULL_END
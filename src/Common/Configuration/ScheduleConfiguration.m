@@ -23,6 +23,9 @@
   NSDate* _nextExportAt;
 
   BOOL _skipOnBattery;
+
+  BOOL _exportOnLibraryChange;
+  NSString* _libraryPath;
 }
 
 
@@ -52,6 +55,8 @@
 //  nil,             ScheduleConfigurationKeyLastExportedAt,
 //  nil,             ScheduleConfigurationKeyNextExportAt,
     @NO,             ScheduleConfigurationKeySkipOnBattery,
+    @YES,            ScheduleConfigurationKeyExportOnLibraryChange,
+//  nil,             ScheduleConfigurationKeyLibraryPath,
     nil
   ];
 }
@@ -81,6 +86,16 @@
   return _skipOnBattery;
 }
 
+- (BOOL)exportOnLibraryChange {
+
+  return _exportOnLibraryChange;
+}
+
+- (nullable NSString*)libraryPath {
+
+  return _libraryPath;
+}
+
 - (void)dumpProperties {
 
   MLE_Log_Info(@"ScheduleConfiguration [dumpProperties]");
@@ -90,6 +105,8 @@
   MLE_Log_Info(@"  LastExportedAt:                  '%@'", _lastExportedAt.description);
   MLE_Log_Info(@"  NextExportAt:                    '%@'", _nextExportAt.description);
   MLE_Log_Info(@"  SkipOnBattery:                   '%@'", (_skipOnBattery ? @"YES" : @"NO"));
+  MLE_Log_Info(@"  ExportOnLibraryChange:           '%@'", (_exportOnLibraryChange ? @"YES" : @"NO"));
+  MLE_Log_Info(@"  LibraryPath:                     '%@'", _libraryPath);
 }
 
 
@@ -108,6 +125,9 @@
   _nextExportAt = [_userDefaults valueForKey:ScheduleConfigurationKeyNextExportAt];
 
   _skipOnBattery = [_userDefaults boolForKey:ScheduleConfigurationKeySkipOnBattery];
+
+  _exportOnLibraryChange = [_userDefaults boolForKey:ScheduleConfigurationKeyExportOnLibraryChange];
+  _libraryPath = [_userDefaults stringForKey:ScheduleConfigurationKeyLibraryPath];
 }
 
 - (void)setScheduleEnabled:(BOOL)flag {
@@ -164,6 +184,24 @@
   [_userDefaults setBool:_skipOnBattery forKey:ScheduleConfigurationKeySkipOnBattery];
 }
 
+- (void)setExportOnLibraryChange:(BOOL)flag {
+
+  MLE_Log_Info(@"ScheduleConfiguration [setExportOnLibraryChange:%@]", (flag ? @"YES" : @"NO"));
+
+  _exportOnLibraryChange = flag;
+
+  [_userDefaults setBool:_exportOnLibraryChange forKey:ScheduleConfigurationKeyExportOnLibraryChange];
+}
+
+- (void)setLibraryPath:(nullable NSString*)path {
+
+  MLE_Log_Info(@"ScheduleConfiguration [setLibraryPath:%@]", path);
+
+  _libraryPath = [path copy];
+
+  [_userDefaults setValue:_libraryPath forKey:ScheduleConfigurationKeyLibraryPath];
+}
+
 @end
 
 NSString* const ScheduleConfigurationKeyScheduleEnabled = @"ScheduleEnabled";
@@ -171,3 +209,5 @@ NSString* const ScheduleConfigurationKeyScheduleInterval = @"ScheduleInterval";
 NSString* const ScheduleConfigurationKeyLastExportedAt = @"LastExportedAt";
 NSString* const ScheduleConfigurationKeyNextExportAt = @"NextExportAt";
 NSString* const ScheduleConfigurationKeySkipOnBattery = @"SkipOnBattery";
+NSString* const ScheduleConfigurationKeyExportOnLibraryChange = @"ExportOnLibraryChange";
+NSString* const ScheduleConfigurationKeyLibraryPath = @"LibraryPath";
@@ -26,6 +26,7 @@ typedef NS_ENUM(NSUInteger, ExportState) {
   ExportGeneratingLibrary,
   ExportWritingToDisk,
   ExportFinished,
+  ExportUnchanged,
   ExportError
 };
 
@@ -37,6 +38,7 @@ static NSString *_Nonnull const ExportStateNames[] = {
   @"Generating library",
   @"Saving to disk",
   @"Finished",
+  @"Unchanged",
   @"Error",
 };
 
@@ -0,0 +1,70 @@
+//
+//  BatchExportManager.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+@class ExportManager;
+@class LibrarySnapshot;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Exports several variants of the same library, e.g. with different path mappings or excluded playlists.
+//
+// The library is read into a single snapshot that every target exports from, and collation keys used for playlist
+// sorting are shared between targets. Each target's output is written concurrently by its own ExportManager.
+@interface BatchExportManager : NSObject
+
+extern NSErrorDomain const __MLE_ErrorDomain_BatchExportManager;
+
+typedef NS_ENUM(NSUInteger, BatchExportManagerErrorCode) {
+  BatchExportManagerErrorConfigUnreadable = 0,
+  BatchExportManagerErrorConfigInvalid,
+  BatchExportManagerErrorTargetFailed,
+  BatchExportManagerErrorCancelled,
+};
+
+#pragma mark - Properties
+
+@property (readonly) NSArray<ExportManager*>* targets;
+
+// Set by `cancel`, cleared when exportLibraryWithError: starts
+@property (readonly, getter=isCancelled) BOOL cancelled;
+
+
+#pragma mark - Initializers
+
+- (instancetype)init;
+
+
+#pragma mark - Mutators
+
+- (void)addTarget:(ExportManager*)target;
+
+// Reads a property list containing a `Targets` array of dictionaries. Each target dictionary holds ExportConfiguration
+// values that are applied on top of `baseValues` and the top-level values of the file, plus:
+//   OutputPath (required)  - path of the generated library
+//   OutputFormat           - one of `PlistWriterFormatNames`, defaults to xml
+//   RemapRulesPath         - prefix rules file (see `PathMapper addRulesFromURL:`)
+// No targets are added if any of them is invalid.
+- (BOOL)addTargetsFromURL:(NSURL*)url withBaseValues:(NSDictionary*)baseValues error:(NSError**)error;
+
+- (BOOL)exportLibraryWithError:(NSError**)error;
+
+- (BOOL)exportSnapshot:(LibrarySnapshot*)snapshot withError:(NSError**)error;
+
+// Cancels the export of every target. Targets that are running stop between tracks and playlists, targets that have not
+// started are skipped. A cancelled batch fails with BatchExportManagerErrorCancelled and leaves existing output untouched.
+- (void)cancel;
+
+@end
+
+extern NSString* const BatchExportManagerKeyTargets;
+extern NSString* const BatchExportManagerKeyOutputPath;
+extern NSString* const BatchExportManagerKeyOutputFormat;
+extern NSString* const BatchExportManagerKeyRemapRulesPath;
+
+NS_ASSUME_NONNULL_END
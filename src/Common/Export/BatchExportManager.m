@@ -0,0 +1,317 @@
+//
+//  BatchExportManager.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "BatchExportManager.h"
+
+#import <iTunesLibrary/ITLibrary.h>
+#import <stdatomic.h>
+
+#import "CollationKeyCache.h"
+#import "ExportConfiguration.h"
+#import "ExportManager.h"
+#import "LibrarySnapshot.h"
+#import "Logger.h"
+#import "PlistWriter.h"
+
+@implementation BatchExportManager {
+
+  NSMutableArray<ExportManager*>* _targets;
+
+  // targets only see a cancel once their export has started, this covers the snapshot load and targets yet to start
+  atomic_bool _cancelRequested;
+}
+
+NSErrorDomain const __MLE_ErrorDomain_BatchExportManager = @"com.kylekingcdn.MusicLibraryExporter.BatchExportManagerErrorDomain";
+
+
+#pragma mark - Initializers
+
+- (instancetype)init {
+
+  if (self = [super init]) {
+
+    _targets = [NSMutableArray array];
+    atomic_init(&_cancelRequested, false);
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (NSArray<ExportManager*>*)targets {
+
+  return _targets;
+}
+
+- (BOOL)isCancelled {
+
+  return atomic_load(&_cancelRequested);
+}
+
+
+#pragma mark - Mutators
+
+- (void)addTarget:(ExportManager*)target {
+
+  [_targets addObject:target];
+}
+
+- (BOOL)addTargetsFromURL:(NSURL*)url withBaseValues:(NSDictionary*)baseValues error:(NSError**)error {
+
+  NSError* readError;
+  NSData* data = [NSData dataWithContentsOfURL:url options:0 error:&readError];
+  id plist = nil;
+  if (data != nil) {
+    plist = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:&readError];
+  }
+
+  if (![plist isKindOfClass:[NSDictionary class]]) {
+    MLE_Log_Info(@"BatchExportManager [addTargetsFromURL] unable to read batch config: %@", readError.localizedDescription);
+    if (error) {
+      NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+      [userInfo setObject:[NSString stringWithFormat:@"Unable to read batch export configuration: %@", url.path] forKey:NSLocalizedDescriptionKey];
+      if (readError != nil) {
+        [userInfo setObject:readError forKey:NSUnderlyingErrorKey];
+      }
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_BatchExportManager code:BatchExportManagerErrorConfigUnreadable userInfo:userInfo];
+    }
+    return NO;
+  }
+
+  NSArray* targetDicts = [plist objectForKey:BatchExportManagerKeyTargets];
+  if (![targetDicts isKindOfClass:[NSArray class]] || targetDicts.count == 0) {
+    if (error) {
+      *error = [BatchExportManager invalidConfigErrorWithReason:@"The batch export configuration does not contain any Targets"];
+    }
+    return NO;
+  }
+
+  // values at the top level of the file apply to every target
+  NSMutableDictionary* sharedValues = [baseValues mutableCopy];
+  [sharedValues addEntriesFromDictionary:plist];
+  [sharedValues removeObjectForKey:BatchExportManagerKeyTargets];
+
+  NSMutableArray<ExportManager*>* targets = [NSMutableArray arrayWithCapacity:targetDicts.count];
+  NSMutableSet<NSString*>* outputPaths = [NSMutableSet set];
+
+  for (NSUInteger targetIndex = 0; targetIndex < targetDicts.count; targetIndex++) {
+
+    NSDictionary* targetDict = targetDicts[targetIndex];
+    if (![targetDict isKindOfClass:[NSDictionary class]]) {
+      if (error) {
+        *error = [BatchExportManager invalidConfigErrorWithReason:[NSString stringWithFormat:@"Target %lu is not a dictionary", targetIndex + 1]];
+      }
+      return NO;
+    }
+
+    NSMutableDictionary* values = [sharedValues mutableCopy];
+    [values addEntriesFromDictionary:targetDict];
+
+    // output path
+    NSString* outputPath = [values objectForKey:BatchExportManagerKeyOutputPath];
+    if (![outputPath isKindOfClass:[NSString class]] || outputPath.length == 0) {
+      if (error) {
+        *error = [BatchExportManager invalidConfigErrorWithReason:[NSString stringWithFormat:@"Target %lu is missing an OutputPath", targetIndex + 1]];
+      }
+      return NO;
+    }
+
+    NSURL* outputFileURL = [NSURL fileURLWithPath:[outputPath stringByExpandingTildeInPath]];
+    NSString* standardizedOutputPath = outputFileURL.URLByStandardizingPath.path;
+    if ([outputPaths containsObject:standardizedOutputPath]) {
+      if (error) {
+        *error = [BatchExportManager invalidConfigErrorWithReason:[NSString stringWithFormat:@"Target %lu has the same OutputPath as another target: %@", targetIndex + 1, outputPath]];
+      }
+      return NO;
+    }
+    [outputPaths addObject:standardizedOutputPath];
+
+    // output format
+    PlistWriterFormat outputFormat = PlistWriterFormatXML;
+    NSString* outputFormatName = [values objectForKey:BatchExportManagerKeyOutputFormat];
+    if (outputFormatName != nil) {
+      outputFormat = PlistWriterFormat_MAX;
+      for (PlistWriterFormat format = PlistWriterFormatXML; format < PlistWriterFormat_MAX; format++) {
+        if ([outputFormatName isKindOfClass:[NSString class]] && [outputFormatName.lowercaseString isEqualToString:PlistWriterFormatNames[format]]) {
+          outputFormat = format;
+          break;
+        }
+      }
+      if (outputFormat == PlistWriterFormat_MAX) {
+        if (error) {
+          *error = [BatchExportManager invalidConfigErrorWithReason:[NSString stringWithFormat:@"Target %lu has an unsupported OutputFormat: %@", targetIndex + 1, outputFormatName]];
+        }
+        return NO;
+      }
+    }
+
+    // remap rules
+    NSString* remapRulesPath = [values objectForKey:BatchExportManagerKeyRemapRulesPath];
+    if (remapRulesPath != nil && ![remapRulesPath isKindOfClass:[NSString class]]) {
+      if (error) {
+        *error = [BatchExportManager invalidConfigErrorWithReason:[NSString stringWithFormat:@"Target %lu has an invalid RemapRulesPath", targetIndex + 1]];
+      }
+      return NO;
+    }
+
+    ExportConfiguration* configuration = [[ExportConfiguration alloc] init];
+    [configuration loadValuesFromDictionary:values];
+    [configuration setOutputFileName:outputFileURL.lastPathComponent];
+    [configuration setOutputDirectoryUrl:outputFileURL.URLByDeletingLastPathComponent];
+    [configuration setOutputDirectoryPath:outputFileURL.URLByDeletingLastPathComponent.path];
+
+    ExportManager* target = [[ExportManager alloc] initWithConfiguration:configuration];
+    [target setOutputFileURL:outputFileURL];
+    [target setOutputFormat:outputFormat];
+    if (remapRulesPath.length > 0) {
+      [target setRemapRulesFileURL:[NSURL fileURLWithPath:[remapRulesPath stringByExpandingTildeInPath]]];
+    }
+
+    [targets addObject:target];
+  }
+
+  [_targets addObjectsFromArray:targets];
+
+  MLE_Log_Info(@"BatchExportManager [addTargetsFromURL] loaded %lu targets from: %@", targets.count, url.path);
+
+  return YES;
+}
+
+- (BOOL)exportLibraryWithError:(NSError**)error {
+
+  atomic_store(&_cancelRequested, false);
+
+  // init ITLibrary
+  ITLibrary* library = [ITLibrary libraryWithAPIVersion:@"1.1" options:ITLibInitOptionNone error:error];
+  if (library == nil) {
+    MLE_Log_Info(@"BatchExportManager [exportLibraryWithError] error - failed to init ITLibrary");
+    return NO;
+  }
+
+  // every target exports from the same snapshot
+  LibrarySnapshot* snapshot = [[LibrarySnapshot alloc] initWithLibrary:library];
+
+  if ([self stopIfCancelledWithError:error]) {
+    return NO;
+  }
+
+  return [self exportSnapshot:snapshot withError:error];
+}
+
+- (BOOL)exportSnapshot:(LibrarySnapshot*)snapshot withError:(NSError**)error {
+
+  NSAssert(_targets.count > 0, @"BatchExportManager has no targets");
+
+  if ([self stopIfCancelledWithError:error]) {
+    return NO;
+  }
+
+  NSArray<ExportManager*>* targets = [_targets copy];
+
+  // sort keys only depend on the library, so they are generated once for all targets
+  CollationKeyCache* collationKeyCache = [[CollationKeyCache alloc] init];
+  for (ExportManager* target in targets) {
+    [target setCollationKeyCache:collationKeyCache];
+  }
+
+  NSMutableArray<NSString*>* failedPaths = [NSMutableArray array];
+  __block NSError* firstTargetError = nil;
+
+  dispatch_apply(targets.count, DISPATCH_APPLY_AUTO, ^(size_t targetIndex) {
+
+    ExportManager* target = targets[targetIndex];
+
+    if (atomic_load(&self->_cancelRequested)) {
+      return;
+    }
+
+    NSError* targetError;
+    if (![target exportSnapshot:snapshot withError:&targetError]) {
+      MLE_Log_Info(@"BatchExportManager [exportSnapshot] export failed for: %@ (%@)", target.outputFileURL.path, targetError.localizedDescription);
+      @synchronized (failedPaths) {
+        [failedPaths addObject:target.outputFileURL.path];
+        if (firstTargetError == nil) {
+          firstTargetError = targetError;
+        }
+      }
+    }
+  });
+
+  MLE_Log_Info(@"BatchExportManager [exportSnapshot] exported %lu of %lu targets", targets.count - failedPaths.count, targets.count);
+
+  // targets stopped by the cancel are reported as a cancelled batch rather than as failures
+  if ([self stopIfCancelledWithError:error]) {
+    return NO;
+  }
+
+  if (failedPaths.count > 0) {
+    if (error) {
+      NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+      [userInfo setObject:[NSString stringWithFormat:@"Failed to export %lu of %lu libraries: %@", failedPaths.count, targets.count, [failedPaths componentsJoinedByString:@", "]] forKey:NSLocalizedDescriptionKey];
+      if (firstTargetError != nil) {
+        [userInfo setObject:firstTargetError forKey:NSUnderlyingErrorKey];
+      }
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_BatchExportManager code:BatchExportManagerErrorTargetFailed userInfo:userInfo];
+    }
+    return NO;
+  }
+
+  return YES;
+}
+
+- (void)cancel {
+
+  MLE_Log_Info(@"BatchExportManager [cancel] cancellation requested");
+
+  atomic_store(&_cancelRequested, true);
+
+  for (ExportManager* target in _targets) {
+    [target cancel];
+  }
+}
+
+
+#pragma mark - Helper functions
+
+- (BOOL)stopIfCancelledWithError:(NSError**)error {
+
+  if (!atomic_load(&_cancelRequested)) {
+    return NO;
+  }
+
+  MLE_Log_Info(@"BatchExportManager [stopIfCancelled] batch export cancelled");
+
+  if (error) {
+    *error = [NSError errorWithDomain:__MLE_ErrorDomain_BatchExportManager code:BatchExportManagerErrorCancelled userInfo:@{
+      NSLocalizedDescriptionKey:@"Batch export cancelled",
+      NSLocalizedRecoverySuggestionErrorKey:@"Existing library files have not been modified.",
+    }];
+  }
+
+  return YES;
+}
+
++ (NSError*)invalidConfigErrorWithReason:(NSString*)reason {
+
+  MLE_Log_Info(@"BatchExportManager [addTargetsFromURL] invalid batch config: %@", reason);
+
+  return [NSError errorWithDomain:__MLE_ErrorDomain_BatchExportManager code:BatchExportManagerErrorConfigInvalid userInfo:@{
+    NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Invalid batch export configuration: %@", reason],
+  }];
+}
+
+@end
+
+NSString* const BatchExportManagerKeyTargets = @"Targets";
+NSString* const BatchExportManagerKeyOutputPath = @"OutputPath";
+NSString* const BatchExportManagerKeyOutputFormat = @"OutputFormat";
+NSString* const BatchExportManagerKeyRemapRulesPath = @"RemapRulesPath";
@@ -11,8 +11,12 @@
 #import "ExportManagerDelegate.h"
 #import "MediaItemSerializerDelegate.h"
 #import "PlaylistSerializerDelegate.h"
+#import "PlistWriter.h"
 
+@class CollationKeyCache;
 @class ExportConfiguration;
+@class ExportMetrics;
+@class LibrarySnapshot;
 @class OrderedDictionary;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -28,15 +32,47 @@ typedef NS_ENUM(NSUInteger, ExportManagerErrorCode) {
   ExportManagerErrorBusyState,
   ExportManagerErrorUnitialized,
   ExportManagerErrorWriteError,
+  ExportManagerErrorCancelled,
 };
 
 #pragma mark - Properties
 
 @property (nullable, weak) NSObject<ExportManagerDelegate>* delegate;
 
+// Queue that delegate callbacks are delivered on. When nil, callbacks are made on the exporting thread.
+@property (nullable, strong) dispatch_queue_t delegateQueue;
+
+// Minimum time between `exportedItems:ofTotal:` (or `exportedPlaylists:ofTotal:`) callbacks, defaults to 20 per second
+@property NSTimeInterval progressInterval;
+
 @property (readonly) ExportState state;
 @property (nullable,copy) NSURL* outputFileURL;
 
+// Encoding of the output file, defaults to PlistWriterFormatXML. The file extension of `outputFileURL` is not changed.
+@property PlistWriterFormat outputFormat;
+
+// When set, prefix rules are loaded from this file and applied to track locations (see `PathMapper addRulesFromURL:`)
+@property (nullable,copy) NSURL* remapRulesFileURL;
+
+// When enabled (the default), an existing output file is left untouched if the exported library hasn't changed, apart
+// from its export date. The export then finishes with the ExportUnchanged state instead of ExportFinished.
+@property BOOL skipIfUnchanged;
+
+// When set, serialized tracks are cached at this location and reused by later exports if unchanged
+@property (nullable,copy) NSURL* fragmentCacheURL;
+
+// When set, playlist sorting uses these collation keys, e.g. to share them between exports of the same snapshot
+@property (nullable, strong) CollationKeyCache* collationKeyCache;
+
+// Timing + memory usage of each stage of the most recent export
+@property (nullable, readonly) ExportMetrics* metrics;
+
+// When enabled, metrics are also written as JSON alongside the output file (see `metricsFileURL`)
+@property BOOL writeMetricsFile;
+
+// Set by `cancel` until the current export has stopped
+@property (readonly, getter=isCancelled) BOOL cancelled;
+
 
 #pragma mark - Initializers
 
@@ -44,10 +80,28 @@ typedef NS_ENUM(NSUInteger, ExportManagerErrorCode) {
 - (instancetype)initWithConfiguration:(ExportConfiguration*)configuration;
 
 
+#pragma mark - Accessors
+
+- (nullable NSURL*)metricsFileURL;
+
+
 #pragma mark - Mutators
 
 - (BOOL)exportLibraryWithError:(NSError**)error;
 
+// Exports a previously loaded snapshot (e.g. one read from an exported library file) instead of the current library
+// A cancel requested before the call is honoured, the export then stops before anything is written.
+- (BOOL)exportSnapshot:(LibrarySnapshot*)snapshot withError:(NSError**)error;
+
+// Runs exportLibraryWithError: on a background queue.
+// The completion handler is called on `delegateQueue`, or on the background queue when none is set. While a previous
+// background export is still running the call fails immediately with ExportManagerErrorBusyState.
+- (void)exportLibraryInBackgroundWithCompletionHandler:(nullable void (^)(BOOL success, NSError* _Nullable error))completionHandler;
+
+// Requests that the running (or pending background) export stops. Cancellation is checked between tracks and
+// playlists, a cancelled export fails with ExportManagerErrorCancelled and leaves any existing output file untouched.
+- (void)cancel;
+
 
 @end
 
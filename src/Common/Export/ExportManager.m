@@ -9,24 +9,34 @@
 
 #import <iTunesLibrary/ITLibrary.h>
 #import <iTunesLibrary/ITLibPlaylist.h>
+#import <stdatomic.h>
 
 #import "ExportConfiguration.h"
+#import "ExportMetrics.h"
 #import "LibrarySerializer.h"
+#import "LibrarySnapshot.h"
 #import "Logger.h"
 #import "MediaEntityRepository.h"
 #import "MediaItemFilterGroup.h"
 #import "MediaItemSerializer.h"
-#import "OrderedDictionary.h"
 #import "PathMapper.h"
 #import "PlaylistFilterGroup.h"
 #import "PlaylistParentIDFilter.h"
 #import "PlaylistSerializer.h"
+#import "PlistWriter.h"
+#import "ProgressReporter.h"
+#import "TrackFragmentCache.h"
 
 @implementation ExportManager {
 
   MediaEntityRepository* _entityRepository;
   ExportConfiguration* _configuration;
   PlaylistParentIDFilter* _playlistParentIDFilter;
+
+  dispatch_queue_t _exportQueue;
+  atomic_bool _cancelRequested;
+  // set from the call to exportLibraryInBackgroundWithCompletionHandler: until its export has finished
+  atomic_bool _backgroundExportActive;
 }
 
 NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLibraryExporter.ExportManagerErrorDomain";
@@ -39,14 +49,28 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
   if (self = [super init]) {
 
     _delegate = nil;
+    _delegateQueue = nil;
+    _progressInterval = 0.05;
 
     _state = ExportStopped;
      _outputFileURL = nil;
+    _outputFormat = PlistWriterFormatXML;
+    _remapRulesFileURL = nil;
+    _fragmentCacheURL = nil;
+    _skipIfUnchanged = YES;
+    _collationKeyCache = nil;
+    _metrics = nil;
+    _writeMetricsFile = NO;
     
     _entityRepository = [[MediaEntityRepository alloc] init];
     _configuration = nil;
     _playlistParentIDFilter = nil;
 
+    dispatch_queue_attr_t queueAttributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
+    _exportQueue = dispatch_queue_create("com.kylekingcdn.MusicLibraryExporter.ExportQueue", queueAttributes);
+    atomic_init(&_cancelRequested, false);
+    atomic_init(&_backgroundExportActive, false);
+
     return self;
   }
   else {
@@ -68,10 +92,66 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
 }
 
 
+#pragma mark - Accessors
+
+- (nullable NSURL*)metricsFileURL {
+
+  if (_outputFileURL == nil) {
+    return nil;
+  }
+
+  // e.g. Library.xml -> Library.metrics.json
+  return [[_outputFileURL URLByDeletingPathExtension] URLByAppendingPathExtension:@"metrics.json"];
+}
+
+- (BOOL)isCancelled {
+
+  return atomic_load(&_cancelRequested);
+}
+
+
 #pragma mark - Mutators
 
 - (BOOL)exportLibraryWithError:(NSError**)error {
 
+  atomic_store(&_cancelRequested, false);
+
+  return [self runLibraryExportWithError:error];
+}
+
+- (void)exportLibraryInBackgroundWithCompletionHandler:(nullable void (^)(BOOL success, NSError* _Nullable error))completionHandler {
+
+  // only one background export at a time, a second one would clear a cancel that is pending for the running export
+  bool active = false;
+  if (!atomic_compare_exchange_strong(&_backgroundExportActive, &active, true)) {
+    MLE_Log_Info(@"ExportManager [exportLibraryInBackgroundWithCompletionHandler] an export is already running - state: %@", ExportStateNames[_state]);
+    [self callCompletionHandler:completionHandler withSuccess:NO error:[self generateErrorForCode:ExportManagerErrorBusyState]];
+    return;
+  }
+
+  // cleared before queueing so that a cancel issued while the export is pending still applies
+  atomic_store(&_cancelRequested, false);
+
+  dispatch_async(_exportQueue, ^{
+
+    NSError* exportError;
+    BOOL exportSuccessful = [self runLibraryExportWithError:&exportError];
+
+    atomic_store(&self->_backgroundExportActive, false);
+
+    [self callCompletionHandler:completionHandler withSuccess:exportSuccessful error:exportError];
+  });
+}
+
+- (void)cancel {
+
+  MLE_Log_Info(@"ExportManager [cancel] cancellation requested - state: %@", ExportStateNames[_state]);
+
+  atomic_store(&_cancelRequested, true);
+}
+
+- (BOOL)runLibraryExportWithError:(NSError**)error {
+
   NSAssert(_outputFileURL != nil, @"_outputFileURL cannot be nil");
 
   // validate configuration
@@ -90,6 +170,43 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
     return NO;
   }
 
+  // read every track + playlist once, all export stages use the snapshot
+  LibrarySnapshot* snapshot = [[LibrarySnapshot alloc] initWithLibrary:library];
+
+  if ([self stopIfCancelledWithWriter:nil error:error]) {
+    return NO;
+  }
+
+  return [self writeSnapshot:snapshot withError:error];
+}
+
+- (BOOL)exportSnapshot:(LibrarySnapshot*)snapshot withError:(NSError**)error {
+
+  NSAssert(_outputFileURL != nil, @"_outputFileURL cannot be nil");
+
+  // validate configuration
+  if (![self validateConfigurationWithError:error]) {
+    return NO;
+  }
+
+  // set state to preparing
+  [self setState:ExportPreparing];
+
+  // the cancel flag is not cleared here, a cancel issued before the export started (e.g. by a batch) still applies
+  if ([self stopIfCancelledWithWriter:nil error:error]) {
+    return NO;
+  }
+
+  return [self writeSnapshot:snapshot withError:error];
+}
+
+- (BOOL)writeSnapshot:(LibrarySnapshot*)snapshot withError:(NSError**)error {
+
+  [_metrics setItemCount:snapshot.trackCount forState:ExportPreparing];
+
+  // every track and playlist is assigned an ID
+  [_entityRepository reserveCapacity:(snapshot.trackCount + snapshot.playlistCount)];
+
   // configure filters
   PlaylistFilterGroup* playlistFilterGroup = [[PlaylistFilterGroup alloc]
                                               initWithBaseFiltersAndIncludeInternal:_configuration.includeInternalPlaylists
@@ -98,7 +215,11 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
   _playlistParentIDFilter = [playlistFilterGroup addFiltersForExcludedIDs:_configuration.excludedPlaylistPersistentIds
                                                       andFlattenPlaylists:_configuration.flattenPlaylistHierarchy];
 
+  // evaluate playlist filters once up front, this also excludes every descendant of an excluded folder
+  [playlistFilterGroup compileForSnapshot:snapshot];
+
   MediaItemFilterGroup* itemFilterGroup = [[MediaItemFilterGroup alloc] initWithBaseFilters];
+  [itemFilterGroup compileForSnapshot:snapshot];
 
   // configure directory mapping
   PathMapper* pathMapper = [[PathMapper alloc] init];
@@ -107,49 +228,163 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
     [pathMapper setReplaceString:_configuration.remapRootDirectoryMappedPath];
     [pathMapper setAddLocalhostPrefix:_configuration.remapRootDirectoryLocalhostPrefix];
   }
+  if (_remapRulesFileURL != nil && ![pathMapper addRulesFromURL:_remapRulesFileURL error:error]) {
+    MLE_Log_Info(@"ExportManager [writeSnapshot] error loading path mapping rules");
+    [self setState:ExportError];
+    return NO;
+  }
+
+  // progress is rate-limited rather than reported for every track + playlist
+  ProgressReporter* itemProgress = [[ProgressReporter alloc] initWithInterval:_progressInterval handler:^(NSUInteger completed, NSUInteger total) {
+    [self notifyDelegate:^(NSObject<ExportManagerDelegate>* delegate) {
+      if ([delegate respondsToSelector:@selector(exportedItems:ofTotal:)]) {
+        [delegate exportedItems:completed ofTotal:total];
+      }
+    }];
+  }];
+  ProgressReporter* playlistProgress = [[ProgressReporter alloc] initWithInterval:_progressInterval handler:^(NSUInteger completed, NSUInteger total) {
+    [self notifyDelegate:^(NSObject<ExportManagerDelegate>* delegate) {
+      if ([delegate respondsToSelector:@selector(exportedPlaylists:ofTotal:)]) {
+        [delegate exportedPlaylists:completed ofTotal:total];
+      }
+    }];
+  }];
 
   // configure item serializers
   MediaItemSerializer* itemSerializer = [[MediaItemSerializer alloc] initWithEntityRepository:_entityRepository];
   [itemSerializer setDelegate:self];
+  [itemSerializer setProgressReporter:itemProgress];
   [itemSerializer setItemFilters:itemFilterGroup];
   [itemSerializer setPathMapper:pathMapper];
+  [itemSerializer setConcurrent:(NSProcessInfo.processInfo.activeProcessorCount > 1)];
+
+  // load cached tracks from the previous export
+  // cached tracks are XML fragments, binary output can't use them
+  TrackFragmentCache* fragmentCache = nil;
+  if (_fragmentCacheURL != nil && _outputFormat != PlistWriterFormatBinary) {
+    NSString* cacheSignature = [NSString stringWithFormat:@"%d|%@|%@|%d|%@",
+                                _configuration.remapRootDirectory,
+                                _configuration.remapRootDirectoryOriginalPath,
+                                _configuration.remapRootDirectoryMappedPath,
+                                _configuration.remapRootDirectoryLocalhostPrefix,
+                                [pathMapper rulesSignature]];
+    fragmentCache = [[TrackFragmentCache alloc] initWithURL:_fragmentCacheURL andConfigurationSignature:cacheSignature];
+
+    NSError* cacheLoadError;
+    if (![fragmentCache loadWithError:&cacheLoadError]) {
+      MLE_Log_Info(@"ExportManager [writeSnapshot] ignoring unreadable track cache: %@", cacheLoadError.localizedDescription);
+    }
+    [itemSerializer setFragmentCache:fragmentCache];
+  }
 
   PlaylistSerializer* playlistSerializer = [[PlaylistSerializer alloc] initWithEntityRepository:_entityRepository];
   [playlistSerializer setDelegate:self];
+  [playlistSerializer setProgressReporter:playlistProgress];
   [playlistSerializer setPlaylistFilters:playlistFilterGroup];
   [playlistSerializer setItemFilters:itemFilterGroup];
   [playlistSerializer setFlattenFolders:_configuration.flattenPlaylistHierarchy];
   [playlistSerializer setPlaylistCustomSortProperties:_configuration.playlistCustomSortPropertyDict];
   [playlistSerializer setPlaylistCustomSortOrders:_configuration.playlistCustomSortOrderDict];
+  if (_collationKeyCache != nil) {
+    [playlistSerializer setCollationKeyCache:_collationKeyCache];
+  }
 
   LibrarySerializer* librarySerializer = [[LibrarySerializer alloc] init];
   [librarySerializer setPersistentID:_configuration.generatedPersistentLibraryId];
   [librarySerializer setMusicLibraryDir:_configuration.musicLibraryPath];
 
-  // generate items dict
+  // open output file
+  PlistWriter* writer = [PlistWriter writerWithURL:_outputFileURL format:_outputFormat];
+  [writer setSkipIfUnchanged:_skipIfUnchanged];
+  MLE_Log_Info(@"ExportManager [writeSnapshot] saving to: %@ (format: %@)", _outputFileURL, PlistWriterFormatNames[_outputFormat]);
+  if (![writer openWithError:error]) {
+    MLE_Log_Info(@"ExportManager [writeSnapshot] error opening output file");
+    [self setState:ExportError];
+    return NO;
+  }
+
+  // write library header
+  [writer writeDocumentHeader];
+  [writer beginDict];
+  [[librarySerializer serializeLibraryHeaderOfSnapshot:snapshot] enumerateKeysAndObjectsUsingBlock:^(NSString* key, id value, BOOL* stop) {
+    [writer writeKey:key];
+    // the export date differs on every run, it doesn't make the library itself any different
+    if ([key isEqualToString:@"Date"]) {
+      [writer beginVolatileOutput];
+      [writer writeValue:value];
+      [writer endVolatileOutput];
+    }
+    else {
+      [writer writeValue:value];
+    }
+  }];
+
+  // generate + stream items dict
   [self setState:ExportGeneratingTracks];
-  OrderedDictionary* itemsDict = [itemSerializer serializeItems:library.allMediaItems];
+  [_metrics setItemCount:snapshot.trackCount forState:ExportGeneratingTracks];
+  [writer writeKey:@"Tracks"];
+  [writer beginDict];
+  [itemSerializer serializeTracksOfSnapshot:snapshot toWriter:writer];
+  [writer endDict];
+
+  if ([self stopIfCancelledWithWriter:writer error:error]) {
+    return NO;
+  }
 
-  // generate playlists dicts
+  // generate + stream playlists dicts
   [self setState:ExportGeneratingPlaylists];
-  NSArray<OrderedDictionary*>* playlistsDictArr = [playlistSerializer serializePlaylists:library.allPlaylists];
+  [_metrics setItemCount:snapshot.playlistCount forState:ExportGeneratingPlaylists];
+  [writer writeKey:@"Playlists"];
+  [writer beginArray];
+  [playlistSerializer serializePlaylistsOfSnapshot:snapshot toWriter:writer];
+  [writer endArray];
 
-  // generate library dict
+  if ([self stopIfCancelledWithWriter:writer error:error]) {
+    return NO;
+  }
+
+  // close library dict
   [self setState:ExportGeneratingLibrary];
-  OrderedDictionary* libraryDict = [librarySerializer serializeLibrary:library withItems:itemsDict andPlaylists:playlistsDictArr];
+  [writer endDict];
+  [writer writeDocumentFooter];
 
-  // write library
+  // flush remaining output + move into place
   [self setState:ExportWritingToDisk];
-  MLE_Log_Info(@"ExportManager [exportLibraryWithError] saving to: %@", _outputFileURL);
-  BOOL writeSuccess = [libraryDict writeToURL:_outputFileURL error:error];
+  BOOL writeSuccess = [writer closeWithError:error];
 
   if (!writeSuccess) {
-    MLE_Log_Info(@"ExportManager [exportLibraryWithError] error writing dictionary");
+    MLE_Log_Info(@"ExportManager [writeSnapshot] error writing library");
     [self setState:ExportError];
     return NO;
   }
 
-  [self setState:ExportFinished];
+  // persist cached tracks for the next export
+  if (fragmentCache != nil) {
+    MLE_Log_Info(@"ExportManager [writeSnapshot] reused %lu cached tracks (%lu serialized)", fragmentCache.hitCount, fragmentCache.missCount);
+
+    NSError* cacheSaveError;
+    if (![fragmentCache saveWithError:&cacheSaveError]) {
+      MLE_Log_Info(@"ExportManager [writeSnapshot] failed to save track cache: %@", cacheSaveError.localizedDescription);
+    }
+  }
+
+  [self setState:(writer.isUnchanged ? ExportUnchanged : ExportFinished)];
+
+  MLE_Log_Info(@"ExportManager [writeSnapshot] export completed%@ in %.3fs (cpu: %.3fs)", (writer.isUnchanged ? @" (unchanged)" : @""), [_metrics totalWallTime], [_metrics totalCPUTime]);
+
+  if (_writeMetricsFile) {
+    NSError* metricsError;
+    if (![_metrics writeJSONToURL:[self metricsFileURL] error:&metricsError]) {
+      MLE_Log_Info(@"ExportManager [writeSnapshot] failed to write metrics: %@", metricsError.localizedDescription);
+    }
+  }
+
+  ExportMetrics* metrics = _metrics;
+  [self notifyDelegate:^(NSObject<ExportManagerDelegate>* delegate) {
+    if ([delegate respondsToSelector:@selector(exportFinishedWithMetrics:)]) {
+      [delegate exportFinishedWithMetrics:metrics];
+    }
+  }];
 
   return YES;
 }
@@ -160,14 +395,92 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
 
   _state = state;
 
-  if (_delegate != nil && [_delegate respondsToSelector:@selector(exportStateChangedFrom:toState:)]) {
-    [_delegate exportStateChangedFrom:oldState toState:state];
+  switch (state) {
+    case ExportPreparing: {
+      _metrics = [[ExportMetrics alloc] init];
+      [_metrics beginStage:state];
+      break;
+    }
+    case ExportGeneratingTracks:
+    case ExportGeneratingPlaylists:
+    case ExportGeneratingLibrary:
+    case ExportWritingToDisk: {
+      [_metrics beginStage:state];
+      break;
+    }
+    case ExportStopped:
+    case ExportFinished:
+    case ExportUnchanged:
+    case ExportError: {
+      [_metrics endStage];
+      break;
+    }
   }
+
+  [self notifyDelegate:^(NSObject<ExportManagerDelegate>* delegate) {
+    if ([delegate respondsToSelector:@selector(exportStateChangedFrom:toState:)]) {
+      [delegate exportStateChangedFrom:oldState toState:state];
+    }
+  }];
 }
 
 
 #pragma mark - Helper functions
 
+- (void)notifyDelegate:(void (^)(NSObject<ExportManagerDelegate>* delegate))notification {
+
+  NSObject<ExportManagerDelegate>* delegate = _delegate;
+  if (delegate == nil) {
+    return;
+  }
+
+  if (_delegateQueue != nil) {
+    dispatch_async(_delegateQueue, ^{
+      notification(delegate);
+    });
+  }
+  else {
+    notification(delegate);
+  }
+}
+
+- (void)callCompletionHandler:(nullable void (^)(BOOL success, NSError* _Nullable error))completionHandler withSuccess:(BOOL)success error:(nullable NSError*)error {
+
+  if (completionHandler == nil) {
+    return;
+  }
+
+  if (_delegateQueue != nil) {
+    dispatch_async(_delegateQueue, ^{
+      completionHandler(success, error);
+    });
+  }
+  else {
+    completionHandler(success, error);
+  }
+}
+
+- (BOOL)stopIfCancelledWithWriter:(nullable PlistWriter*)writer error:(NSError**)error {
+
+  if (!atomic_load(&_cancelRequested)) {
+    return NO;
+  }
+
+  MLE_Log_Info(@"ExportManager [stopIfCancelled] export cancelled - state: %@", ExportStateNames[_state]);
+
+  // output is only moved into place on close, dropping the temporary file leaves the previous export untouched
+  [writer abort];
+
+  if (error) {
+    *error = [self generateErrorForCode:ExportManagerErrorCancelled];
+  }
+
+  atomic_store(&_cancelRequested, false);
+  [self setState:ExportStopped];
+
+  return YES;
+}
+
 - (BOOL)validateConfigurationWithError:(NSError**)error {
 
   // validate state
@@ -185,6 +498,7 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
     }
     case ExportStopped:
     case ExportFinished:
+    case ExportUnchanged:
     case ExportError: {
       break;
     }
@@ -261,37 +575,35 @@ NSErrorDomain const __MLE_ErrorDomain_ExportManager = @"com.kylekingcdn.MusicLib
     case ExportManagerErrorWriteError: {
       return nil; // NSError provided by writeDictionary
     }
+    case ExportManagerErrorCancelled: {
+      return [NSError errorWithDomain:__MLE_ErrorDomain_ExportManager code:code userInfo:@{
+        NSLocalizedDescriptionKey:@"Export cancelled",
+        NSLocalizedRecoverySuggestionErrorKey:@"The existing library file has not been modified.",
+      }];
+    }
   }
 }
 
 
 #pragma mark - MediaItemSerializerDelegate
 
-- (void)serializedItems:(NSUInteger)serialized ofTotal:(NSUInteger)total {
+- (BOOL)isSerializationCancelled {
 
-  // only call delegate method on every tenth or last item
-  if (serialized % 10 == 0 || serialized == total) {
-
-    if (_delegate != nil && [_delegate respondsToSelector:@selector(exportedItems:ofTotal:)]) {
-      [_delegate exportedItems:serialized ofTotal:total];
-    }
-  }
+  return atomic_load(&_cancelRequested);
 }
 
 
 #pragma mark - PlaylistSerializerDelegate
 
-- (void)serializedPlaylists:(NSUInteger)serialized ofTotal:(NSUInteger)total {
+- (void)excludedPlaylist:(ITLibPlaylist*)playlist {
 
-  if (_delegate != nil && [_delegate respondsToSelector:@selector(exportedPlaylists:ofTotal:)]) {
-    [_delegate exportedPlaylists:serialized ofTotal:total];
-  }
+  [self excludedPlaylistWithPersistentID:playlist.persistentID];
 }
 
-- (void)excludedPlaylist:(ITLibPlaylist*)playlist {
+- (void)excludedPlaylistWithPersistentID:(NSNumber*)persistentID {
 
   if (_playlistParentIDFilter != nil) {
-    [_playlistParentIDFilter addExcludedID:playlist.persistentID];
+    [_playlistParentIDFilter addExcludedID:persistentID];
   }
 }
 
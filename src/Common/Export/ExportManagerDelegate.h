@@ -9,6 +9,8 @@
 
 #import "Defines.h"
 
+@class ExportMetrics;
+
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol ExportManagerDelegate <NSObject>
@@ -19,6 +21,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)exportedItems:(NSUInteger)exportedItems ofTotal:(NSUInteger)totalItems;
 - (void)exportedPlaylists:(NSUInteger)exportedPlaylists ofTotal:(NSUInteger)totalPlaylists;
 
+- (void)exportFinishedWithMetrics:(ExportMetrics*)metrics;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,88 @@
+//
+//  ExportMetrics.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "Defines.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Measurements for a single `ExportState`
+@interface ExportStageMetrics : NSObject
+
+@property (readonly) ExportState state;
+
+@property NSTimeInterval wallTime;
+@property NSTimeInterval cpuTime;
+
+// Physical footprint of the process when the stage started and ended, and the difference between the two.
+// The growth is negative when the stage released more memory than it used.
+@property unsigned long long footprintStartBytes;
+@property unsigned long long footprintEndBytes;
+
+- (long long)footprintGrowthBytes;
+
+// Number of tracks or playlists handled by the stage, 0 when not applicable
+@property NSUInteger itemCount;
+
+- (instancetype)initWithState:(ExportState)state;
+
+- (NSString*)name;
+
+- (NSDictionary*)dictionaryRepresentation;
+
+@end
+
+
+// Records wall time, CPU time, memory footprint growth and item counts for each stage of an export.
+//
+// CPU time is process-wide, so it includes work done on other threads (e.g. concurrent track serialization).
+// Footprints are sampled per stage, so they stay comparable between exports in the long-running helper.
+@interface ExportMetrics : NSObject
+
+#pragma mark - Properties
+
+@property (readonly) NSDate* startDate;
+
+@property (readonly) NSArray<ExportStageMetrics*>* stages;
+
+
+#pragma mark - Initializers
+
+- (instancetype)init;
+
+
+#pragma mark - Accessors
+
+- (nullable ExportStageMetrics*)metricsForState:(ExportState)state;
+
+- (NSTimeInterval)totalWallTime;
+- (NSTimeInterval)totalCPUTime;
+- (long long)footprintGrowthBytes;
+
+// Peak resident size since the process started, not just during this export
+- (unsigned long long)processPeakResidentBytes;
+
+- (NSDictionary*)dictionaryRepresentation;
+- (nullable NSData*)JSONDataWithError:(NSError**)error;
+
+- (NSString*)describe;
+
+
+#pragma mark - Mutators
+
+// Ends the current stage (if any) and starts timing the given state
+- (void)beginStage:(ExportState)state;
+- (void)endStage;
+
+- (void)setItemCount:(NSUInteger)itemCount forState:(ExportState)state;
+
+- (BOOL)writeJSONToURL:(NSURL*)url error:(NSError**)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,279 @@
+//
+//  ExportMetrics.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "ExportMetrics.h"
+
+#import <mach/mach.h>
+#import <sys/resource.h>
+#import <time.h>
+
+static NSString* const ExportStageMetricsKeys[] = {
+  @"stopped",
+  @"preparing",
+  @"tracks",
+  @"playlists",
+  @"library",
+  @"writing",
+  @"finished",
+  @"error",
+};
+
+static NSTimeInterval ExportMetricsWallClock(void) {
+
+  return clock_gettime_nsec_np(CLOCK_UPTIME_RAW) / (double)NSEC_PER_SEC;
+}
+
+static NSTimeInterval ExportMetricsCPUClock(void) {
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + ((usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / (double)USEC_PER_SEC);
+}
+
+// The footprint Activity Monitor and jetsam use, unlike the resident size it drops when memory is freed
+static unsigned long long ExportMetricsFootprintBytes(void) {
+
+  task_vm_info_data_t vmInfo;
+  mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+
+  if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&vmInfo, &count) != KERN_SUCCESS) {
+    return 0;
+  }
+
+  return vmInfo.phys_footprint;
+}
+
+static unsigned long long ExportMetricsPeakResidentBytes(void) {
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  // reported in bytes on macOS
+  return (unsigned long long)usage.ru_maxrss;
+}
+
+
+@implementation ExportStageMetrics
+
+- (instancetype)initWithState:(ExportState)state {
+
+  if (self = [super init]) {
+
+    _state = state;
+
+    _wallTime = 0;
+    _cpuTime = 0;
+    _footprintStartBytes = 0;
+    _footprintEndBytes = 0;
+    _itemCount = 0;
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+- (NSString*)name {
+
+  return ExportStageMetricsKeys[_state];
+}
+
+- (long long)footprintGrowthBytes {
+
+  return (long long)_footprintEndBytes - (long long)_footprintStartBytes;
+}
+
+- (NSDictionary*)dictionaryRepresentation {
+
+  return @{
+    @"stage": [self name],
+    @"wall_time": @(_wallTime),
+    @"cpu_time": @(_cpuTime),
+    @"footprint_start_bytes": @(_footprintStartBytes),
+    @"footprint_end_bytes": @(_footprintEndBytes),
+    @"footprint_growth_bytes": @([self footprintGrowthBytes]),
+    @"items": @(_itemCount),
+  };
+}
+
+@end
+
+
+@implementation ExportMetrics {
+
+  NSMutableArray<ExportStageMetrics*>* _stages;
+
+  ExportStageMetrics* _currentStage;
+  NSTimeInterval _currentStageWallStart;
+  NSTimeInterval _currentStageCPUStart;
+}
+
+
+#pragma mark - Initializers
+
+- (instancetype)init {
+
+  if (self = [super init]) {
+
+    _startDate = [NSDate date];
+    _stages = [NSMutableArray array];
+
+    _currentStage = nil;
+    _currentStageWallStart = 0;
+    _currentStageCPUStart = 0;
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (NSArray<ExportStageMetrics*>*)stages {
+
+  return _stages;
+}
+
+- (nullable ExportStageMetrics*)metricsForState:(ExportState)state {
+
+  for (ExportStageMetrics* stage in _stages) {
+    if (stage.state == state) {
+      return stage;
+    }
+  }
+
+  return nil;
+}
+
+- (NSTimeInterval)totalWallTime {
+
+  NSTimeInterval total = 0;
+  for (ExportStageMetrics* stage in _stages) {
+    total += stage.wallTime;
+  }
+
+  return total;
+}
+
+- (NSTimeInterval)totalCPUTime {
+
+  NSTimeInterval total = 0;
+  for (ExportStageMetrics* stage in _stages) {
+    total += stage.cpuTime;
+  }
+
+  return total;
+}
+
+- (long long)footprintGrowthBytes {
+
+  long long total = 0;
+  for (ExportStageMetrics* stage in _stages) {
+    total += [stage footprintGrowthBytes];
+  }
+
+  return total;
+}
+
+- (unsigned long long)processPeakResidentBytes {
+
+  return ExportMetricsPeakResidentBytes();
+}
+
+- (NSDictionary*)dictionaryRepresentation {
+
+  NSMutableArray<NSDictionary*>* stageDicts = [NSMutableArray arrayWithCapacity:_stages.count];
+  for (ExportStageMetrics* stage in _stages) {
+    [stageDicts addObject:[stage dictionaryRepresentation]];
+  }
+
+  NSISO8601DateFormatter* dateFormatter = [[NSISO8601DateFormatter alloc] init];
+
+  return @{
+    @"started": [dateFormatter stringFromDate:_startDate],
+    @"wall_time": @([self totalWallTime]),
+    @"cpu_time": @([self totalCPUTime]),
+    @"footprint_growth_bytes": @([self footprintGrowthBytes]),
+    @"process_peak_resident_bytes": @([self processPeakResidentBytes]),
+    @"stages": stageDicts,
+  };
+}
+
+- (nullable NSData*)JSONDataWithError:(NSError**)error {
+
+  return [NSJSONSerialization dataWithJSONObject:[self dictionaryRepresentation] options:(NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys) error:error];
+}
+
+- (NSString*)describe {
+
+  NSMutableString* description = [NSMutableString string];
+
+  [description appendFormat:@"%-10s %10s %10s %14s %10s\n", "stage", "wall (s)", "cpu (s)", "footprint (MB)", "items"];
+
+  for (ExportStageMetrics* stage in _stages) {
+    [description appendFormat:@"%-10s %10.3f %10.3f %+14.1f %10lu\n", [stage name].UTF8String, stage.wallTime, stage.cpuTime, ([stage footprintGrowthBytes] / (1024.0 * 1024.0)), stage.itemCount];
+  }
+
+  [description appendFormat:@"%-10s %10.3f %10.3f %+14.1f\n", "total", [self totalWallTime], [self totalCPUTime], ([self footprintGrowthBytes] / (1024.0 * 1024.0))];
+  [description appendFormat:@"process peak resident size (since launch): %.1f MB\n", ([self processPeakResidentBytes] / (1024.0 * 1024.0))];
+
+  return description;
+}
+
+
+#pragma mark - Mutators
+
+- (void)beginStage:(ExportState)state {
+
+  [self endStage];
+
+  _currentStage = [[ExportStageMetrics alloc] initWithState:state];
+  [_currentStage setFootprintStartBytes:ExportMetricsFootprintBytes()];
+  _currentStageWallStart = ExportMetricsWallClock();
+  _currentStageCPUStart = ExportMetricsCPUClock();
+}
+
+- (void)endStage {
+
+  if (_currentStage == nil) {
+    return;
+  }
+
+  [_currentStage setWallTime:(ExportMetricsWallClock() - _currentStageWallStart)];
+  [_currentStage setCpuTime:(ExportMetricsCPUClock() - _currentStageCPUStart)];
+  [_currentStage setFootprintEndBytes:ExportMetricsFootprintBytes()];
+
+  [_stages addObject:_currentStage];
+  _currentStage = nil;
+}
+
+- (void)setItemCount:(NSUInteger)itemCount forState:(ExportState)state {
+
+  if (_currentStage != nil && _currentStage.state == state) {
+    [_currentStage setItemCount:itemCount];
+  }
+  else {
+    [[self metricsForState:state] setItemCount:itemCount];
+  }
+}
+
+- (BOOL)writeJSONToURL:(NSURL*)url error:(NSError**)error {
+
+  NSData* jsonData = [self JSONDataWithError:error];
+  if (jsonData == nil) {
+    return NO;
+  }
+
+  return [jsonData writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+@end
@@ -0,0 +1,50 @@
+//
+//  ProgressReporter.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^ProgressReporterHandler)(NSUInteger completed, NSUInteger total);
+
+// Rate-limited progress counter.
+//
+// Workers advance an atomic counter and the handler is called at most once per `interval`, so reporting costs the hot
+// loop an atomic add plus an occasional clock read instead of a callback per item. `advanceBy:` may be called from
+// any number of threads; the handler runs on whichever thread crosses the interval and is never entered concurrently.
+@interface ProgressReporter : NSObject
+
+#pragma mark - Properties
+
+@property (readonly) NSTimeInterval interval;
+
+@property (readonly) NSUInteger total;
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithInterval:(NSTimeInterval)interval handler:(ProgressReporterHandler)handler;
+
+
+#pragma mark - Accessors
+
+- (NSUInteger)completed;
+
+
+#pragma mark - Mutators
+
+// Starts a new run, the next advance is always reported
+- (void)resetWithTotal:(NSUInteger)total;
+
+- (void)advanceBy:(NSUInteger)count;
+
+// Reports the final count, regardless of when the handler was last called
+- (void)finish;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,109 @@
+//
+//  ProgressReporter.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "ProgressReporter.h"
+
+#import <stdatomic.h>
+#import <time.h>
+
+// the clock is only read when the counter crosses a multiple of this
+static const NSUInteger ProgressReporterClockStride = 64;
+
+@implementation ProgressReporter {
+
+  ProgressReporterHandler _handler;
+
+  uint64_t _intervalNanoseconds;
+
+  atomic_ulong _completed;
+  atomic_ullong _nextReportTime;
+  atomic_flag _reporting;
+}
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithInterval:(NSTimeInterval)interval handler:(ProgressReporterHandler)handler {
+
+  if (self = [super init]) {
+
+    _interval = interval;
+    _total = 0;
+
+    _handler = handler;
+
+    _intervalNanoseconds = (uint64_t)(MAX(interval, 0) * NSEC_PER_SEC);
+
+    atomic_init(&_completed, 0);
+    atomic_init(&_nextReportTime, 0);
+    atomic_flag_clear(&_reporting);
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (NSUInteger)completed {
+
+  return atomic_load_explicit(&_completed, memory_order_relaxed);
+}
+
+
+#pragma mark - Mutators
+
+- (void)resetWithTotal:(NSUInteger)total {
+
+  _total = total;
+
+  atomic_store(&_completed, 0);
+  atomic_store(&_nextReportTime, 0);
+}
+
+- (void)advanceBy:(NSUInteger)count {
+
+  NSUInteger completed = atomic_fetch_add_explicit(&_completed, count, memory_order_relaxed) + count;
+
+  // most calls stop here without touching the clock
+  if ((completed / ProgressReporterClockStride) == ((completed - count) / ProgressReporterClockStride) && (completed - count) != 0) {
+    return;
+  }
+
+  uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  uint64_t nextReportTime = atomic_load_explicit(&_nextReportTime, memory_order_relaxed);
+
+  if (now < nextReportTime) {
+    return;
+  }
+
+  // only one thread claims each interval
+  if (!atomic_compare_exchange_strong(&_nextReportTime, &nextReportTime, now + _intervalNanoseconds)) {
+    return;
+  }
+
+  // skip the update rather than wait if a slow handler is still running
+  if (atomic_flag_test_and_set(&_reporting)) {
+    return;
+  }
+
+  _handler(MIN(atomic_load_explicit(&_completed, memory_order_relaxed), _total), _total);
+
+  atomic_flag_clear(&_reporting);
+}
+
+- (void)finish {
+
+  atomic_store(&_completed, _total);
+
+  _handler(_total, _total);
+}
+
+@end
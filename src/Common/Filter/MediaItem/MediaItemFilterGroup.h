@@ -8,6 +8,7 @@
 #import <Foundation/Foundation.h>
 
 @class ITLibMediaItem;
+@class LibrarySnapshot;
 @protocol MediaItemFiltering;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -25,6 +26,15 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeFilter:(NSObject<MediaItemFiltering>*)filter;
 
 - (BOOL)filtersPassForItem:(ITLibMediaItem*)item;
+- (BOOL)filtersPassForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot;
+
+// Returns a bitmap with one bit per track of the snapshot, set if the track passes every filter
+- (NSData*)filterTracksOfSnapshot:(LibrarySnapshot*)snapshot;
+
+// Stores the result of filterTracksOfSnapshot: so that later snapshot lookups are a single bit test.
+// Changing the group's filters discards the compiled result.
+- (void)compileForSnapshot:(LibrarySnapshot*)snapshot;
+- (BOOL)isCompiledForSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
@@ -9,12 +9,17 @@
 
 #import <iTunesLibrary/ITLibMediaItem.h>
 
+#import "LibrarySnapshot.h"
 #import "MediaItemFiltering.h"
 #import "MediaItemKindFilter.h"
 
 @implementation MediaItemFilterGroup {
 
   NSMutableArray<NSObject<MediaItemFiltering>*>* _filters;
+
+  // one bit per track of the compiled snapshot, set if the track passes
+  LibrarySnapshot* _compiledSnapshot;
+  NSData* _compiledPasses;
 }
 
 - (instancetype)init {
@@ -23,6 +28,9 @@
 
     _filters = [NSMutableArray array];
 
+    _compiledSnapshot = nil;
+    _compiledPasses = nil;
+
     return self;
   }
   else {
@@ -60,6 +68,8 @@
 - (void)setFilters:(NSArray<NSObject<MediaItemFiltering>*>*)filters {
 
   _filters = [filters mutableCopy];
+
+  [self discardCompiledFilters];
 }
 
 - (void)addFilter:(NSObject<MediaItemFiltering>*)filter {
@@ -67,6 +77,8 @@
   NSAssert(![_filters containsObject:filter], @"MediaItemFilterGroup already contains specified filter");
 
   [_filters addObject:filter];
+
+  [self discardCompiledFilters];
 }
 
 - (void)removeFilter:(NSObject<MediaItemFiltering>*)filter {
@@ -74,6 +86,8 @@
   NSAssert([_filters containsObject:filter], @"MediaItemFilterGroup does not contain specified filter");
 
   [_filters removeObject:filter];
+
+  [self discardCompiledFilters];
 }
 
 - (BOOL)filtersPassForItem:(ITLibMediaItem*)item {
@@ -87,4 +101,73 @@
   return YES;
 }
 
+- (BOOL)filtersPassForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot {
+
+  if (snapshot == _compiledSnapshot) {
+    const uint8_t* passes = _compiledPasses.bytes;
+    return (passes[track >> 3] >> (track & 7)) & 1;
+  }
+
+  for (NSObject<MediaItemFiltering>* filter in _filters) {
+    if (![filter filterPassesForTrack:track inSnapshot:snapshot]) {
+      return NO;
+    }
+  }
+
+  return YES;
+}
+
+- (NSData*)filterTracksOfSnapshot:(LibrarySnapshot*)snapshot {
+
+  NSUInteger trackCount = snapshot.trackCount;
+
+  // one byte per track while filtering, so that batch filters can operate on whole columns
+  NSMutableData* passData = [NSMutableData dataWithLength:trackCount];
+  uint8_t* passes = passData.mutableBytes;
+  memset(passes, 1, trackCount);
+
+  for (NSObject<MediaItemFiltering>* filter in _filters) {
+
+    if ([filter respondsToSelector:@selector(filterTracksOfSnapshot:passes:)]) {
+      [filter filterTracksOfSnapshot:snapshot passes:passes];
+    }
+    else {
+      for (NSUInteger track = 0; track < trackCount; track++) {
+        if (passes[track] && ![filter filterPassesForTrack:track inSnapshot:snapshot]) {
+          passes[track] = 0;
+        }
+      }
+    }
+  }
+
+  // pack into a bitmap
+  NSMutableData* bitmapData = [NSMutableData dataWithLength:((trackCount + 7) / 8)];
+  uint8_t* bitmap = bitmapData.mutableBytes;
+
+  for (NSUInteger track = 0; track < trackCount; track++) {
+    bitmap[track >> 3] |= (passes[track] << (track & 7));
+  }
+
+  return bitmapData;
+}
+
+- (BOOL)isCompiledForSnapshot:(LibrarySnapshot*)snapshot {
+
+  return (snapshot == _compiledSnapshot);
+}
+
+- (void)compileForSnapshot:(LibrarySnapshot*)snapshot {
+
+  [self discardCompiledFilters];
+
+  _compiledPasses = [self filterTracksOfSnapshot:snapshot];
+  _compiledSnapshot = snapshot;
+}
+
+- (void)discardCompiledFilters {
+
+  _compiledSnapshot = nil;
+  _compiledPasses = nil;
+}
+
 @end
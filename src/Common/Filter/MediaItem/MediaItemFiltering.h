@@ -8,12 +8,19 @@
 #import <Foundation/Foundation.h>
 
 @class ITLibMediaItem;
+@class LibrarySnapshot;
 
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol MediaItemFiltering <NSObject>
 
 - (BOOL)filterPassesForItem:(ITLibMediaItem*)item;
+- (BOOL)filterPassesForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot;
+
+@optional
+
+// Clears passes[track] for every track of the snapshot that doesn't pass, passes holds one byte per track
+- (void)filterTracksOfSnapshot:(LibrarySnapshot*)snapshot passes:(uint8_t*)passes;
 
 @end
 
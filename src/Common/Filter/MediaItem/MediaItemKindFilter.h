@@ -23,6 +23,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeKind:(ITLibMediaItemMediaKind)kind;
 
 - (BOOL)filterPassesForItem:(ITLibMediaItem*)item;
+- (BOOL)filterPassesForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot;
+- (void)filterTracksOfSnapshot:(LibrarySnapshot*)snapshot passes:(uint8_t*)passes;
 
 @end
 
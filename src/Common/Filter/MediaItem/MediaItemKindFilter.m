@@ -7,16 +7,19 @@
 
 #import "MediaItemKindFilter.h"
 
+#import "LibrarySnapshot.h"
+
 @implementation MediaItemKindFilter {
 
-  NSMutableSet<NSNumber*>* _includedKinds;
+  // bit n is set if media kind n is included, all media kinds are small integers
+  uint64_t _includedKindMask;
 }
 
 - (instancetype)init {
 
   if (self = [super init]) {
 
-    _includedKinds = [NSMutableSet set];
+    _includedKindMask = 0;
 
     return self;
   }
@@ -29,7 +32,9 @@
 
   if (self = [self init]) {
 
-    _includedKinds = [kinds mutableCopy];
+    for (NSNumber* kind in kinds) {
+      [self addKind:kind.unsignedIntegerValue];
+    }
 
     return self;
   }
@@ -48,17 +53,43 @@
 
 - (void)addKind:(ITLibMediaItemMediaKind)kind {
 
-  [_includedKinds addObject:[NSNumber numberWithUnsignedInteger:kind]];
+  NSAssert(kind < 64, @"MediaItemKindFilter media kind out of range");
+
+  _includedKindMask |= (1ULL << kind);
 }
 
 - (void)removeKind:(ITLibMediaItemMediaKind)kind {
 
-  [_includedKinds removeObject:[NSNumber numberWithUnsignedInteger:kind]];
+  if (kind < 64) {
+    _includedKindMask &= ~(1ULL << kind);
+  }
 }
 
 - (BOOL)filterPassesForItem:(ITLibMediaItem*)item {
 
-  return [_includedKinds containsObject:[NSNumber numberWithUnsignedInteger:item.mediaKind]];
+  NSUInteger kind = item.mediaKind;
+
+  return (kind < 64) && ((_includedKindMask >> kind) & 1);
+}
+
+- (BOOL)filterPassesForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot {
+
+  uint64_t kind = (uint64_t)[snapshot integerForColumn:LibrarySnapshotIntegerMediaKind ofTrack:track];
+
+  return (kind < 64) && ((_includedKindMask >> kind) & 1);
+}
+
+- (void)filterTracksOfSnapshot:(LibrarySnapshot*)snapshot passes:(uint8_t*)passes {
+
+  const int64_t* kinds = [snapshot integerColumn:LibrarySnapshotIntegerMediaKind];
+  const uint64_t includedKindMask = _includedKindMask;
+  const NSUInteger trackCount = snapshot.trackCount;
+
+  // branch free so that the compiler can vectorize the loop
+  for (NSUInteger track = 0; track < trackCount; track++) {
+    uint64_t kind = (uint64_t)kinds[track];
+    passes[track] &= (uint8_t)((kind < 64) & (includedKindMask >> (kind & 63)));
+  }
 }
 
 @end
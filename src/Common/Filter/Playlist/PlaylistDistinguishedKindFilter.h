@@ -24,6 +24,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeKind:(ITLibDistinguishedPlaylistKind)kind;
 
 - (BOOL)filterPassesForPlaylist:(ITLibPlaylist*)playlist;
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
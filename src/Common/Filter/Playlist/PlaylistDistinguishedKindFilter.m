@@ -7,6 +7,8 @@
 
 #import "PlaylistDistinguishedKindFilter.h"
 
+#import "LibrarySnapshot.h"
+
 @implementation PlaylistDistinguishedKindFilter {
 
   NSMutableSet<NSNumber*>* _includedKinds;
@@ -78,4 +80,9 @@
   return [_includedKinds containsObject:[NSNumber numberWithUnsignedInteger:playlist.distinguishedKind]];
 }
 
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  return [_includedKinds containsObject:[NSNumber numberWithUnsignedInteger:[snapshot distinguishedKindOfPlaylist:playlist]]];
+}
+
 @end
@@ -8,6 +8,7 @@
 #import <Foundation/Foundation.h>
 
 @class ITLibPlaylist;
+@class LibrarySnapshot;
 @class PlaylistParentIDFilter;
 
 @protocol PlaylistFiltering;
@@ -29,6 +30,13 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable PlaylistParentIDFilter*)addFiltersForExcludedIDs:(NSSet<NSString*>*)excludedIDs andFlattenPlaylists:(BOOL)flatten;
 
 - (BOOL)filtersPassForPlaylist:(ITLibPlaylist*)playlist;
+- (BOOL)filtersPassForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
+
+// Evaluates the filters once for every playlist in the snapshot, later snapshot lookups read the stored result.
+// If the group contains a PlaylistParentIDFilter, all descendants of an excluded playlist are excluded as well
+// (independent of playlist order). Changing the group's filters discards the compiled result.
+- (void)compileForSnapshot:(LibrarySnapshot*)snapshot;
+- (BOOL)isCompiledForSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
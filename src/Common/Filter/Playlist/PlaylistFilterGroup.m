@@ -7,6 +7,8 @@
 
 #import "PlaylistFilterGroup.h"
 
+#import "LibrarySnapshot.h"
+#import "PersistentIDMap.h"
 #import "PlaylistKindFilter.h"
 #import "PlaylistDistinguishedKindFilter.h"
 #import "PlaylistMasterFilter.h"
@@ -16,6 +18,10 @@
 @implementation PlaylistFilterGroup {
 
   NSMutableArray<NSObject<PlaylistFiltering>*>* _filters;
+
+  // one bit per playlist of the compiled snapshot, set if the playlist passes
+  LibrarySnapshot* _compiledSnapshot;
+  NSData* _compiledPasses;
 }
 
 - (instancetype)init {
@@ -24,6 +30,9 @@
 
     _filters = [NSMutableArray array];
 
+    _compiledSnapshot = nil;
+    _compiledPasses = nil;
+
     return self;
   }
   else {
@@ -82,6 +91,8 @@
 - (void)setFilters:(NSArray<NSObject<PlaylistFiltering>*>*)filters {
 
   _filters = [filters mutableCopy];
+
+  [self discardCompiledFilters];
 }
 
 - (void)addFilter:(NSObject<PlaylistFiltering>*)filter {
@@ -89,6 +100,8 @@
   NSAssert(![_filters containsObject:filter], @"PlaylistFilterGroup already contains specified filter");
 
   [_filters addObject:filter];
+
+  [self discardCompiledFilters];
 }
 
 - (void)removeFilter:(NSObject<PlaylistFiltering>*)filter {
@@ -96,6 +109,8 @@
   NSAssert([_filters containsObject:filter], @"PlaylistFilterGroup does not contain specified filter");
 
   [_filters removeObject:filter];
+
+  [self discardCompiledFilters];
 }
 
 - (nullable PlaylistParentIDFilter*)addFiltersForExcludedIDs:(NSSet<NSString*>*)excludedIDs andFlattenPlaylists:(BOOL)flatten {
@@ -127,4 +142,116 @@
   return YES;
 }
 
+- (BOOL)filtersPassForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  if (snapshot == _compiledSnapshot) {
+    const uint8_t* passes = _compiledPasses.bytes;
+    return (passes[playlist >> 3] >> (playlist & 7)) & 1;
+  }
+
+  for (NSObject<PlaylistFiltering>* filter in _filters) {
+    if (![filter filterPassesForPlaylist:playlist inSnapshot:snapshot]) {
+
+      return NO;
+    }
+  }
+
+  return YES;
+}
+
+- (BOOL)isCompiledForSnapshot:(LibrarySnapshot*)snapshot {
+
+  return (snapshot == _compiledSnapshot);
+}
+
+- (void)compileForSnapshot:(LibrarySnapshot*)snapshot {
+
+  [self discardCompiledFilters];
+
+  NSUInteger playlistCount = snapshot.playlistCount;
+
+  BOOL excludeDescendants = NO;
+  for (NSObject<PlaylistFiltering>* filter in _filters) {
+    if ([filter isKindOfClass:[PlaylistParentIDFilter class]]) {
+      excludeDescendants = YES;
+    }
+  }
+
+  // result of each playlist's own filters
+  NSMutableData* ownPassData = [NSMutableData dataWithLength:playlistCount];
+  uint8_t* ownPasses = ownPassData.mutableBytes;
+
+  for (NSUInteger playlist = 0; playlist < playlistCount; playlist++) {
+    ownPasses[playlist] = [self filtersPassForPlaylist:playlist inSnapshot:snapshot];
+  }
+
+  NSMutableData* passData = [NSMutableData dataWithLength:((playlistCount + 7) / 8)];
+  uint8_t* passes = passData.mutableBytes;
+
+  if (excludeDescendants) {
+
+    PersistentIDMap playlistIndexes;
+    PersistentIDMapInit(&playlistIndexes, playlistCount);
+    for (NSUInteger playlist = 0; playlist < playlistCount; playlist++) {
+      PersistentIDMapSet(&playlistIndexes, [snapshot persistentIDOfPlaylist:playlist], (uint32_t)(playlist + 1));
+    }
+
+    // 0 = unresolved, 1 = passes, 2 = excluded
+    NSMutableData* resolvedData = [NSMutableData dataWithLength:playlistCount];
+    uint8_t* resolved = resolvedData.mutableBytes;
+
+    NSMutableData* chainData = [NSMutableData dataWithLength:(playlistCount * sizeof(NSUInteger))];
+    NSUInteger* chain = chainData.mutableBytes;
+
+    for (NSUInteger playlist = 0; playlist < playlistCount; playlist++) {
+
+      // walk up to the first resolved ancestor (or the root), each playlist is only visited once overall
+      NSUInteger chainLength = 0;
+      NSUInteger current = playlist;
+
+      while (current != NSNotFound && resolved[current] == 0 && chainLength < playlistCount) {
+
+        chain[chainLength++] = current;
+
+        uint64_t parentID = [snapshot parentIDOfPlaylist:current];
+        uint32_t parentIndex = (parentID != 0) ? PersistentIDMapGet(&playlistIndexes, parentID) : 0;
+        current = (parentIndex != 0) ? (parentIndex - 1) : NSNotFound;
+      }
+
+      // a cycle leaves current unresolved, treat it as excluded
+      BOOL ancestorsPass = (current == NSNotFound) || (resolved[current] == 1);
+
+      while (chainLength > 0) {
+        NSUInteger node = chain[--chainLength];
+        ancestorsPass = ancestorsPass && ownPasses[node];
+        resolved[node] = ancestorsPass ? 1 : 2;
+      }
+    }
+
+    PersistentIDMapFree(&playlistIndexes);
+
+    for (NSUInteger playlist = 0; playlist < playlistCount; playlist++) {
+      if (resolved[playlist] == 1) {
+        passes[playlist >> 3] |= (1 << (playlist & 7));
+      }
+    }
+  }
+  else {
+    for (NSUInteger playlist = 0; playlist < playlistCount; playlist++) {
+      if (ownPasses[playlist]) {
+        passes[playlist >> 3] |= (1 << (playlist & 7));
+      }
+    }
+  }
+
+  _compiledPasses = passData;
+  _compiledSnapshot = snapshot;
+}
+
+- (void)discardCompiledFilters {
+
+  _compiledSnapshot = nil;
+  _compiledPasses = nil;
+}
+
 @end
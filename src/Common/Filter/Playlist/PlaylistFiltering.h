@@ -8,12 +8,14 @@
 #import <Foundation/Foundation.h>
 
 @class ITLibPlaylist;
+@class LibrarySnapshot;
 
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol PlaylistFiltering <NSObject>
 
 - (BOOL)filterPassesForPlaylist:(ITLibPlaylist*)playlist;
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
@@ -9,18 +9,21 @@
 
 #import <iTunesLibrary/ITLibPlaylist.h>
 
+#import "LibrarySnapshot.h"
+#import "PersistentIDMap.h"
 #import "Utils.h"
 
 @implementation PlaylistIDFilter {
 
-  NSMutableSet<NSString*>* _excludedIDs;
+  // persistent ID -> 1 for each excluded playlist
+  PersistentIDMap _excludedIDs;
 }
 
 - (instancetype)init {
 
   if (self = [super init]) {
 
-    _excludedIDs = [NSMutableSet set];
+    PersistentIDMapInit(&_excludedIDs, 0);
 
     return self;
   }
@@ -33,7 +36,11 @@
 
   if (self = [self init]) {
 
-    _excludedIDs = [excludedIDs mutableCopy];
+    PersistentIDMapReserve(&_excludedIDs, excludedIDs.count);
+
+    for (NSString* excludedID in excludedIDs) {
+      PersistentIDMapSet(&_excludedIDs, [Utils persistentIdForHexString:excludedID], 1);
+    }
 
     return self;
   }
@@ -42,20 +49,36 @@
   }
 }
 
+- (void)dealloc {
+
+  PersistentIDMapFree(&_excludedIDs);
+}
+
 - (void)addExcludedID:(NSNumber*)playlistID {
 
-  [_excludedIDs addObject:[Utils hexStringForPersistentId:playlistID]];
+  PersistentIDMapSet(&_excludedIDs, playlistID.unsignedLongLongValue, 1);
 }
 
 - (void)removeExcludedID:(NSNumber*)playlistID {
 
-  [_excludedIDs removeObject:[Utils hexStringForPersistentId:playlistID]];
+  PersistentIDMapRemove(&_excludedIDs, playlistID.unsignedLongLongValue);
 }
 
 - (BOOL)filterPassesForPlaylist:(ITLibPlaylist*)playlist {
 
   // excluded IDs contains the playlist's persistent ID
-  if ([_excludedIDs containsObject:[Utils hexStringForPersistentId:playlist.persistentID]]) {
+  if (PersistentIDMapGet(&_excludedIDs, playlist.persistentID.unsignedLongLongValue) != 0) {
+    return NO;
+  }
+  else {
+    return YES;
+  }
+}
+
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  // excluded IDs contains the playlist's persistent ID
+  if (PersistentIDMapGet(&_excludedIDs, [snapshot persistentIDOfPlaylist:playlist]) != 0) {
     return NO;
   }
   else {
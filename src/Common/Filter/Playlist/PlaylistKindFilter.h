@@ -23,6 +23,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeKind:(ITLibPlaylistKind)kind;
 
 - (BOOL)filterPassesForPlaylist:(ITLibPlaylist*)playlist;
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
@@ -7,6 +7,8 @@
 
 #import "PlaylistKindFilter.h"
 
+#import "LibrarySnapshot.h"
+
 @implementation PlaylistKindFilter {
 
   NSMutableSet<NSNumber*>* _includedKinds;
@@ -62,4 +64,9 @@
   return [_includedKinds containsObject:[NSNumber numberWithUnsignedInteger:playlist.kind]];
 }
 
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  return [_includedKinds containsObject:[NSNumber numberWithUnsignedInteger:[snapshot kindOfPlaylist:playlist]]];
+}
+
 @end
@@ -16,6 +16,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)init;
 
 - (BOOL)filterPassesForPlaylist:(ITLibPlaylist*)playlist;
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
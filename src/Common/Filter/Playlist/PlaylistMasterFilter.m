@@ -9,6 +9,8 @@
 
 #import <iTunesLibrary/ITLibPlaylist.h>
 
+#import "LibrarySnapshot.h"
+
 @implementation PlaylistMasterFilter
 
 - (instancetype)init {
@@ -27,4 +29,9 @@
   return playlist.master == NO;
 }
 
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  return ([snapshot flagsOfPlaylist:playlist] & LibrarySnapshotPlaylistMaster) == 0;
+}
+
 @end
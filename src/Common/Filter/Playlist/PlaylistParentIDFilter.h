@@ -20,6 +20,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeExcludedID:(NSNumber*)playlistID;
 
 - (BOOL)filterPassesForPlaylist:(ITLibPlaylist*)playlist;
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
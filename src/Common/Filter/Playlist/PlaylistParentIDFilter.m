@@ -9,18 +9,21 @@
 
 #import <iTunesLibrary/ITLibPlaylist.h>
 
+#import "LibrarySnapshot.h"
+#import "PersistentIDMap.h"
 #import "Utils.h"
 
 @implementation PlaylistParentIDFilter {
 
-  NSMutableSet<NSString*>* _excludedIDs;
+  // persistent ID -> 1 for each excluded parent
+  PersistentIDMap _excludedIDs;
 }
 
 - (instancetype)init {
 
   if (self = [super init]) {
 
-    _excludedIDs = [NSMutableSet set];
+    PersistentIDMapInit(&_excludedIDs, 0);
 
     return self;
   }
@@ -33,7 +36,11 @@
 
   if (self = [self init]) {
 
-    _excludedIDs = [excludedIDs mutableCopy];
+    PersistentIDMapReserve(&_excludedIDs, excludedIDs.count);
+
+    for (NSString* excludedID in excludedIDs) {
+      PersistentIDMapSet(&_excludedIDs, [Utils persistentIdForHexString:excludedID], 1);
+    }
 
     return self;
   }
@@ -42,22 +49,40 @@
   }
 }
 
+- (void)dealloc {
+
+  PersistentIDMapFree(&_excludedIDs);
+}
+
 - (void)addExcludedID:(NSNumber*)playlistID {
 
-  [_excludedIDs addObject:[Utils hexStringForPersistentId:playlistID]];
+  PersistentIDMapSet(&_excludedIDs, playlistID.unsignedLongLongValue, 1);
 }
 
 - (void)removeExcludedID:(NSNumber*)playlistID {
 
-  [_excludedIDs removeObject:[Utils hexStringForPersistentId:playlistID]];
+  PersistentIDMapRemove(&_excludedIDs, playlistID.unsignedLongLongValue);
 }
 
 - (BOOL)filterPassesForPlaylist:(ITLibPlaylist*)playlist {
 
-  NSString* parentPlaylistID = [Utils hexStringForPersistentId:playlist.parentID];
-  
+  uint64_t parentID = playlist.parentID.unsignedLongLongValue;
+
+  // excluded IDs contains the playlist's parent persistent ID
+  if (parentID != 0 && PersistentIDMapGet(&_excludedIDs, parentID) != 0) {
+    return NO;
+  }
+  else {
+    return YES;
+  }
+}
+
+- (BOOL)filterPassesForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  uint64_t parentID = [snapshot parentIDOfPlaylist:playlist];
+
   // excluded IDs contains the playlist's parent persistent ID
-  if (parentPlaylistID != nil && [_excludedIDs containsObject:parentPlaylistID]) {
+  if (parentID != 0 && PersistentIDMapGet(&_excludedIDs, parentID) != 0) {
     return NO;
   }
   else {
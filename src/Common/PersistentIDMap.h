@@ -0,0 +1,33 @@
+//
+//  PersistentIDMap.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Open-addressing hash table mapping persistent IDs to non-zero 32-bit values.
+//
+// Used in place of NSNumber-keyed dictionaries on hot paths. A value of 0 is reserved to mark empty slots, so lookups
+// of missing keys return 0. Concurrent lookups are safe as long as no thread is inserting.
+typedef struct {
+  uint64_t* _Nullable keys;
+  uint32_t* _Nullable values;
+  NSUInteger capacity;
+  NSUInteger count;
+} PersistentIDMap;
+
+void PersistentIDMapInit(PersistentIDMap* map, NSUInteger expectedCount);
+void PersistentIDMapFree(PersistentIDMap* map);
+
+// Grows the table so that expectedCount entries can be inserted without rehashing
+void PersistentIDMapReserve(PersistentIDMap* map, NSUInteger expectedCount);
+
+uint32_t PersistentIDMapGet(const PersistentIDMap* map, uint64_t key);
+void PersistentIDMapSet(PersistentIDMap* map, uint64_t key, uint32_t value);
+void PersistentIDMapRemove(PersistentIDMap* map, uint64_t key);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,172 @@
+//
+//  PersistentIDMap.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "PersistentIDMap.h"
+
+// keep the table at most 70% full
+static const NSUInteger PersistentIDMapMaxLoadPercent = 70;
+static const NSUInteger PersistentIDMapMinCapacity = 16;
+
+static inline NSUInteger PersistentIDMapSlot(uint64_t key, NSUInteger capacity) {
+
+  // splitmix64 finalizer, persistent IDs are not uniformly distributed in their low bits
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  key ^= key >> 31;
+
+  return (NSUInteger)key & (capacity - 1);
+}
+
+static NSUInteger PersistentIDMapCapacityForCount(NSUInteger count) {
+
+  NSUInteger capacity = PersistentIDMapMinCapacity;
+
+  while (capacity * PersistentIDMapMaxLoadPercent < count * 100) {
+    capacity <<= 1;
+  }
+
+  return capacity;
+}
+
+static void PersistentIDMapRehash(PersistentIDMap* map, NSUInteger capacity) {
+
+  uint64_t* oldKeys = map->keys;
+  uint32_t* oldValues = map->values;
+  NSUInteger oldCapacity = map->capacity;
+
+  map->keys = calloc(capacity, sizeof(uint64_t));
+  map->values = calloc(capacity, sizeof(uint32_t));
+  map->capacity = capacity;
+
+  for (NSUInteger index = 0; index < oldCapacity; index++) {
+
+    if (oldValues[index] != 0) {
+
+      NSUInteger slot = PersistentIDMapSlot(oldKeys[index], capacity);
+      while (map->values[slot] != 0) {
+        slot = (slot + 1) & (capacity - 1);
+      }
+
+      map->keys[slot] = oldKeys[index];
+      map->values[slot] = oldValues[index];
+    }
+  }
+
+  free(oldKeys);
+  free(oldValues);
+}
+
+void PersistentIDMapInit(PersistentIDMap* map, NSUInteger expectedCount) {
+
+  NSUInteger capacity = PersistentIDMapCapacityForCount(expectedCount);
+
+  map->keys = calloc(capacity, sizeof(uint64_t));
+  map->values = calloc(capacity, sizeof(uint32_t));
+  map->capacity = capacity;
+  map->count = 0;
+}
+
+void PersistentIDMapFree(PersistentIDMap* map) {
+
+  free(map->keys);
+  free(map->values);
+
+  map->keys = NULL;
+  map->values = NULL;
+  map->capacity = 0;
+  map->count = 0;
+}
+
+void PersistentIDMapReserve(PersistentIDMap* map, NSUInteger expectedCount) {
+
+  NSUInteger capacity = PersistentIDMapCapacityForCount(expectedCount);
+
+  if (capacity > map->capacity) {
+    PersistentIDMapRehash(map, capacity);
+  }
+}
+
+uint32_t PersistentIDMapGet(const PersistentIDMap* map, uint64_t key) {
+
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger slot = PersistentIDMapSlot(key, map->capacity);
+
+  while (map->values[slot] != 0) {
+
+    if (map->keys[slot] == key) {
+      return map->values[slot];
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  return 0;
+}
+
+void PersistentIDMapSet(PersistentIDMap* map, uint64_t key, uint32_t value) {
+
+  NSCAssert(value != 0, @"PersistentIDMap values must be non-zero");
+
+  if ((map->count + 1) * 100 > map->capacity * PersistentIDMapMaxLoadPercent) {
+    PersistentIDMapRehash(map, map->capacity << 1);
+  }
+
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger slot = PersistentIDMapSlot(key, map->capacity);
+
+  while (map->values[slot] != 0) {
+
+    // replace existing value
+    if (map->keys[slot] == key) {
+      map->values[slot] = value;
+      return;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  map->keys[slot] = key;
+  map->values[slot] = value;
+  map->count++;
+}
+
+void PersistentIDMapRemove(PersistentIDMap* map, uint64_t key) {
+
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger slot = PersistentIDMapSlot(key, map->capacity);
+
+  while (map->values[slot] != 0 && map->keys[slot] != key) {
+    slot = (slot + 1) & mask;
+  }
+
+  if (map->values[slot] == 0) {
+    return;
+  }
+
+  // shift later entries of the probe sequence back into the hole so that lookups never stop early
+  NSUInteger hole = slot;
+  NSUInteger next = (slot + 1) & mask;
+
+  while (map->values[next] != 0) {
+
+    NSUInteger home = PersistentIDMapSlot(map->keys[next], map->capacity);
+
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      map->keys[hole] = map->keys[next];
+      map->values[hole] = map->values[next];
+      hole = next;
+    }
+
+    next = (next + 1) & mask;
+  }
+
+  map->keys[hole] = 0;
+  map->values[hole] = 0;
+  map->count--;
+}
@@ -7,6 +7,7 @@
 
 #import <Foundation/Foundation.h>
 
+@class LibrarySnapshot;
 @class PlaylistTreeNode;
 @class PlaylistFilterGroup;
 
@@ -24,6 +25,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)initWithFilters:(PlaylistFilterGroup*)filters;
 
 - (nullable PlaylistTreeNode*)generateTreeWithError:(NSError**)error;
+- (PlaylistTreeNode*)generateTreeForSnapshot:(LibrarySnapshot*)snapshot;
 
 @end
 
@@ -10,6 +10,7 @@
 #import <iTunesLibrary/ITLibrary.h>
 #import <iTunesLibrary/ITLibPlaylist.h>
 
+#import "LibrarySnapshot.h"
 #import "PlaylistFilterGroup.h"
 #import "PlaylistTreeNode.h"
 #import "Utils.h"
@@ -55,16 +56,19 @@
 
   if (library != nil) {
 
+    NSArray<ITLibPlaylist*>* allPlaylists = library.allPlaylists;
+    NSDictionary<NSNumber*, NSArray<ITLibPlaylist*>*>* childPlaylists = [self generateChildIndexForPlaylists:allPlaylists];
+
     NSMutableArray<PlaylistTreeNode*>* topLevelPlaylists = [NSMutableArray array];
 
-    for (ITLibPlaylist* playlist in library.allPlaylists) {
+    for (ITLibPlaylist* playlist in allPlaylists) {
 
       if ([_filters filtersPassForPlaylist:playlist]) {
 
         // additional filter to only generate top level playlists when folders are retained
         if (_flattenFolders || playlist.parentID == nil) {
 
-          [topLevelPlaylists addObject:[self createNodeForPlaylist:playlist fromSourcePlaylists:library.allPlaylists]];
+          [topLevelPlaylists addObject:[self createNodeForPlaylist:playlist withChildPlaylists:childPlaylists]];
         }
       }
     }
@@ -75,7 +79,29 @@
   return root;
 }
 
-- (PlaylistTreeNode*)createNodeForPlaylist:(ITLibPlaylist*)playlist fromSourcePlaylists:(NSArray<ITLibPlaylist*>*)sourcePlaylists{
+- (NSDictionary<NSNumber*, NSArray<ITLibPlaylist*>*>*)generateChildIndexForPlaylists:(NSArray<ITLibPlaylist*>*)playlists {
+
+  NSMutableDictionary<NSNumber*, NSMutableArray<ITLibPlaylist*>*>* childPlaylists = [NSMutableDictionary dictionary];
+
+  // group playlists by parent ID, retaining their original order
+  for (ITLibPlaylist* playlist in playlists) {
+
+    if (playlist.parentID != nil) {
+
+      NSMutableArray<ITLibPlaylist*>* siblings = [childPlaylists objectForKey:playlist.parentID];
+      if (siblings == nil) {
+        siblings = [NSMutableArray array];
+        [childPlaylists setObject:siblings forKey:playlist.parentID];
+      }
+
+      [siblings addObject:playlist];
+    }
+  }
+
+  return childPlaylists;
+}
+
+- (PlaylistTreeNode*)createNodeForPlaylist:(ITLibPlaylist*)playlist withChildPlaylists:(NSDictionary<NSNumber*, NSArray<ITLibPlaylist*>*>*)childPlaylists {
 
   PlaylistTreeNode* node = [PlaylistTreeNode nodeWithPlaylist:playlist];
 
@@ -92,30 +118,106 @@
 
   // generate children if folders are enabled
   if (!_flattenFolders) {
-    [node setChildren:[self generateChildrenForPlaylist:playlist fromSourcePlaylists:sourcePlaylists]];
+    [node setChildren:[self generateChildrenForPlaylist:playlist withChildPlaylists:childPlaylists]];
   }
 
   return node;
 }
 
-- (NSArray<PlaylistTreeNode*>*)generateChildrenForPlaylist:(ITLibPlaylist*)playlist fromSourcePlaylists:(NSArray<ITLibPlaylist*>*)sourcePlaylists{
+- (NSArray<PlaylistTreeNode*>*)generateChildrenForPlaylist:(ITLibPlaylist*)playlist withChildPlaylists:(NSDictionary<NSNumber*, NSArray<ITLibPlaylist*>*>*)childPlaylists {
 
   NSMutableArray<PlaylistTreeNode*>* children = [NSMutableArray array];
 
   if (playlist.kind == ITLibPlaylistKindFolder) {
 
-    for (ITLibPlaylist* sourcePlaylist in sourcePlaylists) {
+    for (ITLibPlaylist* childPlaylist in [childPlaylists objectForKey:playlist.persistentID]) {
 
-      // sourcePlaylist is a child of the provided playlist
-      if (sourcePlaylist.parentID != nil && [sourcePlaylist.parentID isEqualToNumber:playlist.persistentID]) {
+      // generate child
+      [children addObject:[self createNodeForPlaylist:childPlaylist withChildPlaylists:childPlaylists]];
+    }
+  }
 
-        // generate child
-        [children addObject:[self createNodeForPlaylist:sourcePlaylist fromSourcePlaylists:sourcePlaylists]];
+  return children;
+}
+
+- (PlaylistTreeNode*)generateTreeForSnapshot:(LibrarySnapshot*)snapshot {
+
+  PlaylistTreeNode* root = [[PlaylistTreeNode alloc] init];
+
+  NSUInteger playlistCount = snapshot.playlistCount;
+
+  if (_filters != nil && ![_filters isCompiledForSnapshot:snapshot]) {
+    [_filters compileForSnapshot:snapshot];
+  }
+
+  // group playlist indices by parent ID, retaining their original order
+  NSMutableDictionary<NSNumber*, NSMutableArray<NSNumber*>*>* childPlaylists = [NSMutableDictionary dictionary];
+
+  for (NSUInteger playlist = 0; playlist < playlistCount; playlist++) {
+
+    uint64_t parentID = [snapshot parentIDOfPlaylist:playlist];
+
+    if (parentID != 0) {
+
+      NSNumber* parentKey = [NSNumber numberWithUnsignedLongLong:parentID];
+      NSMutableArray<NSNumber*>* siblings = [childPlaylists objectForKey:parentKey];
+      if (siblings == nil) {
+        siblings = [NSMutableArray array];
+        [childPlaylists setObject:siblings forKey:parentKey];
       }
+
+      [siblings addObject:[NSNumber numberWithUnsignedInteger:playlist]];
     }
   }
 
-  return children;
+  NSMutableArray<PlaylistTreeNode*>* topLevelPlaylists = [NSMutableArray array];
+
+  for (NSUInteger playlist = 0; playlist < playlistCount; playlist++) {
+
+    if (_filters == nil || [_filters filtersPassForPlaylist:playlist inSnapshot:snapshot]) {
+
+      // additional filter to only generate top level playlists when folders are retained
+      if (_flattenFolders || [snapshot parentIDOfPlaylist:playlist] == 0) {
+
+        [topLevelPlaylists addObject:[self createNodeForPlaylist:playlist inSnapshot:snapshot withChildPlaylists:childPlaylists]];
+      }
+    }
+  }
+
+  [root setChildren:topLevelPlaylists];
+
+  return root;
+}
+
+- (PlaylistTreeNode*)createNodeForPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot withChildPlaylists:(NSDictionary<NSNumber*, NSArray<NSNumber*>*>*)childPlaylists {
+
+  PlaylistTreeNode* node = [PlaylistTreeNode nodeWithPlaylist:playlist inSnapshot:snapshot];
+
+  NSString* playlistHexID = node.playlistPersistentHexID;
+
+  // set custom sort property
+  NSString* sortProperty = [_customSortProperties valueForKey:playlistHexID];
+  [node setCustomSortProperty:sortProperty];
+
+  // set custom sort order
+  NSString* sortOrderTitle = [_customSortOrders valueForKey:playlistHexID];
+  PlaylistSortOrderType sortOrder = [Utils playlistSortOrderForTitle:sortOrderTitle];
+  [node setCustomSortOrder:sortOrder];
+
+  // generate children if folders are enabled
+  if (!_flattenFolders && [snapshot kindOfPlaylist:playlist] == ITLibPlaylistKindFolder) {
+
+    NSMutableArray<PlaylistTreeNode*>* children = [NSMutableArray array];
+
+    NSNumber* persistentID = [NSNumber numberWithUnsignedLongLong:[snapshot persistentIDOfPlaylist:playlist]];
+    for (NSNumber* childPlaylist in [childPlaylists objectForKey:persistentID]) {
+      [children addObject:[self createNodeForPlaylist:childPlaylist.unsignedIntegerValue inSnapshot:snapshot withChildPlaylists:childPlaylists]];
+    }
+
+    [node setChildren:children];
+  }
+
+  return node;
 }
 
 @end
@@ -10,6 +10,8 @@
 
 #import "Defines.h"
 
+@class LibrarySnapshot;
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface PlaylistTreeNode : NSObject
@@ -36,6 +38,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (PlaylistTreeNode*)nodeWithPlaylist:(nullable ITLibPlaylist*)playlist;
 + (PlaylistTreeNode*)nodeWithPlaylist:(nullable ITLibPlaylist*)playlist andChildren:(NSArray<PlaylistTreeNode*>*)childNodes;
++ (PlaylistTreeNode*)nodeWithPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
 
 
 #pragma mark - Accessors
@@ -7,6 +7,7 @@
 
 #import "PlaylistTreeNode.h"
 
+#import "LibrarySnapshot.h"
 #import "PlaylistSerializer.h"
 #import "Utils.h"
 
@@ -56,6 +57,22 @@
   return node;
 }
 
++ (PlaylistTreeNode*)nodeWithPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  PlaylistTreeNode* node = [[PlaylistTreeNode alloc] init];
+
+  uint64_t parentID = [snapshot parentIDOfPlaylist:playlist];
+
+  node->_playlistPersistentHexID = [Utils hexStringForPersistentId:[NSNumber numberWithUnsignedLongLong:[snapshot persistentIDOfPlaylist:playlist]]];
+  node->_playlistParentPersistentHexID = (parentID != 0) ? [Utils hexStringForPersistentId:[NSNumber numberWithUnsignedLongLong:parentID]] : nil;
+  node->_playlistName = [snapshot nameOfPlaylist:playlist];
+  node->_playlistDistinguishedKind = (ITLibDistinguishedPlaylistKind)[snapshot distinguishedKindOfPlaylist:playlist];
+  node->_playlistKind = (ITLibPlaylistKind)[snapshot kindOfPlaylist:playlist];
+  node->_playlistMaster = ([snapshot flagsOfPlaylist:playlist] & LibrarySnapshotPlaylistMaster) != 0;
+
+  return node;
+}
+
 + (PlaylistTreeNode*)nodeWithPlaylist:(nullable ITLibPlaylist*)playlist andChildren:(NSArray<PlaylistTreeNode*>*)childNodes {
 
   PlaylistTreeNode* node = [PlaylistTreeNode nodeWithPlaylist:playlist];
@@ -0,0 +1,29 @@
+//
+//  BinaryPlistWriter.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "PlistWriter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Incrementally emits a binary property list (bplist00) to disk.
+//
+// Each object is written as soon as it is complete, children before the container that references them, so only the
+// object references of the currently open containers and the offset table are held in memory. Strings and booleans
+// are uniqued, which keeps the keys repeated in every track dict from being stored more than once.
+//
+// Fragments are not supported since object references are global to the document.
+@interface BinaryPlistWriter : PlistWriter
+
+#pragma mark - Initializers
+
+- (instancetype)initWithURL:(NSURL*)url;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,563 @@
+//
+//  BinaryPlistWriter.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "BinaryPlistWriter.h"
+
+#import "Logger.h"
+
+// marks a uniqued object that hasn't been written yet
+static uint32_t const __MLE_BinaryPlistNoObject = UINT32_MAX;
+
+static inline void BinaryPlistWriteBigEndian(uint8_t* buffer, uint64_t value, NSUInteger size) {
+
+  for (NSInteger index = size - 1; index >= 0; index--) {
+    buffer[index] = (uint8_t)(value & 0xFF);
+    value >>= 8;
+  }
+}
+
+static inline NSUInteger BinaryPlistIntegerSize(uint64_t value) {
+
+  if (value <= UINT8_MAX) {
+    return 1;
+  }
+  else if (value <= UINT16_MAX) {
+    return 2;
+  }
+  else if (value <= UINT32_MAX) {
+    return 4;
+  }
+  return 8;
+}
+
+
+// Object references of an open dict or array, kept in their encoded (big-endian) form.
+// The object count isn't known until the document is finished, so references are always written as a uint32_t.
+@interface BinaryPlistContainer : NSObject
+
+@property BOOL isDict;
+@property (readonly) NSMutableData* keyRefs;
+@property (readonly) NSMutableData* valueRefs;
+
+@end
+
+@implementation BinaryPlistContainer
+
+- (instancetype)init {
+
+  if (self = [super init]) {
+
+    _isDict = NO;
+    _keyRefs = [NSMutableData data];
+    _valueRefs = [NSMutableData data];
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+@end
+
+
+@implementation BinaryPlistWriter {
+
+  // containers are reused once closed, only the first `_containerDepth` are open
+  NSMutableArray<BinaryPlistContainer*>* _containers;
+  NSUInteger _containerDepth;
+
+  uint64_t _offset;
+  NSMutableData* _objectOffsets;
+  uint32_t _topObjectRef;
+
+  NSMutableDictionary<NSString*, NSNumber*>* _stringRefs;
+  uint32_t _trueRef;
+  uint32_t _falseRef;
+  uint32_t _fieldKeyRefs[TrackRecordFieldCount];
+
+  NSMutableData* _scratch;
+}
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithURL:(NSURL*)url {
+
+  if (self = [super initWithURL:url format:PlistWriterFormatBinary]) {
+
+    _containers = [NSMutableArray array];
+    _containerDepth = 0;
+
+    _offset = 0;
+    _objectOffsets = [NSMutableData data];
+    _topObjectRef = __MLE_BinaryPlistNoObject;
+
+    _stringRefs = [NSMutableDictionary dictionary];
+    _trueRef = __MLE_BinaryPlistNoObject;
+    _falseRef = __MLE_BinaryPlistNoObject;
+    for (NSUInteger field = 0; field < TrackRecordFieldCount; field++) {
+      _fieldKeyRefs[field] = __MLE_BinaryPlistNoObject;
+    }
+
+    _scratch = [NSMutableData data];
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (NSUInteger)depth {
+
+  return _containerDepth;
+}
+
+- (BOOL)supportsFragments {
+
+  return NO;
+}
+
+
+#pragma mark - Mutators
+
+- (void)writeDocumentHeader {
+
+  [self emitBytes:"bplist00" length:8];
+}
+
+- (void)writeDocumentFooter {
+
+  NSAssert(_topObjectRef != __MLE_BinaryPlistNoObject, @"BinaryPlistWriter document has no top-level object");
+
+  uint64_t offsetTableOffset = _offset;
+  NSUInteger objectCount = _objectOffsets.length / sizeof(uint64_t);
+  const uint64_t* objectOffsets = _objectOffsets.bytes;
+
+  // offsets only increase, so the last one determines the size
+  NSUInteger offsetSize = BinaryPlistIntegerSize(objectCount > 0 ? objectOffsets[objectCount - 1] : 0);
+
+  uint8_t encodedOffsets[4096];
+  NSUInteger encodedLength = 0;
+
+  for (NSUInteger object = 0; object < objectCount; object++) {
+    if (encodedLength + offsetSize > sizeof(encodedOffsets)) {
+      [self emitBytes:encodedOffsets length:encodedLength];
+      encodedLength = 0;
+    }
+    BinaryPlistWriteBigEndian(encodedOffsets + encodedLength, objectOffsets[object], offsetSize);
+    encodedLength += offsetSize;
+  }
+  [self emitBytes:encodedOffsets length:encodedLength];
+
+  uint8_t trailer[32] = { 0 };
+  trailer[6] = (uint8_t)offsetSize;
+  trailer[7] = (uint8_t)sizeof(uint32_t);
+  BinaryPlistWriteBigEndian(trailer + 8, objectCount, 8);
+  BinaryPlistWriteBigEndian(trailer + 16, _topObjectRef, 8);
+  BinaryPlistWriteBigEndian(trailer + 24, offsetTableOffset, 8);
+
+  [self emitBytes:trailer length:sizeof(trailer)];
+}
+
+- (void)beginDict {
+
+  [self beginContainerAsDict:YES];
+}
+
+- (void)endDict {
+
+  NSAssert(_containerDepth > 0 && _containers[_containerDepth - 1].isDict, @"BinaryPlistWriter endDict called without matching beginDict");
+
+  [self endContainer];
+}
+
+- (void)beginArray {
+
+  [self beginContainerAsDict:NO];
+}
+
+- (void)endArray {
+
+  NSAssert(_containerDepth > 0 && !_containers[_containerDepth - 1].isDict, @"BinaryPlistWriter endArray called without matching beginArray");
+
+  [self endContainer];
+}
+
+- (void)writeKey:(NSString*)key {
+
+  [self addKeyRef:[self writeStringObject:[key description]]];
+}
+
+- (void)writeValue:(id)value {
+
+  if ([value isKindOfClass:[NSDictionary class]]) {
+    [self beginDict];
+    [self writeEntriesOfDictionary:value];
+    [self endDict];
+  }
+  else if ([value isKindOfClass:[NSArray class]]) {
+    [self beginArray];
+    for (id arrayValue in value) {
+      [self writeValue:arrayValue];
+    }
+    [self endArray];
+  }
+  else {
+    [self addValueRef:[self writeScalarObject:value]];
+  }
+}
+
+- (void)writeDictArrayWithKey:(NSString*)key integerValues:(const uint32_t*)values count:(NSUInteger)count {
+
+  [self beginArray];
+
+  uint32_t keyRef = [self writeStringObject:key];
+
+  for (NSUInteger index = 0; index < count; index++) {
+
+    uint32_t valueRef = [self writeIntegerObject:values[index]];
+
+    uint8_t dict[1 + (2 * sizeof(uint32_t))];
+    dict[0] = 0xD1;
+    BinaryPlistWriteBigEndian(dict + 1, keyRef, sizeof(uint32_t));
+    BinaryPlistWriteBigEndian(dict + 1 + sizeof(uint32_t), valueRef, sizeof(uint32_t));
+
+    uint32_t dictRef = [self beginObject];
+    [self emitBytes:dict length:sizeof(dict)];
+    [self addValueRef:dictRef];
+  }
+
+  [self endArray];
+}
+
+- (void)writeEntriesOfTrackRecord:(const TrackRecord*)record {
+
+  uint64_t remainingFields = record->presentFields;
+
+  while (remainingFields != 0) {
+
+    TrackRecordField field = (TrackRecordField)__builtin_ctzll(remainingFields);
+    remainingFields &= (remainingFields - 1);
+
+    const TrackRecordFieldSchema* schema = &TrackRecordSchema[field];
+    TrackRecordValue value = record->values[field];
+
+    if (schema->type == TrackRecordValueTrueForStringKey) {
+      [self addKeyRef:[self writeStringObject:value.string]];
+    }
+    else {
+      if (_fieldKeyRefs[field] == __MLE_BinaryPlistNoObject) {
+        _fieldKeyRefs[field] = [self writeStringObject:[NSString stringWithUTF8String:schema->key]];
+      }
+      [self addKeyRef:_fieldKeyRefs[field]];
+    }
+
+    switch (schema->type) {
+      case TrackRecordValueString: {
+        [self addValueRef:[self writeStringObject:value.string]];
+        break;
+      }
+      case TrackRecordValueInteger: {
+        [self addValueRef:[self writeIntegerObject:value.integer]];
+        break;
+      }
+      case TrackRecordValueDate: {
+        [self addValueRef:[self writeDateObject:value.date]];
+        break;
+      }
+      case TrackRecordValueTrue:
+      case TrackRecordValueTrueForStringKey: {
+        [self addValueRef:[self writeBoolObject:YES]];
+        break;
+      }
+      case TrackRecordValuePersistentID: {
+        char hexString[17];
+        snprintf(hexString, sizeof(hexString), "%016llX", value.persistentID);
+        [self addValueRef:[self writeStringObject:[NSString stringWithUTF8String:hexString]]];
+        break;
+      }
+    }
+  }
+}
+
+- (NSData*)fragmentData {
+
+  NSAssert(NO, @"BinaryPlistWriter does not support fragments");
+
+  return [NSData data];
+}
+
+- (void)writeFragment:(NSData*)fragment {
+
+  NSAssert(NO, @"BinaryPlistWriter does not support fragments");
+}
+
+
+#pragma mark - Helper functions
+
+- (void)emitBytes:(const void*)bytes length:(NSUInteger)length {
+
+  [self appendBytes:bytes length:length];
+  _offset += length;
+}
+
+// Records the offset of the next object and returns its reference
+- (uint32_t)beginObject {
+
+  NSAssert(_objectOffsets.length / sizeof(uint64_t) < __MLE_BinaryPlistNoObject, @"BinaryPlistWriter object limit reached");
+
+  uint32_t ref = (uint32_t)(_objectOffsets.length / sizeof(uint64_t));
+  [_objectOffsets appendBytes:&_offset length:sizeof(_offset)];
+
+  return ref;
+}
+
+// Writes an object marker, counts that don't fit in the low nibble follow the marker as an integer
+- (void)emitMarker:(uint8_t)type count:(NSUInteger)count {
+
+  if (count < 15) {
+    uint8_t marker = type | (uint8_t)count;
+    [self emitBytes:&marker length:1];
+  }
+  else {
+    uint8_t marker = type | 0x0F;
+    [self emitBytes:&marker length:1];
+    [self emitInteger:count];
+  }
+}
+
+- (void)emitInteger:(int64_t)value {
+
+  uint8_t encoded[9];
+
+  // negative values are always 8 bytes, smaller sizes are read as unsigned
+  NSUInteger size = value < 0 ? 8 : BinaryPlistIntegerSize((uint64_t)value);
+
+  encoded[0] = 0x10 | (uint8_t)__builtin_ctzll(size);
+  BinaryPlistWriteBigEndian(encoded + 1, (uint64_t)value, size);
+
+  [self emitBytes:encoded length:(1 + size)];
+}
+
+- (uint32_t)writeIntegerObject:(int64_t)value {
+
+  uint32_t ref = [self beginObject];
+  [self emitInteger:value];
+
+  return ref;
+}
+
+- (uint32_t)writeUnsignedIntegerObject:(uint64_t)value {
+
+  if (value <= INT64_MAX) {
+    return [self writeIntegerObject:(int64_t)value];
+  }
+
+  // values above INT64_MAX need the 16 byte form
+  uint8_t encoded[17] = { 0 };
+  encoded[0] = 0x14;
+  BinaryPlistWriteBigEndian(encoded + 9, value, 8);
+
+  uint32_t ref = [self beginObject];
+  [self emitBytes:encoded length:sizeof(encoded)];
+
+  return ref;
+}
+
+- (uint32_t)writeRealObject:(double)value {
+
+  uint8_t encoded[9];
+  encoded[0] = 0x23;
+  CFSwappedFloat64 swapped = CFConvertDoubleHostToSwapped(value);
+  memcpy(encoded + 1, &swapped, sizeof(swapped));
+
+  uint32_t ref = [self beginObject];
+  [self emitBytes:encoded length:sizeof(encoded)];
+
+  return ref;
+}
+
+- (uint32_t)writeDateObject:(NSTimeInterval)timeIntervalSinceReferenceDate {
+
+  uint8_t encoded[9];
+  encoded[0] = 0x33;
+  CFSwappedFloat64 swapped = CFConvertDoubleHostToSwapped(timeIntervalSinceReferenceDate);
+  memcpy(encoded + 1, &swapped, sizeof(swapped));
+
+  uint32_t ref = [self beginObject];
+  [self emitBytes:encoded length:sizeof(encoded)];
+
+  return ref;
+}
+
+- (uint32_t)writeBoolObject:(BOOL)value {
+
+  uint32_t* cachedRef = value ? &_trueRef : &_falseRef;
+
+  if (*cachedRef == __MLE_BinaryPlistNoObject) {
+    uint8_t marker = value ? 0x09 : 0x08;
+    *cachedRef = [self beginObject];
+    [self emitBytes:&marker length:1];
+  }
+
+  return *cachedRef;
+}
+
+- (uint32_t)writeDataObject:(NSData*)data {
+
+  uint32_t ref = [self beginObject];
+  [self emitMarker:0x40 count:data.length];
+  [self emitBytes:data.bytes length:data.length];
+
+  return ref;
+}
+
+- (uint32_t)writeStringObject:(NSString*)string {
+
+  NSNumber* existingRef = [_stringRefs objectForKey:string];
+  if (existingRef != nil) {
+    return existingRef.unsignedIntValue;
+  }
+
+  uint32_t ref = [self beginObject];
+  NSUInteger length = string.length;
+
+  const char* asciiBytes = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingASCII);
+
+  if (asciiBytes == NULL) {
+
+    if (_scratch.length < (length * sizeof(unichar))) {
+      [_scratch setLength:(length * sizeof(unichar))];
+    }
+
+    NSUInteger usedLength = 0;
+    NSRange remainingRange = NSMakeRange(0, 0);
+    BOOL isASCII = [string getBytes:_scratch.mutableBytes maxLength:length usedLength:&usedLength
+                           encoding:NSASCIIStringEncoding options:0 range:NSMakeRange(0, length) remainingRange:&remainingRange];
+
+    if (isASCII && remainingRange.length == 0) {
+      asciiBytes = _scratch.bytes;
+    }
+  }
+
+  if (asciiBytes != NULL) {
+    [self emitMarker:0x50 count:length];
+    [self emitBytes:asciiBytes length:length];
+  }
+  else {
+    // everything else is stored as big-endian UTF-16
+    unichar* characters = _scratch.mutableBytes;
+    [string getCharacters:characters range:NSMakeRange(0, length)];
+    for (NSUInteger index = 0; index < length; index++) {
+      characters[index] = CFSwapInt16HostToBig(characters[index]);
+    }
+
+    [self emitMarker:0x60 count:length];
+    [self emitBytes:characters length:(length * sizeof(unichar))];
+  }
+
+  [_stringRefs setObject:[NSNumber numberWithUnsignedInt:ref] forKey:string];
+
+  return ref;
+}
+
+- (uint32_t)writeScalarObject:(id)value {
+
+  if ([value isKindOfClass:[NSString class]]) {
+    return [self writeStringObject:value];
+  }
+  else if ([value isKindOfClass:[NSNumber class]]) {
+    NSNumber* number = value;
+    if ((__bridge CFBooleanRef)number == kCFBooleanTrue) {
+      return [self writeBoolObject:YES];
+    }
+    else if ((__bridge CFBooleanRef)number == kCFBooleanFalse) {
+      return [self writeBoolObject:NO];
+    }
+    else if (number.objCType[0] == 'Q') {
+      return [self writeUnsignedIntegerObject:number.unsignedLongLongValue];
+    }
+    // matches the XML writer, which only writes numbers with a fractional part as reals
+    else if (number.doubleValue != (double)number.integerValue) {
+      return [self writeRealObject:number.doubleValue];
+    }
+    else {
+      return [self writeIntegerObject:number.longLongValue];
+    }
+  }
+  else if ([value isKindOfClass:[NSDate class]]) {
+    return [self writeDateObject:[value timeIntervalSinceReferenceDate]];
+  }
+  else if ([value isKindOfClass:[NSData class]]) {
+    return [self writeDataObject:value];
+  }
+
+  NSAssert(NO, @"BinaryPlistWriter %@ is not a supported property list type", [value class]);
+
+  return [self writeStringObject:[value description]];
+}
+
+- (void)beginContainerAsDict:(BOOL)isDict {
+
+  if (_containerDepth == _containers.count) {
+    [_containers addObject:[[BinaryPlistContainer alloc] init]];
+  }
+
+  BinaryPlistContainer* container = _containers[_containerDepth];
+  container.isDict = isDict;
+  [container.keyRefs setLength:0];
+  [container.valueRefs setLength:0];
+
+  _containerDepth++;
+}
+
+- (void)endContainer {
+
+  BinaryPlistContainer* container = _containers[_containerDepth - 1];
+  _containerDepth--;
+
+  NSUInteger count = container.valueRefs.length / sizeof(uint32_t);
+  NSAssert(!container.isDict || container.keyRefs.length == container.valueRefs.length, @"BinaryPlistWriter dict has a key without a value");
+
+  uint32_t ref = [self beginObject];
+  [self emitMarker:(container.isDict ? 0xD0 : 0xA0) count:count];
+  if (container.isDict) {
+    [self emitBytes:container.keyRefs.bytes length:container.keyRefs.length];
+  }
+  [self emitBytes:container.valueRefs.bytes length:container.valueRefs.length];
+
+  [self addValueRef:ref];
+}
+
+- (void)addKeyRef:(uint32_t)ref {
+
+  NSAssert(_containerDepth > 0 && _containers[_containerDepth - 1].isDict, @"BinaryPlistWriter key written outside of a dict");
+
+  uint8_t encoded[sizeof(uint32_t)];
+  BinaryPlistWriteBigEndian(encoded, ref, sizeof(encoded));
+  [_containers[_containerDepth - 1].keyRefs appendBytes:encoded length:sizeof(encoded)];
+}
+
+// Adds a value to the open container, or makes it the document's top-level object
+- (void)addValueRef:(uint32_t)ref {
+
+  if (_containerDepth == 0) {
+    _topObjectRef = ref;
+    return;
+  }
+
+  uint8_t encoded[sizeof(uint32_t)];
+  BinaryPlistWriteBigEndian(encoded, ref, sizeof(encoded));
+  [_containers[_containerDepth - 1].valueRefs appendBytes:encoded length:sizeof(encoded)];
+}
+
+@end
@@ -8,6 +8,7 @@
 #import <Foundation/Foundation.h>
 
 @class ITLibrary;
+@class LibrarySnapshot;
 @class OrderedDictionary;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -19,6 +20,8 @@ NS_ASSUME_NONNULL_BEGIN
 @property (copy, nullable) NSString* persistentID;
 @property (copy, nullable) NSString* musicLibraryDir;
 
+- (OrderedDictionary*)serializeLibraryHeader:(ITLibrary*)library;
+- (OrderedDictionary*)serializeLibraryHeaderOfSnapshot:(LibrarySnapshot*)snapshot;
 - (OrderedDictionary*)serializeLibrary:(ITLibrary*)library withItems:(OrderedDictionary*)items andPlaylists:(NSArray<OrderedDictionary*>*)playlists;
 
 @end
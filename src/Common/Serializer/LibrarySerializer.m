@@ -10,6 +10,7 @@
 #import <iTunesLibrary/ITLibrary.h>
 #import <OSLog/OSLog.h>
 
+#import "LibrarySnapshot.h"
 #import "OrderedDictionary.h"
 
 @implementation LibrarySerializer
@@ -28,9 +29,9 @@
   }
 }
 
-- (OrderedDictionary*)serializeLibrary:(ITLibrary*)library withItems:(OrderedDictionary*)items andPlaylists:(NSArray<OrderedDictionary*>*)playlists {
+- (OrderedDictionary*)serializeLibraryHeader:(ITLibrary*)library {
 
-  os_log_debug(OS_LOG_DEFAULT, "Serializing library dict - '%{public}@'. (item count: %lu, top-level playlist count: %lu)", library.musicFolderLocation, items.count, playlists.count);
+  os_log_debug(OS_LOG_DEFAULT, "Serializing library header - '%{public}@'", library.musicFolderLocation);
 
   MutableOrderedDictionary* libraryDict = [MutableOrderedDictionary dictionary];
 
@@ -43,6 +44,32 @@
   [libraryDict setValue:[NSNumber numberWithUnsignedInteger:library.features] forKey:@"Features"];
   [libraryDict setValue:@(library.showContentRating) forKey:@"Show Content Ratings"];
 
+  [self addFolderEntriesToDictionary:libraryDict];
+
+  return libraryDict;
+}
+
+- (OrderedDictionary*)serializeLibraryHeaderOfSnapshot:(LibrarySnapshot*)snapshot {
+
+  os_log_debug(OS_LOG_DEFAULT, "Serializing library header from snapshot");
+
+  MutableOrderedDictionary* libraryDict = [MutableOrderedDictionary dictionary];
+
+  [libraryDict setValue:[NSNumber numberWithUnsignedInteger:snapshot.apiMajorVersion] forKey:@"Major Version"];
+  [libraryDict setValue:[NSNumber numberWithUnsignedInteger:snapshot.apiMinorVersion] forKey:@"Minor Version"];
+
+  [libraryDict setValue:[NSDate date] forKey:@"Date"];
+  [libraryDict setValue:snapshot.applicationVersion forKey:@"Application Version"];
+  [libraryDict setValue:[NSNumber numberWithUnsignedInteger:snapshot.features] forKey:@"Features"];
+  [libraryDict setValue:@(snapshot.showContentRating) forKey:@"Show Content Ratings"];
+
+  [self addFolderEntriesToDictionary:libraryDict];
+
+  return libraryDict;
+}
+
+- (void)addFolderEntriesToDictionary:(MutableOrderedDictionary*)libraryDict {
+
   if (_persistentID != nil) {
     [libraryDict setValue:_persistentID forKey:@"Library Persistent ID"];
   }
@@ -58,6 +85,14 @@
   else {
     os_log_info(OS_LOG_DEFAULT, "Skipping library dict 'Music Folder', Music library directory is either NULL or empty");
   }
+}
+
+- (OrderedDictionary*)serializeLibrary:(ITLibrary*)library withItems:(OrderedDictionary*)items andPlaylists:(NSArray<OrderedDictionary*>*)playlists {
+
+  os_log_debug(OS_LOG_DEFAULT, "Serializing library dict - '%{public}@'. (item count: %lu, top-level playlist count: %lu)", library.musicFolderLocation, items.count, playlists.count);
+
+  MutableOrderedDictionary* libraryDict = [MutableOrderedDictionary dictionary];
+  [libraryDict addEntriesFromDictionary:[self serializeLibraryHeader:library]];
 
   // set tracks/items
   [libraryDict setObject:items forKey:@"Tracks"];
@@ -15,8 +15,15 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (instancetype)init;
 
+// Pre-size storage for the expected number of entities (tracks + playlists)
+- (void)reserveCapacity:(NSUInteger)count;
+
 - (nullable NSNumber*)getIDForEntity:(ITLibMediaEntity*)entity;
 
+// Unboxed variants of getIDForEntity:, returning 0 for a nil entity
+- (NSUInteger)getRawIDForEntity:(nullable ITLibMediaEntity*)entity;
+- (NSUInteger)getRawIDForPersistentID:(uint64_t)persistentID;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -9,11 +9,13 @@
 
 #import <iTunesLibrary/ITLibMediaEntity.h>
 
+#import "PersistentIDMap.h"
+
 @implementation MediaEntityRepository {
 
   NSUInteger _currentEntityID;
 
-  NSMutableDictionary* _entityIDs;
+  PersistentIDMap _entityIDs;
 }
 
 - (instancetype)init {
@@ -21,7 +23,7 @@
   if (self = [super init]) {
 
     _currentEntityID = 1;
-    _entityIDs = [NSMutableDictionary dictionary];
+    PersistentIDMapInit(&_entityIDs, 0);
 
     return self;
   }
@@ -30,18 +32,42 @@
   }
 }
 
+- (void)dealloc {
+
+  PersistentIDMapFree(&_entityIDs);
+}
+
+- (void)reserveCapacity:(NSUInteger)count {
+
+  PersistentIDMapReserve(&_entityIDs, count);
+}
+
 - (nullable NSNumber*)getIDForEntity:(ITLibMediaEntity*)entity {
 
   if (entity == nil) {
     return nil;
   }
 
-  NSNumber* entityID = [_entityIDs objectForKey:entity.persistentID];
+  return [NSNumber numberWithUnsignedInteger:[self getRawIDForPersistentID:entity.persistentID.unsignedLongLongValue]];
+}
+
+- (NSUInteger)getRawIDForEntity:(nullable ITLibMediaEntity*)entity {
+
+  if (entity == nil) {
+    return 0;
+  }
+
+  return [self getRawIDForPersistentID:entity.persistentID.unsignedLongLongValue];
+}
+
+- (NSUInteger)getRawIDForPersistentID:(uint64_t)persistentID {
+
+  NSUInteger entityID = PersistentIDMapGet(&_entityIDs, persistentID);
 
   // not stored yet
-  if (entityID == nil) {
-    entityID = [NSNumber numberWithUnsignedInteger:_currentEntityID++];
-    [_entityIDs setObject:entityID forKey:entity.persistentID];
+  if (entityID == 0) {
+    entityID = _currentEntityID++;
+    PersistentIDMapSet(&_entityIDs, persistentID, (uint32_t)entityID);
   }
 
   return entityID;
@@ -9,10 +9,14 @@
 #import "MediaItemSerializerDelegate.h"
 
 @class ITLibMediaItem;
+@class LibrarySnapshot;
 @class MediaEntityRepository;
 @class MediaItemFilterGroup;
 @class PathMapper;
+@class PlistWriter;
 @class OrderedDictionary;
+@class ProgressReporter;
+@class TrackFragmentCache;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -23,12 +27,25 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nullable, weak) MediaItemFilterGroup* itemFilters;
 @property (nullable, weak) PathMapper* pathMapper;
 
+// Serialize items in chunks across all available cores when streaming to a writer. Output order is unchanged.
+@property BOOL concurrent;
+@property NSUInteger chunkSize;
+
+// Reuse previously serialized tracks when streaming to a writer
+@property (nullable, weak) TrackFragmentCache* fragmentCache;
+
+// Advanced as tracks are streamed to a writer, in place of per-item `serializedItems:ofTotal:` delegate calls
+@property (nullable, weak) ProgressReporter* progressReporter;
+
 - (instancetype) init;
 - (instancetype) initWithEntityRepository:(MediaEntityRepository*)entityRepository;
 
 - (OrderedDictionary*)serializeItems:(NSArray<ITLibMediaItem*>*)items;
 - (OrderedDictionary*)serializeItem:(ITLibMediaItem*)item;
 
+- (void)serializeTracksOfSnapshot:(LibrarySnapshot*)snapshot toWriter:(PlistWriter*)writer;
+- (OrderedDictionary*)serializeTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot;
+
 @end
 
 NS_ASSUME_NONNULL_END
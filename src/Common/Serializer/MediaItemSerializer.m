@@ -11,11 +11,16 @@
 #import <iTunesLibrary/ITLibArtist.h>
 #import <iTunesLibrary/ITLibAlbum.h>
 
+#import "LibrarySnapshot.h"
 #import "Logger.h"
 #import "MediaEntityRepository.h"
 #import "MediaItemFilterGroup.h"
 #import "OrderedDictionary.h"
 #import "PathMapper.h"
+#import "PlistWriter.h"
+#import "ProgressReporter.h"
+#import "TrackFragmentCache.h"
+#import "TrackRecord.h"
 #import "Utils.h"
 
 @implementation MediaItemSerializer {
@@ -34,6 +39,13 @@
     _itemFilters = nil;
     _pathMapper = nil;
 
+    _concurrent = NO;
+    _chunkSize = 256;
+
+    _fragmentCache = nil;
+
+    _progressReporter = nil;
+
     _entityRepository = nil;
 
     _mediaItemKindMappings = nil;
@@ -74,7 +86,7 @@
 
   os_log_debug(OS_LOG_DEFAULT, "Beginning batch MediaItem serialize (item count: %lu)", items.count);
 
-  MutableOrderedDictionary* itemsDict = [MutableOrderedDictionary dictionary];
+  MutableOrderedDictionary* itemsDict = [MutableOrderedDictionary dictionaryWithCapacity:items.count];
 
   NSUInteger serializedItems = 0;
   NSUInteger totalItems = items.count;
@@ -84,8 +96,8 @@
     if (_itemFilters == nil || [_itemFilters filtersPassForItem:item]) {
       os_log_debug(OS_LOG_DEFAULT, "Media item passed current filters (%{public}@ - %{public}@)", (item.artist != nil ? item.artist.name : @"ERROR - NIL ARTIST"), item.title);
 
-      // add item dict to main items dict with key of item ID
-      [itemsDict setObject:[self serializeItem:item] forKey:[[_entityRepository getIDForEntity:item] stringValue]];
+      // add item dict to main items dict with key of item ID, every item has its own ID so the key can't exist yet
+      [itemsDict appendObject:[self serializeItem:item] forUniqueKey:[[_entityRepository getIDForEntity:item] stringValue]];
     }
 
     serializedItems++;
@@ -104,9 +116,17 @@
                (item.artist != nil ? item.artist.name : @"ERR_NIL-ARTIST"), item.title,
                (item.location != nil ? item.location.absoluteString : @"---- FILE PATH IS NULL ----"));
 
-  MutableOrderedDictionary* itemDict = [MutableOrderedDictionary dictionary];
+  // sized for every key a track can have
+  MutableOrderedDictionary* itemDict = [MutableOrderedDictionary dictionaryWithCapacity:TrackRecordFieldCount];
 
   [itemDict setValue:[_entityRepository getIDForEntity:item] forKey:@"Track ID"];
+  [self addPropertiesOfItem:item toDictionary:itemDict];
+
+  return itemDict;
+}
+
+- (void)addPropertiesOfItem:(ITLibMediaItem*)item toDictionary:(MutableOrderedDictionary*)itemDict {
+
   [itemDict setValue:item.title forKey:@"Name"];
   if (item.artist.name) {
     [itemDict setValue:item.artist.name forKey:@"Artist"];
@@ -262,8 +282,318 @@
                 item.title
                 );
   }
+}
 
-  return itemDict;
+- (void)serializeTracksOfSnapshot:(LibrarySnapshot*)snapshot toWriter:(PlistWriter*)writer {
+
+  if (_itemFilters != nil && ![_itemFilters isCompiledForSnapshot:snapshot]) {
+    [_itemFilters compileForSnapshot:snapshot];
+  }
+
+  // chunks are rendered as fragments, which not every output format supports
+  if (_concurrent && [writer supportsFragments] && snapshot.trackCount > _chunkSize) {
+    [self serializeTracksOfSnapshotConcurrently:snapshot toWriter:writer];
+    return;
+  }
+
+  os_log_debug(OS_LOG_DEFAULT, "Beginning streamed track serialize (track count: %lu)", snapshot.trackCount);
+
+  NSUInteger totalTracks = snapshot.trackCount;
+  NSUInteger chunkSize = MAX(_chunkSize, 1);
+
+  BOOL cancellable = (_delegate != nil && [_delegate respondsToSelector:@selector(isSerializationCancelled)]);
+
+  ProgressReporter* progressReporter = _progressReporter;
+  [progressReporter resetWithTotal:totalTracks];
+
+  // records are written as soon as they're built, so the arena only ever needs to hold one chunk
+  TrackRecordArena arena;
+  TrackRecordArenaInit(&arena, chunkSize);
+
+  for (NSUInteger track = 0; track < totalTracks; track++) {
+
+    if (track % chunkSize == 0) {
+      TrackRecordArenaReset(&arena);
+    }
+
+    if (cancellable && [_delegate isSerializationCancelled]) {
+      os_log_info(OS_LOG_DEFAULT, "Track serialization cancelled after %lu of %lu tracks", track, totalTracks);
+      break;
+    }
+
+    // release each track's temporary objects as soon as it has been written
+    @autoreleasepool {
+
+      if (_itemFilters == nil || [_itemFilters filtersPassForTrack:track inSnapshot:snapshot]) {
+
+        // write track dict to the open tracks dict with key of track ID
+        [self writeTrack:track inSnapshot:snapshot toWriter:writer withArena:&arena];
+      }
+    }
+
+    [progressReporter advanceBy:1];
+  }
+
+  TrackRecordArenaFree(&arena);
+
+  [progressReporter finish];
+}
+
+- (void)serializeTracksOfSnapshotConcurrently:(LibrarySnapshot*)snapshot toWriter:(PlistWriter*)writer {
+
+  NSUInteger totalTracks = snapshot.trackCount;
+  NSUInteger chunkSize = MAX(_chunkSize, 1);
+
+  os_log_debug(OS_LOG_DEFAULT, "Beginning concurrent track serialize (track count: %lu, chunk size: %lu)", totalTracks, chunkSize);
+
+  // filter + assign IDs serially so that they match the single-threaded output
+  NSMutableData* includedTrackData = [NSMutableData dataWithCapacity:(totalTracks * sizeof(uint32_t))];
+
+  for (NSUInteger track = 0; track < totalTracks; track++) {
+    if (_itemFilters == nil || [_itemFilters filtersPassForTrack:track inSnapshot:snapshot]) {
+      uint32_t includedTrack = (uint32_t)track;
+      [includedTrackData appendBytes:&includedTrack length:sizeof(includedTrack)];
+      [_entityRepository getRawIDForPersistentID:[snapshot persistentIDOfTrack:track]];
+    }
+  }
+
+  const uint32_t* includedTracks = includedTrackData.bytes;
+  NSUInteger includedCount = includedTrackData.length / sizeof(uint32_t);
+
+  // bound memory by only keeping a few chunks per core in flight
+  NSUInteger chunksPerBatch = MAX(NSProcessInfo.processInfo.activeProcessorCount * 4, 1);
+  NSUInteger batchSize = chunkSize * chunksPerBatch;
+
+  NSUInteger fragmentDepth = writer.depth;
+
+  NSObject<MediaItemSerializerDelegate>* delegate = _delegate;
+  BOOL cancellable = (delegate != nil && [delegate respondsToSelector:@selector(isSerializationCancelled)]);
+
+  // progress is counted in snapshot tracks, so each chunk also accounts for the filtered tracks preceding it
+  ProgressReporter* progressReporter = _progressReporter;
+  [progressReporter resetWithTotal:totalTracks];
+
+  for (NSUInteger batchStart = 0; batchStart < includedCount; batchStart += batchSize) {
+
+    if (cancellable && [delegate isSerializationCancelled]) {
+      os_log_info(OS_LOG_DEFAULT, "Concurrent track serialization cancelled after %lu of %lu included tracks", batchStart, includedCount);
+      return;
+    }
+
+    NSUInteger batchEnd = MIN(batchStart + batchSize, includedCount);
+    NSUInteger batchChunkCount = (batchEnd - batchStart + chunkSize - 1) / chunkSize;
+
+    NSMutableArray<NSData*>* fragments = [NSMutableArray arrayWithCapacity:batchChunkCount];
+    for (NSUInteger chunkIndex = 0; chunkIndex < batchChunkCount; chunkIndex++) {
+      [fragments addObject:[NSData data]];
+    }
+
+    // chunks are picked up by idle worker threads as they become available
+    dispatch_apply(batchChunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunkIndex) {
+
+      // remaining chunks of a cancelled batch are skipped, their output is discarded anyway
+      if (cancellable && [delegate isSerializationCancelled]) {
+        return;
+      }
+
+      NSUInteger chunkStart = batchStart + (chunkIndex * chunkSize);
+      NSUInteger chunkEnd = MIN(chunkStart + chunkSize, batchEnd);
+
+      PlistWriter* fragmentWriter = [[PlistWriter alloc] initFragmentWithDepth:fragmentDepth];
+
+      // one block holds every record of the chunk
+      TrackRecordArena arena;
+      TrackRecordArenaInit(&arena, chunkEnd - chunkStart);
+
+      for (NSUInteger trackIndex = chunkStart; trackIndex < chunkEnd; trackIndex++) {
+        @autoreleasepool {
+          [self writeTrack:includedTracks[trackIndex] inSnapshot:snapshot toWriter:fragmentWriter withArena:&arena];
+        }
+      }
+
+      TrackRecordArenaFree(&arena);
+
+      @synchronized (fragments) {
+        fragments[chunkIndex] = [fragmentWriter fragmentData];
+      }
+
+      NSUInteger spanStart = (chunkStart == 0) ? 0 : includedTracks[chunkStart];
+      NSUInteger spanEnd = (chunkEnd == includedCount) ? totalTracks : includedTracks[chunkEnd];
+      [progressReporter advanceBy:(spanEnd - spanStart)];
+    });
+
+    // merge chunks back in their original order
+    for (NSData* fragment in fragments) {
+      [writer writeFragment:fragment];
+    }
+  }
+
+  [progressReporter finish];
+}
+
+- (OrderedDictionary*)serializeTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot {
+
+  TrackRecordArena arena;
+  TrackRecordArenaInit(&arena, 1);
+
+  TrackRecord* record = TrackRecordArenaAllocate(&arena);
+  TrackRecordSetInteger(record, TrackRecordFieldTrackID, (int64_t)[_entityRepository getRawIDForPersistentID:[snapshot persistentIDOfTrack:track]]);
+  [self addPropertiesOfTrack:track inSnapshot:snapshot toRecord:record withArena:&arena];
+
+  MutableOrderedDictionary* trackDict = TrackRecordDictionary(record);
+
+  TrackRecordArenaFree(&arena);
+
+  return trackDict;
+}
+
+- (void)addPropertiesOfTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot toRecord:(TrackRecord*)record withArena:(TrackRecordArena*)arena {
+
+  // mirrors addPropertiesOfItem:toDictionary: so that both produce identical output
+  NSString* title = [snapshot stringForColumn:LibrarySnapshotStringTitle ofTrack:track];
+  NSString* artist = [snapshot stringForColumn:LibrarySnapshotStringArtist ofTrack:track];
+  NSString* composer = [snapshot stringForColumn:LibrarySnapshotStringComposer ofTrack:track];
+  NSString* album = [snapshot stringForColumn:LibrarySnapshotStringAlbum ofTrack:track];
+  NSString* genre = [snapshot stringForColumn:LibrarySnapshotStringGenre ofTrack:track];
+
+  LibrarySnapshotTrackFlags flags = [snapshot flagsOfTrack:track];
+
+  TrackRecordSetString(record, TrackRecordFieldName, title);
+  TrackRecordSetString(record, TrackRecordFieldArtist, artist);
+  TrackRecordSetString(record, TrackRecordFieldAlbumArtist, [snapshot stringForColumn:LibrarySnapshotStringAlbumArtist ofTrack:track]);
+  if (composer.length > 0) {
+    TrackRecordSetString(record, TrackRecordFieldComposer, composer);
+  }
+  if (album.length > 0) {
+    TrackRecordSetString(record, TrackRecordFieldAlbum, album);
+  }
+  TrackRecordSetString(record, TrackRecordFieldGrouping, [snapshot stringForColumn:LibrarySnapshotStringGrouping ofTrack:track]);
+  if (genre.length > 0) {
+    TrackRecordSetString(record, TrackRecordFieldGenre, genre);
+  }
+  TrackRecordSetString(record, TrackRecordFieldKind, [snapshot stringForColumn:LibrarySnapshotStringKind ofTrack:track]);
+  TrackRecordSetString(record, TrackRecordFieldComments, [snapshot stringForColumn:LibrarySnapshotStringComments ofTrack:track]);
+
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerFileSize ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldSize];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerTotalTime ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldTotalTime];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerStartTime ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldStartTime];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerStopTime ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldStopTime];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerDiscNumber ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldDiscNumber];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerDiscCount ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldDiscCount];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerTrackNumber ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldTrackNumber];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerTrackCount ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldTrackCount];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerYear ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldYear];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerBeatsPerMinute ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldBPM];
+  TrackRecordSetDate(record, TrackRecordFieldDateModified, [snapshot timeIntervalForColumn:LibrarySnapshotDateModified ofTrack:track]);
+  TrackRecordSetDate(record, TrackRecordFieldDateAdded, [snapshot timeIntervalForColumn:LibrarySnapshotDateAdded ofTrack:track]);
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerBitRate ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldBitRate];
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerSampleRate ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldSampleRate];
+
+  int64_t volumeAdjustment = [snapshot integerForColumn:LibrarySnapshotIntegerVolumeAdjustment ofTrack:track];
+  if (volumeAdjustment != 0) {
+    TrackRecordSetInteger(record, TrackRecordFieldVolumeAdjustment, volumeAdjustment);
+  }
+  if (flags & LibrarySnapshotTrackGapless) {
+    TrackRecordSetTrue(record, TrackRecordFieldGapless);
+  }
+  int64_t rating = [snapshot integerForColumn:LibrarySnapshotIntegerRating ofTrack:track];
+  if (rating != 0) {
+    TrackRecordSetInteger(record, TrackRecordFieldRating, rating);
+  }
+  if (flags & LibrarySnapshotTrackRatingComputed) {
+    TrackRecordSetTrue(record, TrackRecordFieldRatingComputed);
+  }
+  int64_t albumRating = [snapshot integerForColumn:LibrarySnapshotIntegerAlbumRating ofTrack:track];
+  if (albumRating != 0) {
+    TrackRecordSetInteger(record, TrackRecordFieldAlbumRating, albumRating);
+  }
+  if (flags & LibrarySnapshotTrackAlbumRatingComputed) {
+    TrackRecordSetTrue(record, TrackRecordFieldAlbumRatingComputed);
+  }
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerPlayCount ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldPlayCount];
+  TrackRecordSetDate(record, TrackRecordFieldPlayDate, [snapshot timeIntervalForColumn:LibrarySnapshotDateLastPlayed ofTrack:track]);
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerSkipCount ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldSkipCount];
+  TrackRecordSetDate(record, TrackRecordFieldSkipDate, [snapshot timeIntervalForColumn:LibrarySnapshotDateSkipped ofTrack:track]);
+  TrackRecordSetDate(record, TrackRecordFieldReleaseDate, [snapshot timeIntervalForColumn:LibrarySnapshotDateReleased ofTrack:track]);
+  [self addPositiveIntegerColumn:LibrarySnapshotIntegerNormalization ofTrack:track inSnapshot:snapshot toRecord:record asField:TrackRecordFieldNormalization];
+  if (flags & LibrarySnapshotTrackCompilation) {
+    TrackRecordSetTrue(record, TrackRecordFieldCompilation);
+  }
+  TrackRecordSetString(record, TrackRecordFieldSortAlbum, [snapshot stringForColumn:LibrarySnapshotStringSortAlbum ofTrack:track]);
+  TrackRecordSetString(record, TrackRecordFieldSortAlbumArtist, [snapshot stringForColumn:LibrarySnapshotStringSortAlbumArtist ofTrack:track]);
+  TrackRecordSetString(record, TrackRecordFieldSortArtist, [snapshot stringForColumn:LibrarySnapshotStringSortArtist ofTrack:track]);
+  TrackRecordSetString(record, TrackRecordFieldSortComposer, [snapshot stringForColumn:LibrarySnapshotStringSortComposer ofTrack:track]);
+  TrackRecordSetString(record, TrackRecordFieldSortName, [snapshot stringForColumn:LibrarySnapshotStringSortTitle ofTrack:track]);
+  if (flags & LibrarySnapshotTrackDisabled) {
+    TrackRecordSetTrue(record, TrackRecordFieldDisabled);
+  }
+
+  TrackRecordSetPersistentID(record, TrackRecordFieldPersistentID, [snapshot persistentIDOfTrack:track]);
+
+  // add boolean attributes for media kind
+  NSString* mediaItemKindStr = [[NSNumber numberWithLongLong:[snapshot integerForColumn:LibrarySnapshotIntegerMediaKind ofTrack:track]] stringValue];
+  TrackRecordSetString(record, TrackRecordFieldMediaKind, [_mediaItemKindMappings objectForKey:mediaItemKindStr]);
+
+  NSString* location = [snapshot stringForColumn:LibrarySnapshotStringLocation ofTrack:track];
+  if (location != nil) {
+    // mapped paths aren't owned by the snapshot, the arena keeps them alive until the record has been written
+    NSString* mappedLocation = [_pathMapper mapFilePath:location];
+    if (mappedLocation != nil) {
+      TrackRecordSetString(record, TrackRecordFieldLocation, TrackRecordArenaRetainObject(arena, mappedLocation));
+    }
+  }
+  else {
+    os_log_info(OS_LOG_DEFAULT, "Skipping path mapping - item location is NULL: (%{public}@ - %{public}@)", (artist != nil ? artist : @"ERR_NIL-ARTIST"), title);
+  }
+}
+
+- (void)addPositiveIntegerColumn:(LibrarySnapshotIntegerColumn)column ofTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot toRecord:(TrackRecord*)record asField:(TrackRecordField)field {
+
+  int64_t value = [snapshot integerForColumn:column ofTrack:track];
+
+  if (value > 0) {
+    TrackRecordSetInteger(record, field, value);
+  }
+}
+
+- (void)writeTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot toWriter:(PlistWriter*)writer withArena:(TrackRecordArena*)arena {
+
+  NSUInteger trackID = [_entityRepository getRawIDForPersistentID:[snapshot persistentIDOfTrack:track]];
+
+  if (_fragmentCache == nil || ![writer supportsFragments]) {
+
+    TrackRecord* record = TrackRecordArenaAllocate(arena);
+    TrackRecordSetInteger(record, TrackRecordFieldTrackID, (int64_t)trackID);
+    [self addPropertiesOfTrack:track inSnapshot:snapshot toRecord:record withArena:arena];
+
+    [writer writeKey:[NSString stringWithFormat:@"%lu", trackID]];
+    [writer beginDict];
+    [writer writeEntriesOfTrackRecord:record];
+    [writer endDict];
+    return;
+  }
+
+  uint64_t fingerprint;
+  NSData* fragment = [_fragmentCache fragmentForTrack:track inSnapshot:snapshot fingerprint:&fingerprint];
+
+  // track changed or not cached yet, serialize everything after the Track ID
+  if (fragment == nil) {
+
+    TrackRecord* record = TrackRecordArenaAllocate(arena);
+    [self addPropertiesOfTrack:track inSnapshot:snapshot toRecord:record withArena:arena];
+
+    PlistWriter* fragmentWriter = [[PlistWriter alloc] initFragmentWithDepth:(writer.depth + 1)];
+    [fragmentWriter writeEntriesOfTrackRecord:record];
+
+    fragment = [fragmentWriter fragmentData];
+    [_fragmentCache setFragment:fragment withFingerprint:fingerprint forTrack:track inSnapshot:snapshot];
+  }
+
+  [writer writeKey:[NSString stringWithFormat:@"%lu", trackID]];
+  [writer beginDict];
+  [writer writeValue:[NSNumber numberWithUnsignedInteger:trackID] forKey:@"Track ID"];
+  [writer writeFragment:fragment];
+  [writer endDict];
 }
 
 @end
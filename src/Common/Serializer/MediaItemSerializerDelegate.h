@@ -14,6 +14,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)serializedItems:(NSUInteger)serialized ofTotal:(NSUInteger)total;
 
+// Polled between items, serialization stops early once this returns YES
+- (BOOL)isSerializationCancelled;
+
 @end
 
 NS_ASSUME_NONNULL_END
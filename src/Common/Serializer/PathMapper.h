@@ -9,15 +9,49 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Converts track file paths into the (optionally remapped) file URLs written to the library.
+//
+// Prefix rules only match whole path components at the start of the path (`/Volumes/Music` does not match
+// `/Volumes/Music2`), and compare accented characters regardless of their Unicode normalization form. They are compiled
+// into a byte trie so that every path is matched in a single pass regardless of the number of rules. When several
+// prefixes match, the longest one is used.
+//
+// An absolute `searchString` is matched as one more prefix rule, which takes precedence over a rule with the same
+// prefix. Any other `searchString` is replaced wherever it occurs in the path, before the rules are applied.
+//
+// The URL of each parent directory is cached, so only the filename is percent-encoded for tracks sharing a directory.
+//
+// Mapping is thread-safe and lookups of cached directories never block, but rules (and the localhost prefix) must not be
+// changed while paths are being mapped.
 @interface PathMapper : NSObject
 
+extern NSErrorDomain const __MLE_ErrorDomain_PathMapper;
+
+typedef NS_ENUM(NSUInteger, PathMapperErrorCode) {
+  PathMapperErrorRulesUnreadable = 0,
+  PathMapperErrorInvalidRule,
+};
+
 @property (copy,nullable) NSString* searchString;
 @property (copy,nullable) NSString* replaceString;
 
 @property BOOL addLocalhostPrefix;
 
 - (instancetype)init;
+
+- (NSUInteger)ruleCount;
+
+// Describes the loaded rules, e.g. for detecting a changed configuration
+- (NSString*)rulesSignature;
+
+- (void)addRuleWithPrefix:(NSString*)prefix replacement:(NSString*)replacement;
+
+// Reads one rule per line, formatted as `<prefix> => <replacement>`. Blank lines and lines starting with # are ignored.
+// No rules are added if any line is invalid.
+- (BOOL)addRulesFromURL:(NSURL*)url error:(NSError**)error;
+
 - (NSString*)mapPath:(NSURL*)path;
+- (NSString*)mapFilePath:(NSString*)path;
 
 @end
 
@@ -8,14 +8,179 @@
 #import "PathMapper.h"
 
 #import <OSLog/OSLog.h>
+#import <stdatomic.h>
 
-@implementation PathMapper
+#import "Logger.h"
+
+typedef struct {
+  uint32_t firstEdge;
+  uint32_t edgeCount;
+  // index of the rule whose prefix ends at this node, -1 if none does
+  int32_t rule;
+} PathMapperTrieNode;
+
+typedef struct {
+  uint8_t byte;
+  uint32_t node;
+} PathMapperTrieEdge;
+
+// "file://localhost" + a leading slash
+static NSUInteger const __MLE_PathMapperMaxURLPrefixLength = 17;
+
+// slots in the directory URL cache (a power of 2), directories beyond its capacity are mapped in full every time
+static NSUInteger const __MLE_PathMapperDirectoryCacheSize = 16384;
+static NSUInteger const __MLE_PathMapperDirectoryCacheMaxProbes = 8;
+
+// immutable once published to the cache, only freed when the cache is cleared
+typedef struct {
+  uint64_t hash;
+  NSUInteger directoryLength;
+  NSUInteger urlPrefixLength;
+  // directory bytes followed by the URL prefix bytes
+  uint8_t bytes[];
+} PathMapperCachedDirectory;
+
+// same set as URLPathAllowedCharacterSet, which is what NSURL leaves unescaped in file URLs.
+// unlike RFC 3986 path characters, ';' is not included and is written as %3B
+static inline BOOL PathMapperIsURLPathByte(uint8_t byte) {
+
+  if ((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || (byte >= '0' && byte <= '9')) {
+    return YES;
+  }
+
+  switch (byte) {
+    case '-': case '.': case '_': case '~':
+    case '!': case '$': case '&': case '\'': case '(': case ')': case '*': case '+': case ',': case '=':
+    case ':': case '@': case '/': {
+      return YES;
+    }
+    default: {
+      return NO;
+    }
+  }
+}
+
+static inline NSUInteger PathMapperAppendPercentEncoded(uint8_t* buffer, NSUInteger offset, const uint8_t* bytes, NSUInteger length) {
+
+  static const char hexDigits[] = "0123456789ABCDEF";
+
+  for (NSUInteger index = 0; index < length; index++) {
+    uint8_t byte = bytes[index];
+    if (PathMapperIsURLPathByte(byte)) {
+      buffer[offset++] = byte;
+    }
+    else {
+      buffer[offset++] = '%';
+      buffer[offset++] = hexDigits[byte >> 4];
+      buffer[offset++] = hexDigits[byte & 0x0F];
+    }
+  }
+
+  return offset;
+}
+
+// FNV-1a, every byte of the directory contributes since paths often differ only near the end
+static inline uint64_t PathMapperHashBytes(const uint8_t* bytes, NSUInteger length) {
+
+  uint64_t hash = 0xCBF29CE484222325ULL;
+
+  for (NSUInteger index = 0; index < length; index++) {
+    hash ^= bytes[index];
+    hash *= 0x100000001B3ULL;
+  }
+
+  return hash;
+}
+
+static inline BOOL PathMapperIsASCII(const uint8_t* bytes, NSUInteger length) {
+
+  for (NSUInteger index = 0; index < length; index++) {
+    if (bytes[index] >= 0x80) {
+      return NO;
+    }
+  }
+
+  return YES;
+}
+
+// Matches end at a path component boundary, which normalization never moves, so the end of a match in the normalized
+// path is found in the original path by counting slashes.
+static NSUInteger PathMapperOriginalMatchLength(const uint8_t* normalizedBytes, NSUInteger normalizedLength, NSUInteger normalizedMatchLength,
+                                                const uint8_t* bytes, NSUInteger length) {
+
+  if (normalizedMatchLength >= normalizedLength) {
+    return length;
+  }
+
+  NSUInteger slashCount = 0;
+  for (NSUInteger index = 0; index < normalizedMatchLength; index++) {
+    if (normalizedBytes[index] == '/') {
+      slashCount++;
+    }
+  }
+
+  // otherwise the match ends just before the next slash
+  BOOL endsAfterSlash = normalizedMatchLength > 0 && normalizedBytes[normalizedMatchLength - 1] == '/';
+  if (!endsAfterSlash) {
+    slashCount++;
+  }
+
+  NSUInteger seenSlashCount = 0;
+  for (NSUInteger index = 0; index < length; index++) {
+    if (bytes[index] == '/' && ++seenSlashCount == slashCount) {
+      return endsAfterSlash ? (index + 1) : index;
+    }
+  }
+
+  return length;
+}
+
+
+@implementation PathMapper {
+
+  // prefixes are stored decomposed (NFD) so that rules match paths regardless of how accents were typed
+  NSMutableArray<NSData*>* _rulePrefixes;
+  NSMutableArray<NSData*>* _ruleReplacements;
+
+  // the loaded rules followed by the search/replace pair when it is an absolute prefix, indexed by the trie
+  NSArray<NSData*>* _compiledPrefixes;
+  NSArray<NSData*>* _compiledReplacements;
+  BOOL _searchStringIsRule;
+  BOOL _hasNonASCIIPrefix;
+
+  // node 0 is the root, the edges of each node are contiguous and sorted by byte
+  NSMutableData* _trieNodes;
+  NSMutableData* _trieEdges;
+
+  // open-addressed by directory hash, entries are inserted with a compare-and-swap so lookups never block
+  _Atomic(PathMapperCachedDirectory*)* _cachedDirectories;
+}
+
+@synthesize searchString = _searchString;
+@synthesize replaceString = _replaceString;
+@synthesize addLocalhostPrefix = _addLocalhostPrefix;
+
+NSErrorDomain const __MLE_ErrorDomain_PathMapper = @"com.kylekingcdn.MusicLibraryExporter.PathMapperErrorDomain";
 
 - (instancetype)init {
 
   if (self = [super init]) {
 
     _addLocalhostPrefix = NO;
+
+    _rulePrefixes = [NSMutableArray array];
+    _ruleReplacements = [NSMutableArray array];
+
+    _compiledPrefixes = [NSArray array];
+    _compiledReplacements = [NSArray array];
+    _searchStringIsRule = NO;
+    _hasNonASCIIPrefix = NO;
+
+    _trieNodes = [NSMutableData data];
+    _trieEdges = [NSMutableData data];
+
+    _cachedDirectories = calloc(__MLE_PathMapperDirectoryCacheSize, sizeof(*_cachedDirectories));
+
     return self;
   }
   else {
@@ -23,32 +188,304 @@
   }
 }
 
-- (NSString*)processPath:(NSString*)path {
-  if (path == nil) {
-    os_log_fault(OS_LOG_DEFAULT, "[PathMapper processPath] was erroneously provided a null file path!");
-    return nil;
+- (void)dealloc {
+
+  [self removeCachedURLPrefixes];
+  free(_cachedDirectories);
+}
+
+- (nullable NSString*)searchString {
+
+  return _searchString;
+}
+
+- (void)setSearchString:(nullable NSString*)searchString {
+
+  _searchString = [searchString copy];
+
+  [self compileRules];
+}
+
+- (nullable NSString*)replaceString {
+
+  return _replaceString;
+}
+
+- (void)setReplaceString:(nullable NSString*)replaceString {
+
+  _replaceString = [replaceString copy];
+
+  [self compileRules];
+}
+
+- (BOOL)addLocalhostPrefix {
+
+  return _addLocalhostPrefix;
+}
+
+- (void)setAddLocalhostPrefix:(BOOL)addLocalhostPrefix {
+
+  _addLocalhostPrefix = addLocalhostPrefix;
+
+  [self removeCachedURLPrefixes];
+}
+
+- (NSUInteger)ruleCount {
+
+  return _rulePrefixes.count;
+}
+
+- (NSString*)rulesSignature {
+
+  NSMutableString* signature = [NSMutableString string];
+
+  for (NSUInteger rule = 0; rule < _rulePrefixes.count; rule++) {
+    [signature appendFormat:@"%@=>%@\n",
+     [[NSString alloc] initWithData:_rulePrefixes[rule] encoding:NSUTF8StringEncoding],
+     [[NSString alloc] initWithData:_ruleReplacements[rule] encoding:NSUTF8StringEncoding]];
   }
-  
-  if (_searchString != nil && _replaceString != nil) {
-    return [path stringByReplacingOccurrencesOfString:_searchString withString:_replaceString];
+
+  return signature;
+}
+
+- (void)addRuleWithPrefix:(NSString*)prefix replacement:(NSString*)replacement {
+
+  NSAssert(prefix.length > 0, @"PathMapper rule prefix cannot be empty");
+
+  [_rulePrefixes addObject:[prefix.decomposedStringWithCanonicalMapping dataUsingEncoding:NSUTF8StringEncoding]];
+  [_ruleReplacements addObject:[replacement dataUsingEncoding:NSUTF8StringEncoding]];
+
+  [self compileRules];
+}
+
+- (BOOL)addRulesFromURL:(NSURL*)url error:(NSError**)error {
+
+  NSError* readError;
+  NSString* contents = [NSString stringWithContentsOfURL:url encoding:NSUTF8StringEncoding error:&readError];
+
+  if (contents == nil) {
+    MLE_Log_Info(@"PathMapper [addRulesFromURL] unable to read rules: %@", readError.localizedDescription);
+    if (error) {
+      NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+      [userInfo setObject:[NSString stringWithFormat:@"Unable to read path mapping rules: %@", url.path] forKey:NSLocalizedDescriptionKey];
+      if (readError != nil) {
+        [userInfo setObject:readError forKey:NSUnderlyingErrorKey];
+      }
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_PathMapper code:PathMapperErrorRulesUnreadable userInfo:userInfo];
+    }
+    return NO;
   }
-  else {
-    return path;
+
+  NSMutableArray<NSData*>* prefixes = [NSMutableArray array];
+  NSMutableArray<NSData*>* replacements = [NSMutableArray array];
+
+  NSCharacterSet* whitespace = [NSCharacterSet whitespaceCharacterSet];
+  NSArray<NSString*>* lines = [contents componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]];
+
+  for (NSUInteger lineIndex = 0; lineIndex < lines.count; lineIndex++) {
+
+    NSString* line = [lines[lineIndex] stringByTrimmingCharactersInSet:whitespace];
+    if (line.length == 0 || [line hasPrefix:@"#"]) {
+      continue;
+    }
+
+    NSRange separatorRange = [line rangeOfString:@"=>"];
+    NSString* prefix = separatorRange.location != NSNotFound ? [[line substringToIndex:separatorRange.location] stringByTrimmingCharactersInSet:whitespace] : nil;
+
+    if (prefix.length == 0) {
+      MLE_Log_Info(@"PathMapper [addRulesFromURL] invalid rule on line %lu: %@", lineIndex + 1, line);
+      if (error) {
+        *error = [NSError errorWithDomain:__MLE_ErrorDomain_PathMapper code:PathMapperErrorInvalidRule userInfo:@{
+          NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Invalid path mapping rule on line %lu: %@", lineIndex + 1, line],
+          NSLocalizedRecoverySuggestionErrorKey:@"Rules must be formatted as: <prefix> => <replacement>",
+        }];
+      }
+      return NO;
+    }
+
+    NSString* replacement = [[line substringFromIndex:NSMaxRange(separatorRange)] stringByTrimmingCharactersInSet:whitespace];
+
+    [prefixes addObject:[prefix.decomposedStringWithCanonicalMapping dataUsingEncoding:NSUTF8StringEncoding]];
+    [replacements addObject:[replacement dataUsingEncoding:NSUTF8StringEncoding]];
   }
+
+  [_rulePrefixes addObjectsFromArray:prefixes];
+  [_ruleReplacements addObjectsFromArray:replacements];
+
+  [self compileRules];
+
+  MLE_Log_Info(@"PathMapper [addRulesFromURL] loaded %lu rules from: %@", prefixes.count, url.path);
+
+  return YES;
 }
 
-- (NSURL*)mapURLFromPath:(NSString*)path {
-  if (path == nil) {
-    os_log_fault(OS_LOG_DEFAULT, "[PathMapper mapURLFromPath] was erroneously provided a null file path!");
-    return nil;
+- (void)compileRules {
+
+  [self removeCachedURLPrefixes];
+
+  [_trieNodes setLength:0];
+  [_trieEdges setLength:0];
+
+  NSMutableArray<NSData*>* compiledPrefixes = [NSMutableArray arrayWithArray:_rulePrefixes];
+  NSMutableArray<NSData*>* compiledReplacements = [NSMutableArray arrayWithArray:_ruleReplacements];
+
+  // an absolute search string can only match at the start of a path, so it is matched along with the rules.
+  // it is added last so that it takes precedence over a rule with the same prefix, as it did when it was applied first
+  _searchStringIsRule = (_searchString.length > 0 && _replaceString != nil && [_searchString hasPrefix:@"/"]);
+  if (_searchStringIsRule) {
+    [compiledPrefixes addObject:[_searchString.decomposedStringWithCanonicalMapping dataUsingEncoding:NSUTF8StringEncoding]];
+    [compiledReplacements addObject:[_replaceString dataUsingEncoding:NSUTF8StringEncoding]];
+  }
+
+  _compiledPrefixes = compiledPrefixes;
+  _compiledReplacements = compiledReplacements;
+
+  _hasNonASCIIPrefix = NO;
+  for (NSData* prefix in compiledPrefixes) {
+    if (!PathMapperIsASCII(prefix.bytes, prefix.length)) {
+      _hasNonASCIIPrefix = YES;
+      break;
+    }
+  }
+
+  if (compiledPrefixes.count == 0) {
+    return;
+  }
+
+  // sorting groups rules by their next byte at every depth, equal prefixes stay in the order they were added
+  NSMutableArray<NSNumber*>* sortedRules = [NSMutableArray arrayWithCapacity:compiledPrefixes.count];
+  for (NSUInteger rule = 0; rule < compiledPrefixes.count; rule++) {
+    [sortedRules addObject:@(rule)];
+  }
+
+  NSArray<NSData*>* prefixes = compiledPrefixes;
+  [sortedRules sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSNumber* rule1, NSNumber* rule2) {
+    NSData* prefix1 = prefixes[rule1.unsignedIntegerValue];
+    NSData* prefix2 = prefixes[rule2.unsignedIntegerValue];
+    int result = memcmp(prefix1.bytes, prefix2.bytes, MIN(prefix1.length, prefix2.length));
+    if (result == 0) {
+      return prefix1.length < prefix2.length ? NSOrderedAscending : (prefix1.length > prefix2.length ? NSOrderedDescending : NSOrderedSame);
+    }
+    return result < 0 ? NSOrderedAscending : NSOrderedDescending;
+  }];
+
+  [self addTrieNodeForRules:sortedRules inRange:NSMakeRange(0, sortedRules.count) atDepth:0];
+}
+
+- (uint32_t)addTrieNodeForRules:(NSArray<NSNumber*>*)sortedRules inRange:(NSRange)range atDepth:(NSUInteger)depth {
+
+  PathMapperTrieNode node = { 0, 0, -1 };
+
+  NSUInteger start = range.location;
+  NSUInteger end = NSMaxRange(range);
+
+  // prefixes that end here sort first, when the same prefix was added more than once the last rule wins
+  while (start < end && _compiledPrefixes[sortedRules[start].unsignedIntegerValue].length == depth) {
+    node.rule = sortedRules[start].intValue;
+    start++;
+  }
+
+  // the remaining rules are grouped by their byte at this depth
+  NSUInteger edgeCount = 0;
+  int lastByte = -1;
+  for (NSUInteger index = start; index < end; index++) {
+    int byte = ((const uint8_t*)_compiledPrefixes[sortedRules[index].unsignedIntegerValue].bytes)[depth];
+    if (byte != lastByte) {
+      edgeCount++;
+      lastByte = byte;
+    }
   }
 
-  NSString* mappedPath = [self processPath:path];
-  os_log_debug(OS_LOG_DEFAULT, "Mapped item path from: '%{public}@' to '%{public}@'", path, mappedPath);
+  // edges are reserved before descending so that they stay contiguous
+  uint32_t nodeIndex = (uint32_t)(_trieNodes.length / sizeof(PathMapperTrieNode));
+  node.firstEdge = (uint32_t)(_trieEdges.length / sizeof(PathMapperTrieEdge));
+  node.edgeCount = (uint32_t)edgeCount;
 
-  NSURL* mappedUrl = [NSURL fileURLWithPath:mappedPath relativeToURL:[NSURL fileURLWithPath:@"/"]];
+  [_trieNodes appendBytes:&node length:sizeof(node)];
+  [_trieEdges increaseLengthBy:(edgeCount * sizeof(PathMapperTrieEdge))];
+
+  NSUInteger edge = node.firstEdge;
+  NSUInteger groupStart = start;
+  while (groupStart < end) {
+
+    uint8_t byte = ((const uint8_t*)_compiledPrefixes[sortedRules[groupStart].unsignedIntegerValue].bytes)[depth];
+
+    NSUInteger groupEnd = groupStart + 1;
+    while (groupEnd < end && ((const uint8_t*)_compiledPrefixes[sortedRules[groupEnd].unsignedIntegerValue].bytes)[depth] == byte) {
+      groupEnd++;
+    }
+
+    uint32_t childIndex = [self addTrieNodeForRules:sortedRules inRange:NSMakeRange(groupStart, groupEnd - groupStart) atDepth:(depth + 1)];
+
+    // storage may have moved while adding the child
+    PathMapperTrieEdge* edges = _trieEdges.mutableBytes;
+    edges[edge].byte = byte;
+    edges[edge].node = childIndex;
+
+    edge++;
+    groupStart = groupEnd;
+  }
 
-  return mappedUrl;
+  return nodeIndex;
+}
+
+// Returns the rule with the longest prefix matching the start of the path, or -1 if none match.
+// Non-ASCII paths are matched in the same normalization form as the rule prefixes, matchLength is always in path bytes.
+- (int32_t)matchRuleForPath:(NSString*)path bytes:(const uint8_t*)pathBytes length:(NSUInteger)pathLength matchLength:(NSUInteger*)matchLength {
+
+  if (!_hasNonASCIIPrefix || PathMapperIsASCII(pathBytes, pathLength)) {
+    return [self matchRuleForBytes:pathBytes length:pathLength matchLength:matchLength];
+  }
+
+  NSData* normalizedPath = [path.decomposedStringWithCanonicalMapping dataUsingEncoding:NSUTF8StringEncoding];
+
+  NSUInteger normalizedMatchLength = 0;
+  int32_t rule = [self matchRuleForBytes:normalizedPath.bytes length:normalizedPath.length matchLength:&normalizedMatchLength];
+
+  *matchLength = (rule >= 0) ? PathMapperOriginalMatchLength(normalizedPath.bytes, normalizedPath.length, normalizedMatchLength, pathBytes, pathLength) : 0;
+
+  return rule;
+}
+
+// Returns the rule with the longest prefix matching whole path components at the start of bytes, or -1 if none match.
+// A prefix ending in a slash matches any path below it, otherwise the path must end or continue with a slash after it.
+- (int32_t)matchRuleForBytes:(const uint8_t*)bytes length:(NSUInteger)length matchLength:(NSUInteger*)matchLength {
+
+  *matchLength = 0;
+
+  if (_trieNodes.length == 0) {
+    return -1;
+  }
+
+  const PathMapperTrieNode* nodes = _trieNodes.bytes;
+  const PathMapperTrieEdge* edges = _trieEdges.bytes;
+
+  int32_t rule = -1;
+  const PathMapperTrieNode* node = &nodes[0];
+
+  for (NSUInteger index = 0; index < length && node->edgeCount > 0; index++) {
+
+    const PathMapperTrieNode* nextNode = NULL;
+    for (uint32_t edge = node->firstEdge; edge < node->firstEdge + node->edgeCount; edge++) {
+      if (edges[edge].byte == bytes[index]) {
+        nextNode = &nodes[edges[edge].node];
+        break;
+      }
+    }
+
+    if (nextNode == NULL) {
+      break;
+    }
+
+    node = nextNode;
+    BOOL atComponentBoundary = (bytes[index] == '/' || index + 1 == length || bytes[index + 1] == '/');
+    if (node->rule >= 0 && atComponentBoundary) {
+      rule = node->rule;
+      *matchLength = index + 1;
+    }
+  }
+
+  return rule;
 }
 
 - (NSString*)mapPath:(NSURL*)pathURL {
@@ -59,18 +496,189 @@
 
   os_log_debug(OS_LOG_DEFAULT, "Mapping item path from URL: '%{public}@'", pathURL);
 
-  NSURL* mappedURL = [self mapURLFromPath:pathURL.path];
-  NSString* mappedString = [mappedURL absoluteString];
+  return [self mapFilePath:pathURL.path];
+}
 
-  if (_addLocalhostPrefix) {
-    mappedString = [mappedString stringByReplacingOccurrencesOfString:@"file:///" withString:@"file://localhost/"];
-    os_log_debug(OS_LOG_DEFAULT, "Injected localhost prefix into path: %{public}@", pathURL);
+- (NSString*)mapFilePath:(NSString*)path {
+  if (path == nil) {
+    os_log_fault(OS_LOG_DEFAULT, "[PathMapper mapFilePath] was erroneously provided a null file path!");
+    return nil;
+  }
+
+  // a relative search string can occur anywhere in the path, a new string is only built when it does
+  NSString* searchedPath = path;
+  if (!_searchStringIsRule && _searchString.length > 0 && _replaceString != nil && [path rangeOfString:_searchString].location != NSNotFound) {
+    searchedPath = [path stringByReplacingOccurrencesOfString:_searchString withString:_replaceString];
+  }
+
+  // most paths fit in the stack buffers, longer ones are allocated
+  uint8_t stackPathBytes[1024];
+  uint8_t stackURLBytes[2048];
+  uint8_t* heapPathBytes = NULL;
+  uint8_t* heapURLBytes = NULL;
+
+  const uint8_t* pathBytes = (const uint8_t*)CFStringGetCStringPtr((__bridge CFStringRef)searchedPath, kCFStringEncodingUTF8);
+  NSUInteger pathLength = 0;
+
+  if (pathBytes != NULL) {
+    // only available when the backing store is ASCII, so there is one byte per character
+    pathLength = CFStringGetLength((__bridge CFStringRef)searchedPath);
   }
   else {
-    os_log_debug(OS_LOG_DEFAULT, "Mapped path from '%{public}@' to '%{public}@'", pathURL, mappedString);
+    NSUInteger maxPathLength = [searchedPath maximumLengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    uint8_t* pathBuffer = stackPathBytes;
+    if (maxPathLength > sizeof(stackPathBytes)) {
+      heapPathBytes = malloc(maxPathLength);
+      pathBuffer = heapPathBytes;
+    }
+    [searchedPath getBytes:pathBuffer maxLength:maxPathLength usedLength:&pathLength
+                  encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, searchedPath.length) remainingRange:NULL];
+    pathBytes = pathBuffer;
+  }
+
+  NSUInteger matchLength = 0;
+  int32_t rule = [self matchRuleForPath:searchedPath bytes:pathBytes length:pathLength matchLength:&matchLength];
+
+  // the parent directory (including its trailing slash) determines the URL prefix unless the rule extends past it
+  NSUInteger directoryLength = pathLength;
+  while (directoryLength > 0 && pathBytes[directoryLength - 1] != '/') {
+    directoryLength--;
   }
 
+  const PathMapperCachedDirectory* cachedDirectory = NULL;
+  if (directoryLength > 0 && matchLength <= directoryLength) {
+    cachedDirectory = [self cachedDirectoryForBytes:pathBytes length:directoryLength rule:rule matchLength:matchLength];
+  }
+
+  NSString* mappedString;
+
+  if (cachedDirectory != NULL) {
+
+    // only the filename is encoded per track
+    NSUInteger filenameLength = pathLength - directoryLength;
+    NSUInteger maxURLLength = cachedDirectory->urlPrefixLength + (3 * filenameLength);
+    uint8_t* urlBytes = stackURLBytes;
+    if (maxURLLength > sizeof(stackURLBytes)) {
+      heapURLBytes = malloc(maxURLLength);
+      urlBytes = heapURLBytes;
+    }
+
+    memcpy(urlBytes, cachedDirectory->bytes + cachedDirectory->directoryLength, cachedDirectory->urlPrefixLength);
+    NSUInteger urlLength = PathMapperAppendPercentEncoded(urlBytes, cachedDirectory->urlPrefixLength, pathBytes + directoryLength, filenameLength);
+
+    mappedString = [[NSString alloc] initWithBytes:urlBytes length:urlLength encoding:NSASCIIStringEncoding];
+  }
+  else {
+
+    NSUInteger maxURLLength = [self maxURLLengthForPathLength:pathLength rule:rule matchLength:matchLength];
+    uint8_t* urlBytes = stackURLBytes;
+    if (maxURLLength > sizeof(stackURLBytes)) {
+      heapURLBytes = malloc(maxURLLength);
+      urlBytes = heapURLBytes;
+    }
+
+    NSUInteger urlLength = [self writeURLForPathBytes:pathBytes length:pathLength rule:rule matchLength:matchLength toBuffer:urlBytes];
+
+    mappedString = [[NSString alloc] initWithBytes:urlBytes length:urlLength encoding:NSASCIIStringEncoding];
+  }
+
+  free(heapPathBytes);
+  free(heapURLBytes);
+
+  os_log_debug(OS_LOG_DEFAULT, "Mapped path from '%{public}@' to '%{public}@'", path, mappedString);
+
   return mappedString;
 }
 
+- (NSUInteger)maxURLLengthForPathLength:(NSUInteger)pathLength rule:(int32_t)rule matchLength:(NSUInteger)matchLength {
+
+  NSUInteger replacementLength = rule >= 0 ? _compiledReplacements[rule].length : 0;
+
+  // every byte expands to at most 3 when percent encoded
+  return __MLE_PathMapperMaxURLPrefixLength + (3 * (replacementLength + pathLength - matchLength));
+}
+
+// Writes the file URL for the given path bytes, buffer must hold at least maxURLLengthForPathLength bytes
+- (NSUInteger)writeURLForPathBytes:(const uint8_t*)pathBytes length:(NSUInteger)pathLength rule:(int32_t)rule matchLength:(NSUInteger)matchLength toBuffer:(uint8_t*)urlBytes {
+
+  const uint8_t* replacementBytes = NULL;
+  NSUInteger replacementLength = 0;
+  if (rule >= 0) {
+    NSData* replacement = _compiledReplacements[rule];
+    replacementBytes = replacement.bytes;
+    replacementLength = replacement.length;
+  }
+
+  NSUInteger urlLength = 0;
+  memcpy(urlBytes, "file://", 7);
+  urlLength += 7;
+  if (_addLocalhostPrefix) {
+    memcpy(urlBytes + urlLength, "localhost", 9);
+    urlLength += 9;
+  }
+
+  // relative paths are resolved against the root directory
+  uint8_t firstByte = replacementLength > 0 ? replacementBytes[0] : (matchLength < pathLength ? pathBytes[matchLength] : 0);
+  if (firstByte != '/') {
+    urlBytes[urlLength++] = '/';
+  }
+
+  urlLength = PathMapperAppendPercentEncoded(urlBytes, urlLength, replacementBytes, replacementLength);
+  urlLength = PathMapperAppendPercentEncoded(urlBytes, urlLength, pathBytes + matchLength, pathLength - matchLength);
+
+  return urlLength;
+}
+
+// Returns the cached URL prefix of the given directory. NULL when the slots around the directory's hash are taken by
+// other directories, the caller maps the full path instead.
+- (const PathMapperCachedDirectory*)cachedDirectoryForBytes:(const uint8_t*)directoryBytes length:(NSUInteger)directoryLength rule:(int32_t)rule matchLength:(NSUInteger)matchLength {
+
+  uint64_t hash = PathMapperHashBytes(directoryBytes, directoryLength);
+
+  PathMapperCachedDirectory* insertedEntry = NULL;
+  const PathMapperCachedDirectory* cachedEntry = NULL;
+
+  for (NSUInteger probe = 0; probe < __MLE_PathMapperDirectoryCacheMaxProbes; probe++) {
+
+    _Atomic(PathMapperCachedDirectory*)* slot = &_cachedDirectories[(hash + probe) & (__MLE_PathMapperDirectoryCacheSize - 1)];
+    PathMapperCachedDirectory* entry = atomic_load_explicit(slot, memory_order_acquire);
+
+    if (entry == NULL) {
+
+      // built once per lookup, it is dropped if other threads claim every free slot first
+      if (insertedEntry == NULL) {
+        NSUInteger maxURLPrefixLength = [self maxURLLengthForPathLength:directoryLength rule:rule matchLength:matchLength];
+        insertedEntry = malloc(sizeof(PathMapperCachedDirectory) + directoryLength + maxURLPrefixLength);
+        insertedEntry->hash = hash;
+        insertedEntry->directoryLength = directoryLength;
+        memcpy(insertedEntry->bytes, directoryBytes, directoryLength);
+        insertedEntry->urlPrefixLength = [self writeURLForPathBytes:directoryBytes length:directoryLength rule:rule matchLength:matchLength
+                                                           toBuffer:(insertedEntry->bytes + directoryLength)];
+      }
+
+      if (atomic_compare_exchange_strong_explicit(slot, &entry, insertedEntry, memory_order_acq_rel, memory_order_acquire)) {
+        return insertedEntry;
+      }
+      // another thread filled the slot first, entry now holds its value
+    }
+
+    if (entry->hash == hash && entry->directoryLength == directoryLength && memcmp(entry->bytes, directoryBytes, directoryLength) == 0) {
+      cachedEntry = entry;
+      break;
+    }
+  }
+
+  free(insertedEntry);
+
+  return cachedEntry;
+}
+
+// Must not be called while paths are being mapped
+- (void)removeCachedURLPrefixes {
+
+  for (NSUInteger slot = 0; slot < __MLE_PathMapperDirectoryCacheSize; slot++) {
+    free(atomic_exchange_explicit(&_cachedDirectories[slot], NULL, memory_order_relaxed));
+  }
+}
+
 @end
@@ -10,12 +10,16 @@
 
 #import "PlaylistSerializerDelegate.h"
 
+@class CollationKeyCache;
 @class ITLibMediaItem;
 @class ITLibPlaylist;
+@class LibrarySnapshot;
 @class MediaEntityRepository;
 @class MediaItemFilterGroup;
 @class OrderedDictionary;
 @class PlaylistFilterGroup;
+@class PlistWriter;
+@class ProgressReporter;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -31,6 +35,12 @@ NS_ASSUME_NONNULL_BEGIN
 @property (weak) NSDictionary* playlistCustomSortProperties;
 @property (weak) NSDictionary* playlistCustomSortOrders;
 
+// Collation keys used when sorting playlists, may be shared with other serializers of the same library
+@property (strong) CollationKeyCache* collationKeyCache;
+
+// Advanced as playlists are streamed to a writer, in place of per-playlist `serializedPlaylists:ofTotal:` delegate calls
+@property (nullable, weak) ProgressReporter* progressReporter;
+
 - (instancetype) init;
 - (instancetype) initWithEntityRepository:(MediaEntityRepository*)entityRepository;
 
@@ -39,6 +49,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSArray<OrderedDictionary*>*)serializePlaylistItems:(NSArray<ITLibMediaItem*>*)items;
 
+- (void)serializePlaylistsOfSnapshot:(LibrarySnapshot*)snapshot toWriter:(PlistWriter*)writer;
+- (OrderedDictionary*)serializePlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot;
+
 + (NSString*)describePlaylistKind:(ITLibPlaylistKind)kind;
 
 @end
@@ -10,17 +10,28 @@
 #import <iTunesLibrary/ITLibMediaItem.h>
 #import <iTunesLibrary/ITLibPlaylist.h>
 
+#import "CollationKeyCache.h"
+#import "LibrarySnapshot.h"
 #import "Logger.h"
 #import "MediaEntityRepository.h"
 #import "MediaItemFilterGroup.h"
 #import "MediaItemSorter.h"
 #import "OrderedDictionary.h"
 #import "PlaylistFilterGroup.h"
+#import "PlistWriter.h"
+#import "ProgressReporter.h"
 #import "Utils.h"
 
 @implementation PlaylistSerializer {
 
   MediaEntityRepository* _entityRepository;
+
+  // snapshot track index -> exported track ID, 0 for tracks excluded by the item filters
+  LibrarySnapshot* _trackIDSnapshot;
+  NSData* _trackIDs;
+
+  // reused by every streamed playlist, so it only ever grows to the size of the largest one
+  NSMutableData* _itemBuffer;
 }
 
 - (instancetype)init {
@@ -37,8 +48,17 @@
     _playlistCustomSortProperties = [NSDictionary dictionary];
     _playlistCustomSortOrders = [NSDictionary dictionary];
 
+    _progressReporter = nil;
+
     _entityRepository = nil;
 
+    _collationKeyCache = [[CollationKeyCache alloc] init];
+
+    _trackIDSnapshot = nil;
+    _trackIDs = nil;
+
+    _itemBuffer = [NSMutableData data];
+
     return self;
   }
   else {
@@ -61,7 +81,7 @@
 
 - (NSArray<OrderedDictionary*>*)serializePlaylists:(NSArray<ITLibPlaylist*>*)playlists {
 
-  NSMutableArray<OrderedDictionary*>* playlistsArray = [NSMutableArray array];
+  NSMutableArray<OrderedDictionary*>* playlistsArray = [NSMutableArray arrayWithCapacity:playlists.count];
 
   NSUInteger serializedPlaylists = 0;
   NSUInteger totalPlaylists = playlists.count;
@@ -121,20 +141,7 @@
     [playlistDict setValue:[NSNumber numberWithBool:YES] forKey:@"Folder"];
   }
 
-  MediaItemSorter* sorter = nil;
-
-  if (_playlistCustomSortProperties != nil && _playlistCustomSortProperties != nil) {
-
-    NSString* sortProperty = [_playlistCustomSortProperties valueForKey:[Utils hexStringForPersistentId:playlist.persistentID]];
-
-    NSString* sortOrderTitle = [_playlistCustomSortOrders valueForKey:[Utils hexStringForPersistentId:playlist.persistentID]];
-    PlaylistSortOrderType sortOrder = [Utils playlistSortOrderForTitle:sortOrderTitle];
-
-    sorter = [[MediaItemSorter alloc] initWithSortProperty:sortProperty andSortOrder:sortOrder];
-  }
-  else {
-    sorter = [[MediaItemSorter alloc] init];
-  }
+  MediaItemSorter* sorter = [self sorterForPlaylistWithPersistentID:playlist.persistentID];
 
   NSArray<ITLibMediaItem*>* sortedItems = [sorter sortItems:playlist.items];
   os_log_info(OS_LOG_DEFAULT, "Starting serialization of %lu child items in playlist: '%{public}@' (kind: %{public}@)", sortedItems.count, playlist.name, [PlaylistSerializer describePlaylistKind:playlist.kind]);
@@ -145,15 +152,15 @@
 
 - (NSArray<OrderedDictionary*>*)serializePlaylistItems:(NSArray<ITLibMediaItem*>*)items {
   
-  NSMutableArray<OrderedDictionary*>* itemsArray = [NSMutableArray array];
+  NSMutableArray<OrderedDictionary*>* itemsArray = [NSMutableArray arrayWithCapacity:items.count];
 
   for (ITLibMediaItem* item in items) {
 
     // ignore excluded media items
     if (_itemFilters == nil || [_itemFilters filtersPassForItem:item]) {
       
-      MutableOrderedDictionary* itemDict = [MutableOrderedDictionary dictionary];
-      [itemDict setValue:[_entityRepository getIDForEntity:item] forKey:@"Track ID"];
+      MutableOrderedDictionary* itemDict = [MutableOrderedDictionary dictionaryWithCapacity:1];
+      [itemDict appendObject:[NSNumber numberWithUnsignedInteger:[_entityRepository getRawIDForEntity:item]] forUniqueKey:@"Track ID"];
 
       [itemsArray addObject:itemDict];
     }
@@ -162,6 +169,217 @@
   return itemsArray;
 }
 
+- (void)serializePlaylistsOfSnapshot:(LibrarySnapshot*)snapshot toWriter:(PlistWriter*)writer {
+
+  NSUInteger totalPlaylists = snapshot.playlistCount;
+
+  // playlist membership is checked against the per-track bitmap
+  if (_itemFilters != nil && ![_itemFilters isCompiledForSnapshot:snapshot]) {
+    [_itemFilters compileForSnapshot:snapshot];
+  }
+
+  BOOL cancellable = (_delegate != nil && [_delegate respondsToSelector:@selector(isSerializationCancelled)]);
+
+  ProgressReporter* progressReporter = _progressReporter;
+  [progressReporter resetWithTotal:totalPlaylists];
+
+  for (NSUInteger playlist = 0; playlist < totalPlaylists; playlist++) {
+
+    if (cancellable && [_delegate isSerializationCancelled]) {
+      os_log_info(OS_LOG_DEFAULT, "Playlist serialization cancelled after %lu of %lu playlists", playlist, totalPlaylists);
+      break;
+    }
+
+    // ignore excluded playlists
+    if (_playlistFilters == nil || [_playlistFilters filtersPassForPlaylist:playlist inSnapshot:snapshot]) {
+
+      // release each playlist dict as soon as it has been written
+      @autoreleasepool {
+        [self writePlaylist:playlist inSnapshot:snapshot toWriter:writer];
+      }
+    }
+    else if (_delegate != nil && [_delegate respondsToSelector:@selector(excludedPlaylistWithPersistentID:)]) {
+      [_delegate excludedPlaylistWithPersistentID:[NSNumber numberWithUnsignedLongLong:[snapshot persistentIDOfPlaylist:playlist]]];
+    }
+
+    [progressReporter advanceBy:1];
+  }
+
+  [progressReporter finish];
+}
+
+- (OrderedDictionary*)serializePlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  MutableOrderedDictionary* playlistDict = [self serializePropertiesOfPlaylist:playlist inSnapshot:snapshot];
+
+  NSData* trackIDData = [self sortedTrackIDsOfPlaylist:playlist inSnapshot:snapshot];
+  const uint32_t* trackIDs = trackIDData.bytes;
+  NSUInteger trackIDCount = trackIDData.length / sizeof(uint32_t);
+
+  NSMutableArray<OrderedDictionary*>* itemsArray = [NSMutableArray arrayWithCapacity:trackIDCount];
+
+  for (NSUInteger itemIndex = 0; itemIndex < trackIDCount; itemIndex++) {
+
+    MutableOrderedDictionary* itemDict = [MutableOrderedDictionary dictionaryWithCapacity:1];
+    [itemDict appendObject:[NSNumber numberWithUnsignedInt:trackIDs[itemIndex]] forUniqueKey:@"Track ID"];
+
+    [itemsArray addObject:itemDict];
+  }
+
+  [playlistDict setObject:itemsArray forKey:@"Playlist Items"];
+
+  return playlistDict;
+}
+
+- (void)writePlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot toWriter:(PlistWriter*)writer {
+
+  MutableOrderedDictionary* playlistDict = [self serializePropertiesOfPlaylist:playlist inSnapshot:snapshot];
+  NSUInteger trackIDCount = [self sortTrackIDsOfPlaylist:playlist inSnapshot:snapshot intoBuffer:_itemBuffer];
+
+  [writer beginDict];
+  [writer writeEntriesOfDictionary:playlistDict];
+
+  // item dicts are written straight from the packed IDs
+  [writer writeKey:@"Playlist Items"];
+  [writer writeDictArrayWithKey:@"Track ID" integerValues:_itemBuffer.bytes count:trackIDCount];
+
+  [writer endDict];
+}
+
+- (MutableOrderedDictionary*)serializePropertiesOfPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  NSString* name = [snapshot nameOfPlaylist:playlist];
+  ITLibPlaylistKind kind = (ITLibPlaylistKind)[snapshot kindOfPlaylist:playlist];
+  ITLibDistinguishedPlaylistKind distinguishedKind = (ITLibDistinguishedPlaylistKind)[snapshot distinguishedKindOfPlaylist:playlist];
+  LibrarySnapshotPlaylistFlags flags = [snapshot flagsOfPlaylist:playlist];
+
+  NSNumber* persistentID = [NSNumber numberWithUnsignedLongLong:[snapshot persistentIDOfPlaylist:playlist]];
+  uint64_t parentID = [snapshot parentIDOfPlaylist:playlist];
+
+  os_log_info(OS_LOG_DEFAULT, "Serializing playlist: '%{public}@' (kind: %{public}@)", name, [PlaylistSerializer describePlaylistKind:kind]);
+
+  MutableOrderedDictionary* playlistDict = [MutableOrderedDictionary dictionary];
+
+  [playlistDict setValue:name forKey:@"Name"];
+  if (flags & LibrarySnapshotPlaylistMaster) {
+    [playlistDict setValue:[NSNumber numberWithBool:YES] forKey:@"Master"];
+    [playlistDict setValue:[NSNumber numberWithBool:NO] forKey:@"Visible"];
+  }
+  [playlistDict setValue:[NSNumber numberWithUnsignedInteger:[_entityRepository getRawIDForPersistentID:persistentID.unsignedLongLongValue]] forKey:@"Playlist ID"];
+  [playlistDict setValue:[Utils hexStringForPersistentId:persistentID] forKey:@"Playlist Persistent ID"];
+
+  if (parentID != 0 && !_flattenFolders) {
+    [playlistDict setValue:[Utils hexStringForPersistentId:[NSNumber numberWithUnsignedLongLong:parentID]] forKey:@"Parent Persistent ID"];
+  }
+  if (distinguishedKind > ITLibDistinguishedPlaylistKindNone) {
+    [playlistDict setValue:[NSNumber numberWithUnsignedInteger:distinguishedKind] forKey:@"Distinguished Kind"];
+    if (distinguishedKind == ITLibDistinguishedPlaylistKindMusic) {
+      [playlistDict setValue:[NSNumber numberWithBool:YES] forKey:@"Music"];
+    }
+  }
+  if (!(flags & LibrarySnapshotPlaylistVisible)) {
+    [playlistDict setValue:[NSNumber numberWithBool:NO] forKey:@"Visible"];
+  }
+  [playlistDict setValue:[NSNumber numberWithBool:YES] forKey:@"All Items"];
+  if (kind == ITLibPlaylistKindFolder) {
+    [playlistDict setValue:[NSNumber numberWithBool:YES] forKey:@"Folder"];
+  }
+
+  return playlistDict;
+}
+
+- (NSData*)sortedTrackIDsOfPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot {
+
+  NSMutableData* trackData = [NSMutableData data];
+  NSUInteger trackIDCount = [self sortTrackIDsOfPlaylist:playlist inSnapshot:snapshot intoBuffer:trackData];
+  [trackData setLength:(trackIDCount * sizeof(uint32_t))];
+
+  return trackData;
+}
+
+// Fills the start of the buffer with the playlist's sorted track IDs and returns how many were written.
+// The buffer is only ever grown so that it can be reused across playlists.
+- (NSUInteger)sortTrackIDsOfPlaylist:(NSUInteger)playlist inSnapshot:(LibrarySnapshot*)snapshot intoBuffer:(NSMutableData*)buffer {
+
+  NSString* name = [snapshot nameOfPlaylist:playlist];
+  ITLibPlaylistKind kind = (ITLibPlaylistKind)[snapshot kindOfPlaylist:playlist];
+  NSNumber* persistentID = [NSNumber numberWithUnsignedLongLong:[snapshot persistentIDOfPlaylist:playlist]];
+
+  // sort a copy of the playlist's track indices
+  NSUInteger itemCount = [snapshot itemCountOfPlaylist:playlist];
+  if (buffer.length < itemCount * sizeof(uint32_t)) {
+    [buffer setLength:(itemCount * sizeof(uint32_t))];
+  }
+  uint32_t* tracks = buffer.mutableBytes;
+  if (itemCount > 0) {
+    memcpy(tracks, [snapshot itemsOfPlaylist:playlist], itemCount * sizeof(uint32_t));
+  }
+
+  MediaItemSorter* sorter = [self sorterForPlaylistWithPersistentID:persistentID];
+  [sorter sortTracks:tracks count:itemCount inSnapshot:snapshot];
+
+  os_log_info(OS_LOG_DEFAULT, "Starting serialization of %lu child items in playlist: '%{public}@' (kind: %{public}@)", itemCount, name, [PlaylistSerializer describePlaylistKind:kind]);
+
+  const uint32_t* trackIDs = [self trackIDsForSnapshot:snapshot];
+
+  // replace track indices with track IDs in place, dropping excluded media items
+  NSUInteger includedCount = 0;
+  for (NSUInteger itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+    uint32_t trackID = trackIDs[tracks[itemIndex]];
+    if (trackID != 0) {
+      tracks[includedCount++] = trackID;
+    }
+  }
+
+  return includedCount;
+}
+
+- (const uint32_t*)trackIDsForSnapshot:(LibrarySnapshot*)snapshot {
+
+  if (_trackIDSnapshot == snapshot) {
+    return _trackIDs.bytes;
+  }
+
+  NSUInteger trackCount = snapshot.trackCount;
+  NSMutableData* trackIDData = [NSMutableData dataWithLength:(trackCount * sizeof(uint32_t))];
+  uint32_t* trackIDs = trackIDData.mutableBytes;
+
+  // resolve each track once, rather than once per playlist membership
+  for (NSUInteger track = 0; track < trackCount; track++) {
+    if (_itemFilters == nil || [_itemFilters filtersPassForTrack:track inSnapshot:snapshot]) {
+      trackIDs[track] = (uint32_t)[_entityRepository getRawIDForPersistentID:[snapshot persistentIDOfTrack:track]];
+    }
+  }
+
+  _trackIDSnapshot = snapshot;
+  _trackIDs = trackIDData;
+
+  return trackIDs;
+}
+
+- (MediaItemSorter*)sorterForPlaylistWithPersistentID:(NSNumber*)persistentID {
+
+  MediaItemSorter* sorter = nil;
+
+  if (_playlistCustomSortProperties != nil && _playlistCustomSortProperties != nil) {
+
+    NSString* sortProperty = [_playlistCustomSortProperties valueForKey:[Utils hexStringForPersistentId:persistentID]];
+
+    NSString* sortOrderTitle = [_playlistCustomSortOrders valueForKey:[Utils hexStringForPersistentId:persistentID]];
+    PlaylistSortOrderType sortOrder = [Utils playlistSortOrderForTitle:sortOrderTitle];
+
+    sorter = [[MediaItemSorter alloc] initWithSortProperty:sortProperty andSortOrder:sortOrder];
+  }
+  else {
+    sorter = [[MediaItemSorter alloc] init];
+  }
+
+  // share collation keys between all playlists in this export
+  [sorter setCollationKeyCache:_collationKeyCache];
+
+  return sorter;
+}
+
 + (nonnull NSString *)describePlaylistKind:(ITLibPlaylistKind)kind { 
   switch (kind) {
     case ITLibPlaylistKindRegular: {
@@ -17,6 +17,10 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)serializedPlaylists:(NSUInteger)serialized ofTotal:(NSUInteger)total;
 
 - (void)excludedPlaylist:(ITLibPlaylist*)playlist;
+- (void)excludedPlaylistWithPersistentID:(NSNumber*)persistentID;
+
+// Polled between playlists, serialization stops early once this returns YES
+- (BOOL)isSerializationCancelled;
 
 @end
 
@@ -0,0 +1,125 @@
+//
+//  PlistWriter.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "TrackRecord.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSUInteger, PlistWriterFormat) {
+  PlistWriterFormatXML = 0,
+  PlistWriterFormatBinary,
+  PlistWriterFormatXMLGzip,
+  PlistWriterFormat_MAX,
+};
+
+// also used as the values of --output_format
+static NSString *_Nonnull const PlistWriterFormatNames[] = {
+  @"xml",
+  @"bplist",
+  @"xml.gz",
+};
+
+// Incrementally emits an XML property list to disk.
+//
+// Output is byte-identical to `OrderedDictionary XMLPlistString`, but values are written through a fixed-size buffer
+// as they are produced rather than being concatenated into a single string first.
+// Strings are escaped, and integers and dates formatted, directly into that buffer without intermediate objects.
+// The document is written to a temporary sibling file and atomically moved into place by `closeWithError:`.
+//
+// Fragment writers keep their output in memory so that portions of the document can be rendered on other threads
+// and then appended to the main writer in order with `writeFragment:`.
+//
+// With `skipIfUnchanged`, a SHA-256 hash of the document is stored in an extended attribute of the output file, and an
+// existing file whose stored hash matches is kept in place (with its modification date) rather than replaced.
+// Output written between beginVolatileOutput and endVolatileOutput is excluded from the hash.
+//
+// With PlistWriterFormatXMLGzip the same document is gzip compressed as the buffer is flushed. Binary property lists
+// are written by the BinaryPlistWriter subclass, use `writerWithURL:format:` to get the writer for a format.
+@interface PlistWriter : NSObject
+
+extern NSErrorDomain const __MLE_ErrorDomain_PlistWriter;
+
+typedef NS_ENUM(NSUInteger, PlistWriterErrorCode) {
+  PlistWriterErrorOpenFailed = 0,
+  PlistWriterErrorWriteFailed,
+  PlistWriterErrorMoveFailed,
+  PlistWriterErrorUnbalanced,
+};
+
+
+#pragma mark - Properties
+
+@property (nullable, readonly) NSURL* outputURL;
+@property (readonly) PlistWriterFormat format;
+
+@property (readonly) unsigned long long bytesWritten;
+@property (readonly) NSUInteger depth;
+
+// Must be set before the writer is opened
+@property BOOL skipIfUnchanged;
+
+// Set by closeWithError: when the existing output file had the same content and was left untouched
+@property (readonly, getter=isUnchanged) BOOL unchanged;
+
+
+#pragma mark - Initializers
+
++ (PlistWriter*)writerWithURL:(NSURL*)url format:(PlistWriterFormat)format;
+
+- (instancetype)initWithURL:(NSURL*)url;
+- (instancetype)initWithURL:(NSURL*)url format:(PlistWriterFormat)format;
+- (instancetype)initFragmentWithDepth:(NSUInteger)depth;
+
+
+#pragma mark - Accessors
+
+// Whether fragmentData and writeFragment: can be used, fragments are always XML
+- (BOOL)supportsFragments;
+
+
+#pragma mark - Mutators
+
+- (BOOL)openWithError:(NSError**)error;
+- (BOOL)closeWithError:(NSError**)error;
+- (void)abort;
+
+// Excludes the output written until the matching endVolatileOutput from the content hash, e.g. a timestamp
+- (void)beginVolatileOutput;
+- (void)endVolatileOutput;
+
+- (void)writeDocumentHeader;
+- (void)writeDocumentFooter;
+
+- (void)beginDict;
+- (void)endDict;
+
+- (void)beginArray;
+- (void)endArray;
+
+- (void)writeKey:(NSString*)key;
+- (void)writeValue:(id)value;
+- (void)writeValue:(id)value forKey:(NSString*)key;
+
+- (void)writeEntriesOfDictionary:(NSDictionary*)dict;
+
+// Writes an array of single-entry dicts (e.g. playlist items), identical to writeValue: with an array of @{ key: @(value) }
+- (void)writeDictArrayWithKey:(NSString*)key integerValues:(const uint32_t*)values count:(NSUInteger)count;
+
+// Writes the present fields of a track record in schema order, identical to writeEntriesOfDictionary: with TrackRecordDictionary
+- (void)writeEntriesOfTrackRecord:(const TrackRecord*)record;
+
+- (NSData*)fragmentData;
+- (void)writeFragment:(NSData*)fragment;
+
+// Adds raw bytes to the output buffer, for subclasses that encode values themselves
+- (void)appendBytes:(const void*)bytes length:(NSUInteger)length;
+
+@end
+
+NS_ASSUME_NONNULL_END
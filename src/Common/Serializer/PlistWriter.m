@@ -0,0 +1,835 @@
+//
+//  PlistWriter.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "PlistWriter.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/xattr.h>
+#import <time.h>
+#import <zlib.h>
+
+#import "BinaryPlistWriter.h"
+#import "Logger.h"
+
+static NSUInteger const __MLE_PlistWriterBufferSize = 64 * 1024;
+
+static const char* const __MLE_PlistWriterContentHashAttribute = "com.kylekingcdn.MusicLibraryExporter.ContentHash";
+
+// replacements for the bytes that need escaping, every other byte is copied as-is
+static const char* const __MLE_PlistWriterEscapes[256] = {
+  ['\0'] = " ",
+  ['&'] = "&amp;",
+  ['<'] = "&lt;",
+  ['>'] = "&gt;",
+};
+
+// Writes the decimal representation of value to buffer (which must hold at least 20 bytes), returning the length
+static inline NSUInteger PlistWriterFormatInteger(int64_t value, char* buffer) {
+
+  char digits[20];
+  char* end = digits + sizeof(digits);
+  char* start = end;
+
+  // negated as unsigned so that INT64_MIN doesn't overflow
+  uint64_t magnitude = value < 0 ? (0 - (uint64_t)value) : (uint64_t)value;
+  do {
+    *--start = (char)('0' + (magnitude % 10));
+    magnitude /= 10;
+  } while (magnitude != 0);
+
+  NSUInteger length = 0;
+  if (value < 0) {
+    buffer[length++] = '-';
+  }
+  memcpy(buffer + length, start, end - start);
+
+  return length + (end - start);
+}
+
+// Writes value as 16 uppercase hex digits, matching Utils hexStringForPersistentId:
+static inline void PlistWriterFormatPersistentID(uint64_t value, char* buffer) {
+
+  static const char hexDigits[] = "0123456789ABCDEF";
+
+  for (NSInteger index = 15; index >= 0; index--) {
+    buffer[index] = hexDigits[value & 0xF];
+    value >>= 4;
+  }
+}
+
+static inline void PlistWriterFormatDigits(unsigned int value, char* buffer, NSUInteger width) {
+
+  for (NSInteger index = width - 1; index >= 0; index--) {
+    buffer[index] = (char)('0' + (value % 10));
+    value /= 10;
+  }
+}
+
+// Writes a date as yyyy-MM-dd'T'HH:mm:ss'Z' in UTC to buffer (which must hold 20 bytes).
+// Returns NO for years outside of 1583-9999, those are left to NSDateFormatter since it switches to the Julian calendar
+// before the Gregorian cutover.
+static BOOL PlistWriterFormatDate(NSTimeInterval timeIntervalSinceReferenceDate, char* buffer) {
+
+  // NSDateFormatter truncates towards the past
+  double seconds = floor(timeIntervalSinceReferenceDate + NSTimeIntervalSince1970);
+  if (!(seconds > -12219292800.0 && seconds < 253402300800.0)) {
+    return NO;
+  }
+
+  time_t time = (time_t)seconds;
+  struct tm components;
+  if (gmtime_r(&time, &components) == NULL) {
+    return NO;
+  }
+
+  unsigned int year = (unsigned int)(components.tm_year + 1900);
+  if (year < 1583 || year > 9999) {
+    return NO;
+  }
+
+  PlistWriterFormatDigits(year, buffer, 4);
+  buffer[4] = '-';
+  PlistWriterFormatDigits(components.tm_mon + 1, buffer + 5, 2);
+  buffer[7] = '-';
+  PlistWriterFormatDigits(components.tm_mday, buffer + 8, 2);
+  buffer[10] = 'T';
+  PlistWriterFormatDigits(components.tm_hour, buffer + 11, 2);
+  buffer[13] = ':';
+  PlistWriterFormatDigits(components.tm_min, buffer + 14, 2);
+  buffer[16] = ':';
+  PlistWriterFormatDigits(components.tm_sec, buffer + 17, 2);
+  buffer[19] = 'Z';
+
+  return YES;
+}
+
+@implementation PlistWriter {
+
+  NSURL* _tempURL;
+  NSOutputStream* _stream;
+
+  NSMutableData* _buffer;
+
+  BOOL _compressOutput;
+  BOOL _deflateActive;
+  z_stream _deflateStream;
+  NSMutableData* _compressedBuffer;
+
+  // UTF-8 conversion space for strings that don't expose their bytes directly
+  NSMutableData* _scratch;
+
+  // only created for dates the fast formatter doesn't handle
+  NSDateFormatter* _dateFormatter;
+
+  // bytes at the start of _buffer that have already been hashed (or skipped as volatile)
+  CC_SHA256_CTX _contentHash;
+  NSUInteger _hashedLength;
+  NSUInteger _volatileDepth;
+
+  NSError* _writeError;
+}
+
+NSErrorDomain const __MLE_ErrorDomain_PlistWriter = @"com.kylekingcdn.MusicLibraryExporter.PlistWriterErrorDomain";
+
+
+#pragma mark - Initializers
+
++ (PlistWriter*)writerWithURL:(NSURL*)url format:(PlistWriterFormat)format {
+
+  if (format == PlistWriterFormatBinary) {
+    return [[BinaryPlistWriter alloc] initWithURL:url];
+  }
+
+  return [[PlistWriter alloc] initWithURL:url format:format];
+}
+
+- (instancetype)initWithURL:(NSURL*)url {
+
+  return [self initWithURL:url format:PlistWriterFormatXML];
+}
+
+- (instancetype)initWithURL:(NSURL*)url format:(PlistWriterFormat)format {
+
+  if (self = [super init]) {
+
+    _outputURL = url;
+    _format = format;
+    _bytesWritten = 0;
+
+    NSString* tempFileName = [NSString stringWithFormat:@".%@.%@.tmp", url.lastPathComponent, [[NSUUID UUID] UUIDString]];
+    _tempURL = [[url URLByDeletingLastPathComponent] URLByAppendingPathComponent:tempFileName];
+    _stream = nil;
+
+    _buffer = [NSMutableData dataWithCapacity:__MLE_PlistWriterBufferSize];
+    _depth = 0;
+
+    _compressOutput = (format == PlistWriterFormatXMLGzip);
+    _deflateActive = NO;
+    _compressedBuffer = _compressOutput ? [NSMutableData dataWithLength:__MLE_PlistWriterBufferSize] : nil;
+
+    _scratch = [NSMutableData data];
+    _dateFormatter = nil;
+
+    _skipIfUnchanged = NO;
+    _unchanged = NO;
+    _hashedLength = 0;
+    _volatileDepth = 0;
+
+    _writeError = nil;
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+- (instancetype)initFragmentWithDepth:(NSUInteger)depth {
+
+  if (self = [super init]) {
+
+    _outputURL = nil;
+    _format = PlistWriterFormatXML;
+    _bytesWritten = 0;
+
+    _tempURL = nil;
+    _stream = nil;
+
+    _buffer = [NSMutableData data];
+    _depth = depth;
+
+    _compressOutput = NO;
+    _deflateActive = NO;
+    _compressedBuffer = nil;
+
+    _scratch = [NSMutableData data];
+    _dateFormatter = nil;
+
+    _skipIfUnchanged = NO;
+    _unchanged = NO;
+    _hashedLength = 0;
+    _volatileDepth = 0;
+
+    _writeError = nil;
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+- (void)dealloc {
+
+  // writer was never closed, don't leave the partial document behind
+  if (_stream != nil) {
+    [self abort];
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (BOOL)supportsFragments {
+
+  return YES;
+}
+
+
+#pragma mark - Mutators
+
+- (BOOL)openWithError:(NSError**)error {
+
+  NSAssert(_stream == nil, @"PlistWriter has already been opened");
+
+  _stream = [NSOutputStream outputStreamWithURL:_tempURL append:NO];
+  [_stream open];
+
+  if (_stream.streamStatus != NSStreamStatusOpen) {
+    MLE_Log_Info(@"PlistWriter [openWithError] unable to open temporary file: %@", _tempURL.path);
+    if (error) {
+      *error = [self generateErrorForCode:PlistWriterErrorOpenFailed underlyingError:_stream.streamError];
+    }
+    _stream = nil;
+    return NO;
+  }
+
+  if (_compressOutput) {
+
+    // windowBits + 16 selects the gzip wrapper instead of zlib's
+    memset(&_deflateStream, 0, sizeof(_deflateStream));
+    if (deflateInit2(&_deflateStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      MLE_Log_Info(@"PlistWriter [openWithError] unable to initialize compression");
+      if (error) {
+        *error = [self generateErrorForCode:PlistWriterErrorOpenFailed underlyingError:nil];
+      }
+      [self abort];
+      return NO;
+    }
+    _deflateActive = YES;
+  }
+
+  _unchanged = NO;
+  if (_skipIfUnchanged) {
+    // switching formats changes the file even when the document doesn't
+    CC_SHA256_Init(&_contentHash);
+    const char* formatName = PlistWriterFormatNames[_format].UTF8String;
+    CC_SHA256_Update(&_contentHash, formatName, (CC_LONG)strlen(formatName));
+  }
+
+  return YES;
+}
+
+- (BOOL)closeWithError:(NSError**)error {
+
+  NSAssert(_stream != nil, @"PlistWriter has not been opened");
+
+  if (self.depth != 0 && _writeError == nil) {
+    _writeError = [self generateErrorForCode:PlistWriterErrorUnbalanced underlyingError:nil];
+  }
+
+  [self flushBuffer];
+  if (_deflateActive) {
+    [self deflateBytes:NULL length:0 finish:YES];
+    deflateEnd(&_deflateStream);
+    _deflateActive = NO;
+  }
+  [_stream close];
+  _stream = nil;
+
+  if (_writeError != nil) {
+    MLE_Log_Info(@"PlistWriter [closeWithError] write failed: %@", _writeError.localizedDescription);
+    [[NSFileManager defaultManager] removeItemAtURL:_tempURL error:nil];
+    if (error) {
+      *error = _writeError;
+    }
+    return NO;
+  }
+
+  if (_skipIfUnchanged) {
+
+    uint8_t contentHash[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(contentHash, &_contentHash);
+
+    uint8_t existingHash[CC_SHA256_DIGEST_LENGTH];
+    ssize_t existingHashLength = getxattr(_outputURL.fileSystemRepresentation, __MLE_PlistWriterContentHashAttribute, existingHash, sizeof(existingHash), 0, 0);
+
+    if (existingHashLength == sizeof(existingHash) && memcmp(existingHash, contentHash, sizeof(contentHash)) == 0) {
+      MLE_Log_Info(@"PlistWriter [closeWithError] content is unchanged, keeping existing file: %@", _outputURL.path);
+      [[NSFileManager defaultManager] removeItemAtURL:_tempURL error:nil];
+      _unchanged = YES;
+      return YES;
+    }
+
+    // without extended attribute support the hash is never found, so the file is always replaced
+    if (setxattr(_tempURL.fileSystemRepresentation, __MLE_PlistWriterContentHashAttribute, contentHash, sizeof(contentHash), 0, 0) != 0) {
+      MLE_Log_Info(@"PlistWriter [closeWithError] unable to store content hash: %s", strerror(errno));
+    }
+  }
+
+  // rename(2) atomically replaces any existing file at the destination
+  if (rename(_tempURL.fileSystemRepresentation, _outputURL.fileSystemRepresentation) != 0) {
+    NSError* renameError = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+    MLE_Log_Info(@"PlistWriter [closeWithError] unable to move temporary file into place: %@", renameError.localizedDescription);
+    [[NSFileManager defaultManager] removeItemAtURL:_tempURL error:nil];
+    if (error) {
+      *error = [self generateErrorForCode:PlistWriterErrorMoveFailed underlyingError:renameError];
+    }
+    return NO;
+  }
+
+  return YES;
+}
+
+- (void)abort {
+
+  if (_deflateActive) {
+    deflateEnd(&_deflateStream);
+    _deflateActive = NO;
+  }
+
+  if (_stream != nil) {
+    [_stream close];
+    _stream = nil;
+  }
+
+  [_buffer setLength:0];
+  _hashedLength = 0;
+  [[NSFileManager defaultManager] removeItemAtURL:_tempURL error:nil];
+}
+
+- (void)beginVolatileOutput {
+
+  [self updateContentHash];
+  _volatileDepth++;
+}
+
+- (void)endVolatileOutput {
+
+  NSAssert(_volatileDepth > 0, @"PlistWriter endVolatileOutput called without matching beginVolatileOutput");
+
+  [self updateContentHash];
+  _volatileDepth--;
+}
+
+- (void)writeDocumentHeader {
+
+  [self appendString:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<!DOCTYPE plist PUBLIC \"-//Apple Computer//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n"
+                      "<plist version=\"1.0\">\n"];
+}
+
+- (void)writeDocumentFooter {
+
+  [self appendString:@"</plist>\n"];
+}
+
+- (void)beginDict {
+
+  [self appendIndent];
+  [self appendString:@"<dict>\n"];
+  _depth++;
+}
+
+- (void)endDict {
+
+  NSAssert(_depth > 0, @"PlistWriter endDict called without matching beginDict");
+
+  _depth--;
+  [self appendIndent];
+  [self appendString:@"</dict>\n"];
+}
+
+- (void)beginArray {
+
+  [self appendIndent];
+  [self appendString:@"<array>\n"];
+  _depth++;
+}
+
+- (void)endArray {
+
+  NSAssert(_depth > 0, @"PlistWriter endArray called without matching beginArray");
+
+  _depth--;
+  [self appendIndent];
+  [self appendString:@"</array>\n"];
+}
+
+- (void)writeKey:(NSString*)key {
+
+  [self appendIndent];
+  [self appendString:@"<key>"];
+  [self appendEscapedString:[key description]];
+  [self appendString:@"</key>\n"];
+}
+
+- (void)writeValue:(id)value {
+
+  if ([value isKindOfClass:[NSDictionary class]]) {
+    [self beginDict];
+    [self writeEntriesOfDictionary:value];
+    [self endDict];
+  }
+  else if ([value isKindOfClass:[NSArray class]]) {
+    [self beginArray];
+    for (id arrayValue in value) {
+      [self writeValue:arrayValue];
+    }
+    [self endArray];
+  }
+  else {
+    [self appendIndent];
+    [self appendScalar:value];
+    [self appendString:@"\n"];
+  }
+}
+
+- (void)writeValue:(id)value forKey:(NSString*)key {
+
+  [self writeKey:key];
+  [self writeValue:value];
+}
+
+- (void)writeEntriesOfDictionary:(NSDictionary*)dict {
+
+  [dict enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL* stop) {
+    [self writeValue:value forKey:key];
+  }];
+}
+
+- (void)writeDictArrayWithKey:(NSString*)key integerValues:(const uint32_t*)values count:(NSUInteger)count {
+
+  [self beginArray];
+
+  if (count > 0) {
+
+    // everything except the value is identical for each entry, so it's only encoded once
+    NSString* dictIndent = [@"" stringByPaddingToLength:_depth withString:@"\t" startingAtIndex:0];
+    NSString* entryIndent = [dictIndent stringByAppendingString:@"\t"];
+
+    NSData* prefix = [[NSString stringWithFormat:@"%@<dict>\n%@<key>%@</key>\n%@<integer>", dictIndent, entryIndent, [PlistWriter escapedString:key], entryIndent]
+                      dataUsingEncoding:NSUTF8StringEncoding];
+    NSData* suffix = [[NSString stringWithFormat:@"</integer>\n%@</dict>\n", dictIndent] dataUsingEncoding:NSUTF8StringEncoding];
+
+    for (NSUInteger index = 0; index < count; index++) {
+
+      char digits[20];
+      NSUInteger digitCount = PlistWriterFormatInteger(values[index], digits);
+
+      [self appendBytes:prefix.bytes length:prefix.length];
+      [self appendBytes:digits length:digitCount];
+      [self appendBytes:suffix.bytes length:suffix.length];
+    }
+  }
+
+  [self endArray];
+}
+
+- (void)writeEntriesOfTrackRecord:(const TrackRecord*)record {
+
+  uint64_t remainingFields = record->presentFields;
+
+  while (remainingFields != 0) {
+
+    TrackRecordField field = (TrackRecordField)__builtin_ctzll(remainingFields);
+    remainingFields &= (remainingFields - 1);
+
+    const TrackRecordFieldSchema* schema = &TrackRecordSchema[field];
+    TrackRecordValue value = record->values[field];
+
+    [self appendIndent];
+    [self appendBytes:"<key>" length:5];
+    if (schema->type == TrackRecordValueTrueForStringKey) {
+      [self appendEscapedString:value.string];
+    }
+    else {
+      [self appendBytes:schema->key length:strlen(schema->key)];
+    }
+    [self appendBytes:"</key>\n" length:7];
+
+    [self appendIndent];
+
+    switch (schema->type) {
+      case TrackRecordValueString: {
+        [self appendBytes:"<string>" length:8];
+        [self appendEscapedString:value.string];
+        [self appendBytes:"</string>\n" length:10];
+        break;
+      }
+      case TrackRecordValueInteger: {
+        char line[40];
+        memcpy(line, "<integer>", 9);
+        NSUInteger length = 9 + PlistWriterFormatInteger(value.integer, line + 9);
+        memcpy(line + length, "</integer>\n", 11);
+        [self appendBytes:line length:length + 11];
+        break;
+      }
+      case TrackRecordValueDate: {
+        [self appendBytes:"<date>" length:6];
+        [self appendDate:value.date];
+        [self appendBytes:"</date>\n" length:8];
+        break;
+      }
+      case TrackRecordValueTrue:
+      case TrackRecordValueTrueForStringKey: {
+        [self appendBytes:"<true/>\n" length:8];
+        break;
+      }
+      case TrackRecordValuePersistentID: {
+        char line[34];
+        memcpy(line, "<string>", 8);
+        PlistWriterFormatPersistentID(value.persistentID, line + 8);
+        memcpy(line + 24, "</string>\n", 10);
+        [self appendBytes:line length:34];
+        break;
+      }
+    }
+  }
+}
+
+- (NSData*)fragmentData {
+
+  NSAssert(_outputURL == nil, @"PlistWriter fragmentData is only available for fragment writers");
+
+  return _buffer;
+}
+
+- (void)writeFragment:(NSData*)fragment {
+
+  [self appendBytes:fragment.bytes length:fragment.length];
+}
+
+
+#pragma mark - Helper functions
+
++ (NSString*)escapedString:(NSString*)string {
+
+  return [[[[string stringByReplacingOccurrencesOfString:@"&" withString:@"&amp;"]
+            stringByReplacingOccurrencesOfString:@"<" withString:@"&lt;"]
+           stringByReplacingOccurrencesOfString:@">" withString:@"&gt;"]
+          stringByReplacingOccurrencesOfString:@"\0" withString:@" "];
+}
+
+- (void)appendScalar:(id)value {
+
+  if ([value isKindOfClass:[NSString class]]) {
+    [self appendString:@"<string>"];
+    [self appendEscapedString:value];
+    [self appendString:@"</string>"];
+  }
+  else if ([value isKindOfClass:[NSNumber class]]) {
+    NSNumber* number = value;
+    if ((__bridge CFBooleanRef)number == kCFBooleanTrue) {
+      [self appendString:@"<true/>"];
+    }
+    else if ((__bridge CFBooleanRef)number == kCFBooleanFalse) {
+      [self appendString:@"<false/>"];
+    }
+    else if (number.doubleValue != (double)number.integerValue) {
+      [self appendString:[NSString stringWithFormat:@"<real>%@</real>", number]];
+    }
+    else if (number.objCType[0] != 'f' && number.objCType[0] != 'd') {
+      char digits[20];
+      [self appendBytes:"<integer>" length:9];
+      [self appendBytes:digits length:PlistWriterFormatInteger(number.longLongValue, digits)];
+      [self appendBytes:"</integer>" length:10];
+    }
+    else {
+      [self appendString:[NSString stringWithFormat:@"<integer>%@</integer>", number]];
+    }
+  }
+  else if ([value isKindOfClass:[NSDate class]]) {
+    [self appendString:@"<date>"];
+    [self appendDate:[value timeIntervalSinceReferenceDate]];
+    [self appendString:@"</date>"];
+  }
+  else if ([value isKindOfClass:[NSData class]]) {
+    NSString* indent = [@"" stringByPaddingToLength:_depth withString:@"\t" startingAtIndex:0];
+    [self appendString:[NSString stringWithFormat:@"<data>\n%@%@\n%@</data>", indent, [value base64EncodedStringWithOptions:0], indent]];
+  }
+  else {
+    NSAssert(NO, @"PlistWriter %@ is not a supported property list type", [value class]);
+  }
+}
+
+- (void)appendIndent {
+
+  static const char tabs[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+
+  NSUInteger remaining = _depth;
+  while (remaining > 0) {
+    NSUInteger count = MIN(remaining, sizeof(tabs) - 1);
+    [self appendBytes:tabs length:count];
+    remaining -= count;
+  }
+}
+
+- (void)appendEscapedString:(NSString*)string {
+
+  CFStringRef cfString = (__bridge CFStringRef)string;
+
+  const char* bytes = CFStringGetCStringPtr(cfString, kCFStringEncodingUTF8);
+  NSUInteger length = 0;
+
+  if (bytes != NULL) {
+    // only available when the backing store is ASCII, so there is one byte per character
+    length = CFStringGetLength(cfString);
+  }
+  else {
+    NSUInteger maxLength = [string maximumLengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    if (_scratch.length < maxLength) {
+      [_scratch setLength:maxLength];
+    }
+
+    NSRange remainingRange = NSMakeRange(0, 0);
+    BOOL converted = [string getBytes:_scratch.mutableBytes maxLength:maxLength usedLength:&length
+                             encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, string.length) remainingRange:&remainingRange];
+
+    // like appendString:, strings that can't be encoded are dropped
+    if (!converted || remainingRange.length != 0) {
+      return;
+    }
+    bytes = _scratch.bytes;
+  }
+
+  // clean runs are copied in bulk, so most strings are a single copy
+  NSUInteger runStart = 0;
+  for (NSUInteger index = 0; index < length; index++) {
+
+    const char* escape = __MLE_PlistWriterEscapes[(uint8_t)bytes[index]];
+    if (escape == NULL) {
+      continue;
+    }
+
+    if (index > runStart) {
+      [self appendBytes:(bytes + runStart) length:(index - runStart)];
+    }
+    [self appendBytes:escape length:strlen(escape)];
+    runStart = index + 1;
+  }
+
+  if (length > runStart) {
+    [self appendBytes:(bytes + runStart) length:(length - runStart)];
+  }
+}
+
+- (void)appendDate:(NSTimeInterval)timeIntervalSinceReferenceDate {
+
+  char formatted[20];
+  if (PlistWriterFormatDate(timeIntervalSinceReferenceDate, formatted)) {
+    [self appendBytes:formatted length:sizeof(formatted)];
+    return;
+  }
+
+  if (_dateFormatter == nil) {
+    _dateFormatter = [[NSDateFormatter alloc] init];
+    _dateFormatter.timeZone = [NSTimeZone timeZoneWithName:@"UTC"];
+    _dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+    _dateFormatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss'Z'";
+  }
+
+  [self appendString:[_dateFormatter stringFromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:timeIntervalSinceReferenceDate]]];
+}
+
+- (void)appendString:(NSString*)string {
+
+  NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+  if (length == 0) {
+    return;
+  }
+
+  NSUInteger offset = _buffer.length;
+  [_buffer increaseLengthBy:length];
+
+  NSUInteger usedLength = 0;
+  [string getBytes:((uint8_t*)_buffer.mutableBytes + offset) maxLength:length usedLength:&usedLength
+          encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, string.length) remainingRange:NULL];
+
+  if (_outputURL != nil && _buffer.length >= __MLE_PlistWriterBufferSize) {
+    [self flushBuffer];
+  }
+}
+
+- (void)appendBytes:(const void*)bytes length:(NSUInteger)length {
+
+  [_buffer appendBytes:bytes length:length];
+
+  if (_outputURL != nil && _buffer.length >= __MLE_PlistWriterBufferSize) {
+    [self flushBuffer];
+  }
+}
+
+- (void)flushBuffer {
+
+  if (_buffer.length == 0) {
+    return;
+  }
+
+  // discard output once a write has failed, the error is reported on close
+  if (_writeError != nil || _stream == nil) {
+    [_buffer setLength:0];
+    _hashedLength = 0;
+    return;
+  }
+
+  [self updateContentHash];
+
+  if (_compressOutput) {
+    [self deflateBytes:_buffer.bytes length:_buffer.length finish:NO];
+  }
+  else {
+    [self writeBytesToStream:_buffer.bytes length:_buffer.length];
+  }
+
+  [_buffer setLength:0];
+  _hashedLength = 0;
+}
+
+// Hashes the buffered output that hasn't been hashed yet, unless it is volatile
+- (void)updateContentHash {
+
+  if (_skipIfUnchanged && _volatileDepth == 0 && _buffer.length > _hashedLength) {
+    CC_SHA256_Update(&_contentHash, (const uint8_t*)_buffer.bytes + _hashedLength, (CC_LONG)(_buffer.length - _hashedLength));
+  }
+
+  _hashedLength = _buffer.length;
+}
+
+- (void)deflateBytes:(nullable const void*)bytes length:(NSUInteger)length finish:(BOOL)finish {
+
+  _deflateStream.next_in = (Bytef*)bytes;
+  _deflateStream.avail_in = (uInt)length;
+
+  int result;
+  do {
+    _deflateStream.next_out = _compressedBuffer.mutableBytes;
+    _deflateStream.avail_out = (uInt)_compressedBuffer.length;
+
+    result = deflate(&_deflateStream, finish ? Z_FINISH : Z_NO_FLUSH);
+    if (result == Z_STREAM_ERROR) {
+      _writeError = [self generateErrorForCode:PlistWriterErrorWriteFailed underlyingError:nil];
+      return;
+    }
+
+    [self writeBytesToStream:_compressedBuffer.bytes length:(_compressedBuffer.length - _deflateStream.avail_out)];
+
+  } while (_writeError == nil && (_deflateStream.avail_out == 0 || (finish && result != Z_STREAM_END)));
+}
+
+- (void)writeBytesToStream:(const void*)bytes length:(NSUInteger)length {
+
+  if (_writeError != nil) {
+    return;
+  }
+
+  const uint8_t* remainingBytes = bytes;
+  NSUInteger remaining = length;
+
+  while (remaining > 0) {
+    NSInteger written = [_stream write:remainingBytes maxLength:remaining];
+    if (written <= 0) {
+      _writeError = [self generateErrorForCode:PlistWriterErrorWriteFailed underlyingError:_stream.streamError];
+      break;
+    }
+    remainingBytes += written;
+    remaining -= written;
+    _bytesWritten += written;
+  }
+}
+
+- (NSError*)generateErrorForCode:(PlistWriterErrorCode)code underlyingError:(nullable NSError*)underlyingError {
+
+  NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+  if (underlyingError != nil) {
+    [userInfo setObject:underlyingError forKey:NSUnderlyingErrorKey];
+  }
+
+  switch (code) {
+    case PlistWriterErrorOpenFailed: {
+      [userInfo setObject:@"Unable to create the output file" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+    case PlistWriterErrorWriteFailed: {
+      [userInfo setObject:@"Unable to write to the output file" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+    case PlistWriterErrorMoveFailed: {
+      [userInfo setObject:@"Unable to save the output file" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+    case PlistWriterErrorUnbalanced: {
+      [userInfo setObject:@"Internal error" forKey:NSLocalizedDescriptionKey];
+      [userInfo setObject:@"The generated library was incomplete." forKey:NSLocalizedRecoverySuggestionErrorKey];
+      break;
+    }
+  }
+
+  return [NSError errorWithDomain:__MLE_ErrorDomain_PlistWriter code:code userInfo:userInfo];
+}
+
+@end
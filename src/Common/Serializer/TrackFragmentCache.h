@@ -0,0 +1,60 @@
+//
+//  TrackFragmentCache.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+@class LibrarySnapshot;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// On-disk cache of serialized track XML, reused between exports for tracks that have not changed.
+//
+// Fragments hold every entry of a track's dict except the leading `Track ID`, which may change between exports.
+// A fragment is only returned when the track's fingerprint (modified date plus volatile fields such as play count,
+// rating and location) and the cache's configuration signature both match the values it was stored with.
+@interface TrackFragmentCache : NSObject
+
+extern NSErrorDomain const __MLE_ErrorDomain_TrackFragmentCache;
+
+typedef NS_ENUM(NSUInteger, TrackFragmentCacheErrorCode) {
+  TrackFragmentCacheErrorReadFailed = 0,
+  TrackFragmentCacheErrorInvalidFormat,
+  TrackFragmentCacheErrorWriteFailed,
+};
+
+
+#pragma mark - Properties
+
+@property (readonly) NSURL* cacheURL;
+@property (readonly, copy) NSString* configurationSignature;
+
+@property (readonly) NSUInteger hitCount;
+@property (readonly) NSUInteger missCount;
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithURL:(NSURL*)url andConfigurationSignature:(NSString*)signature;
+
+
+#pragma mark - Accessors
+
+// The track's fingerprint is returned even on a miss, so that it can be passed on to `setFragment:` without being
+// computed again
+- (nullable NSData*)fragmentForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot fingerprint:(uint64_t*)fingerprint;
+
+
+#pragma mark - Mutators
+
+- (BOOL)loadWithError:(NSError**)error;
+- (BOOL)saveWithError:(NSError**)error;
+
+- (void)setFragment:(NSData*)fragment withFingerprint:(uint64_t)fingerprint forTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,314 @@
+//
+//  TrackFragmentCache.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "TrackFragmentCache.h"
+
+#import "LibrarySnapshot.h"
+#import "Logger.h"
+
+// bump whenever the serialized track format changes
+static const uint32_t TrackFragmentCacheFormatVersion = 2;
+static const char TrackFragmentCacheMagic[4] = { 'M', 'L', 'E', 'F' };
+
+static const uint64_t TrackFragmentCacheFNVOffset = 0xcbf29ce484222325ULL;
+static const uint64_t TrackFragmentCacheFNVPrime = 0x100000001b3ULL;
+
+@interface TrackFragmentCacheEntry : NSObject
+
+@property uint64_t fingerprint;
+@property NSData* fragment;
+
+@end
+
+@implementation TrackFragmentCacheEntry
+
+@end
+
+@implementation TrackFragmentCache {
+
+  NSMutableDictionary<NSNumber*, TrackFragmentCacheEntry*>* _storedEntries;
+  NSMutableDictionary<NSNumber*, TrackFragmentCacheEntry*>* _currentEntries;
+}
+
+NSErrorDomain const __MLE_ErrorDomain_TrackFragmentCache = @"com.kylekingcdn.MusicLibraryExporter.TrackFragmentCacheErrorDomain";
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithURL:(NSURL*)url andConfigurationSignature:(NSString*)signature {
+
+  if (self = [super init]) {
+
+    _cacheURL = url;
+    _configurationSignature = [signature copy];
+
+    _hitCount = 0;
+    _missCount = 0;
+
+    _storedEntries = [NSMutableDictionary dictionary];
+    _currentEntries = [NSMutableDictionary dictionary];
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (nullable NSData*)fragmentForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot fingerprint:(uint64_t*)fingerprint {
+
+  *fingerprint = [TrackFragmentCache fingerprintForTrack:track inSnapshot:snapshot];
+  NSNumber* persistentID = [NSNumber numberWithUnsignedLongLong:[snapshot persistentIDOfTrack:track]];
+
+  @synchronized (self) {
+
+    TrackFragmentCacheEntry* entry = [_storedEntries objectForKey:persistentID];
+
+    if (entry == nil || entry.fingerprint != *fingerprint) {
+      _missCount++;
+      return nil;
+    }
+
+    _hitCount++;
+
+    // keep the entry for the next export
+    [_currentEntries setObject:entry forKey:persistentID];
+
+    return entry.fragment;
+  }
+}
+
++ (uint64_t)fingerprintForTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot {
+
+  // nil dates are stored as NAN, which has a stable bit pattern
+  double dates[] = {
+    [snapshot timeIntervalForColumn:LibrarySnapshotDateModified ofTrack:track],
+    [snapshot timeIntervalForColumn:LibrarySnapshotDateLastPlayed ofTrack:track],
+    [snapshot timeIntervalForColumn:LibrarySnapshotDateSkipped ofTrack:track],
+  };
+
+  int64_t values[] = {
+    [snapshot integerForColumn:LibrarySnapshotIntegerPlayCount ofTrack:track],
+    [snapshot integerForColumn:LibrarySnapshotIntegerSkipCount ofTrack:track],
+    [snapshot integerForColumn:LibrarySnapshotIntegerRating ofTrack:track],
+    [snapshot integerForColumn:LibrarySnapshotIntegerAlbumRating ofTrack:track],
+    [snapshot integerForColumn:LibrarySnapshotIntegerFileSize ofTrack:track],
+    [snapshot integerForColumn:LibrarySnapshotIntegerMediaKind ofTrack:track],
+    [snapshot flagsOfTrack:track],
+  };
+
+  uint64_t hash = TrackFragmentCacheFNVOffset;
+  hash = [TrackFragmentCache hash:hash bytes:dates length:sizeof(dates)];
+  hash = [TrackFragmentCache hash:hash bytes:values length:sizeof(values)];
+
+  NSString* location = [snapshot stringForColumn:LibrarySnapshotStringLocation ofTrack:track];
+  if (location != nil) {
+    const char* locationBytes = location.UTF8String;
+    hash = [TrackFragmentCache hash:hash bytes:locationBytes length:strlen(locationBytes)];
+  }
+
+  return hash;
+}
+
++ (uint64_t)hash:(uint64_t)hash bytes:(const void*)bytes length:(NSUInteger)length {
+
+  const uint8_t* byteValues = bytes;
+
+  for (NSUInteger index = 0; index < length; index++) {
+    hash ^= byteValues[index];
+    hash *= TrackFragmentCacheFNVPrime;
+  }
+
+  return hash;
+}
+
+
+#pragma mark - Mutators
+
+- (BOOL)loadWithError:(NSError**)error {
+
+  NSError* readError;
+  NSData* cacheData = [NSData dataWithContentsOfURL:_cacheURL options:NSDataReadingMappedIfSafe error:&readError];
+
+  if (cacheData == nil) {
+
+    // a missing cache is expected for the first export
+    if ([readError.domain isEqualToString:NSCocoaErrorDomain] && readError.code == NSFileReadNoSuchFileError) {
+      return YES;
+    }
+
+    if (error) {
+      *error = [self generateErrorForCode:TrackFragmentCacheErrorReadFailed underlyingError:readError];
+    }
+    return NO;
+  }
+
+  const uint8_t* bytes = cacheData.bytes;
+  NSUInteger length = cacheData.length;
+  NSUInteger offset = 0;
+
+  uint32_t version;
+  uint32_t signatureLength;
+
+  if (length < sizeof(TrackFragmentCacheMagic) + (2 * sizeof(uint32_t)) || memcmp(bytes, TrackFragmentCacheMagic, sizeof(TrackFragmentCacheMagic)) != 0) {
+    if (error) {
+      *error = [self generateErrorForCode:TrackFragmentCacheErrorInvalidFormat underlyingError:nil];
+    }
+    return NO;
+  }
+  offset += sizeof(TrackFragmentCacheMagic);
+
+  memcpy(&version, bytes + offset, sizeof(version));
+  offset += sizeof(version);
+  memcpy(&signatureLength, bytes + offset, sizeof(signatureLength));
+  offset += sizeof(signatureLength);
+
+  if (offset + signatureLength > length) {
+    if (error) {
+      *error = [self generateErrorForCode:TrackFragmentCacheErrorInvalidFormat underlyingError:nil];
+    }
+    return NO;
+  }
+
+  NSString* signature = [[NSString alloc] initWithBytes:(bytes + offset) length:signatureLength encoding:NSUTF8StringEncoding];
+  offset += signatureLength;
+
+  // stale cache from an older format or a different configuration, start from scratch
+  if (version != TrackFragmentCacheFormatVersion || ![signature isEqualToString:_configurationSignature]) {
+    MLE_Log_Info(@"TrackFragmentCache [loadWithError] discarding cache with mismatched version or configuration");
+    return YES;
+  }
+
+  NSMutableDictionary<NSNumber*, TrackFragmentCacheEntry*>* entries = [NSMutableDictionary dictionary];
+
+  while (offset < length) {
+
+    uint64_t persistentID;
+    uint64_t fingerprint;
+    uint32_t fragmentLength;
+
+    if (offset + sizeof(persistentID) + sizeof(fingerprint) + sizeof(fragmentLength) > length) {
+      if (error) {
+        *error = [self generateErrorForCode:TrackFragmentCacheErrorInvalidFormat underlyingError:nil];
+      }
+      return NO;
+    }
+
+    memcpy(&persistentID, bytes + offset, sizeof(persistentID));
+    offset += sizeof(persistentID);
+    memcpy(&fingerprint, bytes + offset, sizeof(fingerprint));
+    offset += sizeof(fingerprint);
+    memcpy(&fragmentLength, bytes + offset, sizeof(fragmentLength));
+    offset += sizeof(fragmentLength);
+
+    if (offset + fragmentLength > length) {
+      if (error) {
+        *error = [self generateErrorForCode:TrackFragmentCacheErrorInvalidFormat underlyingError:nil];
+      }
+      return NO;
+    }
+
+    TrackFragmentCacheEntry* entry = [[TrackFragmentCacheEntry alloc] init];
+    [entry setFingerprint:fingerprint];
+    [entry setFragment:[cacheData subdataWithRange:NSMakeRange(offset, fragmentLength)]];
+    offset += fragmentLength;
+
+    [entries setObject:entry forKey:[NSNumber numberWithUnsignedLongLong:persistentID]];
+  }
+
+  @synchronized (self) {
+    _storedEntries = entries;
+  }
+
+  MLE_Log_Info(@"TrackFragmentCache [loadWithError] loaded %lu cached tracks", entries.count);
+
+  return YES;
+}
+
+- (BOOL)saveWithError:(NSError**)error {
+
+  NSMutableData* cacheData = [NSMutableData data];
+
+  @synchronized (self) {
+
+    NSData* signatureData = [_configurationSignature dataUsingEncoding:NSUTF8StringEncoding];
+    uint32_t version = TrackFragmentCacheFormatVersion;
+    uint32_t signatureLength = (uint32_t)signatureData.length;
+
+    [cacheData appendBytes:TrackFragmentCacheMagic length:sizeof(TrackFragmentCacheMagic)];
+    [cacheData appendBytes:&version length:sizeof(version)];
+    [cacheData appendBytes:&signatureLength length:sizeof(signatureLength)];
+    [cacheData appendData:signatureData];
+
+    // only tracks seen during this export are kept, which drops deleted tracks
+    [_currentEntries enumerateKeysAndObjectsUsingBlock:^(NSNumber* key, TrackFragmentCacheEntry* entry, BOOL* stop) {
+
+      uint64_t persistentID = key.unsignedLongLongValue;
+      uint64_t fingerprint = entry.fingerprint;
+      uint32_t fragmentLength = (uint32_t)entry.fragment.length;
+
+      [cacheData appendBytes:&persistentID length:sizeof(persistentID)];
+      [cacheData appendBytes:&fingerprint length:sizeof(fingerprint)];
+      [cacheData appendBytes:&fragmentLength length:sizeof(fragmentLength)];
+      [cacheData appendData:entry.fragment];
+    }];
+  }
+
+  NSError* writeError;
+  if (![cacheData writeToURL:_cacheURL options:NSDataWritingAtomic error:&writeError]) {
+    if (error) {
+      *error = [self generateErrorForCode:TrackFragmentCacheErrorWriteFailed underlyingError:writeError];
+    }
+    return NO;
+  }
+
+  return YES;
+}
+
+- (void)setFragment:(NSData*)fragment withFingerprint:(uint64_t)fingerprint forTrack:(NSUInteger)track inSnapshot:(LibrarySnapshot*)snapshot {
+
+  TrackFragmentCacheEntry* entry = [[TrackFragmentCacheEntry alloc] init];
+  [entry setFingerprint:fingerprint];
+  [entry setFragment:[fragment copy]];
+
+  NSNumber* persistentID = [NSNumber numberWithUnsignedLongLong:[snapshot persistentIDOfTrack:track]];
+
+  @synchronized (self) {
+    [_currentEntries setObject:entry forKey:persistentID];
+  }
+}
+
+- (NSError*)generateErrorForCode:(TrackFragmentCacheErrorCode)code underlyingError:(nullable NSError*)underlyingError {
+
+  NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+
+  switch (code) {
+    case TrackFragmentCacheErrorReadFailed: {
+      [userInfo setValue:@"Failed to read track cache" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+    case TrackFragmentCacheErrorInvalidFormat: {
+      [userInfo setValue:@"Track cache is corrupt" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+    case TrackFragmentCacheErrorWriteFailed: {
+      [userInfo setValue:@"Failed to write track cache" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+  }
+
+  if (underlyingError != nil) {
+    [userInfo setValue:underlyingError forKey:NSUnderlyingErrorKey];
+  }
+
+  return [NSError errorWithDomain:__MLE_ErrorDomain_TrackFragmentCache code:code userInfo:userInfo];
+}
+
+@end
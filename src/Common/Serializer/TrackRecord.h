@@ -0,0 +1,163 @@
+//
+//  TrackRecord.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+@class MutableOrderedDictionary;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Fixed-layout representation of a serialized track dict.
+//
+// Every key a track can contain has a field in `TrackRecordSchema`, listed in output order. A record holds a bitmask of
+// the fields that are present plus one typed slot per field, so building a track only stores scalars instead of
+// boxing each value and inserting it into an ordered dictionary.
+//
+// String slots are not retained. They must either be owned by the snapshot the record was built from, or be kept
+// alive by the arena the record was allocated from (see `TrackRecordArenaRetainObject`).
+typedef NS_ENUM(uint8_t, TrackRecordValueType) {
+  TrackRecordValueString = 0,
+  TrackRecordValueInteger,
+  TrackRecordValueDate,
+  TrackRecordValueTrue,
+  TrackRecordValuePersistentID,
+  // the slot holds the key, the value is always <true/> (e.g. media kind flags)
+  TrackRecordValueTrueForStringKey,
+};
+
+typedef NS_ENUM(NSUInteger, TrackRecordField) {
+  TrackRecordFieldTrackID = 0,
+  TrackRecordFieldName,
+  TrackRecordFieldArtist,
+  TrackRecordFieldAlbumArtist,
+  TrackRecordFieldComposer,
+  TrackRecordFieldAlbum,
+  TrackRecordFieldGrouping,
+  TrackRecordFieldGenre,
+  TrackRecordFieldKind,
+  TrackRecordFieldComments,
+  TrackRecordFieldSize,
+  TrackRecordFieldTotalTime,
+  TrackRecordFieldStartTime,
+  TrackRecordFieldStopTime,
+  TrackRecordFieldDiscNumber,
+  TrackRecordFieldDiscCount,
+  TrackRecordFieldTrackNumber,
+  TrackRecordFieldTrackCount,
+  TrackRecordFieldYear,
+  TrackRecordFieldBPM,
+  TrackRecordFieldDateModified,
+  TrackRecordFieldDateAdded,
+  TrackRecordFieldBitRate,
+  TrackRecordFieldSampleRate,
+  TrackRecordFieldVolumeAdjustment,
+  TrackRecordFieldGapless,
+  TrackRecordFieldRating,
+  TrackRecordFieldRatingComputed,
+  TrackRecordFieldAlbumRating,
+  TrackRecordFieldAlbumRatingComputed,
+  TrackRecordFieldPlayCount,
+  TrackRecordFieldPlayDate,
+  TrackRecordFieldSkipCount,
+  TrackRecordFieldSkipDate,
+  TrackRecordFieldReleaseDate,
+  TrackRecordFieldNormalization,
+  TrackRecordFieldCompilation,
+  TrackRecordFieldSortAlbum,
+  TrackRecordFieldSortAlbumArtist,
+  TrackRecordFieldSortArtist,
+  TrackRecordFieldSortComposer,
+  TrackRecordFieldSortName,
+  TrackRecordFieldDisabled,
+  TrackRecordFieldPersistentID,
+  TrackRecordFieldMediaKind,
+  TrackRecordFieldLocation,
+  TrackRecordFieldCount,
+};
+
+typedef struct {
+  const char* key;
+  TrackRecordValueType type;
+} TrackRecordFieldSchema;
+
+extern const TrackRecordFieldSchema TrackRecordSchema[TrackRecordFieldCount];
+
+typedef union {
+  __unsafe_unretained NSString* _Nullable string;
+  int64_t integer;
+  uint64_t persistentID;
+  NSTimeInterval date;
+} TrackRecordValue;
+
+typedef struct {
+  uint64_t presentFields;
+  TrackRecordValue values[TrackRecordFieldCount];
+} TrackRecord;
+
+// Bump allocator for track records.
+//
+// Records are carved out of large blocks that are reused after `TrackRecordArenaReset`, so serializing a chunk of
+// tracks costs a handful of allocations rather than one dictionary (plus one object per value) for every track.
+// An arena is not thread-safe, each worker thread should use its own.
+typedef struct TrackRecordArenaBlock TrackRecordArenaBlock;
+
+typedef struct {
+  TrackRecordArenaBlock* _Nullable firstBlock;
+  TrackRecordArenaBlock* _Nullable currentBlock;
+  NSUInteger recordsPerBlock;
+  CFMutableArrayRef _Nullable retainedObjects;
+} TrackRecordArena;
+
+void TrackRecordArenaInit(TrackRecordArena* arena, NSUInteger recordsPerBlock);
+void TrackRecordArenaFree(TrackRecordArena* arena);
+
+// Makes all records available again and releases retained objects. Records allocated before the reset are invalid.
+void TrackRecordArenaReset(TrackRecordArena* arena);
+
+// Returns an empty record, valid until the arena is reset or freed
+TrackRecord* TrackRecordArenaAllocate(TrackRecordArena* arena);
+
+// Keeps an object alive until the arena is reset, for string values that aren't owned by the snapshot
+id TrackRecordArenaRetainObject(TrackRecordArena* arena, id object);
+
+static inline BOOL TrackRecordHasField(const TrackRecord* record, TrackRecordField field) {
+  return (record->presentFields & (1ULL << field)) != 0;
+}
+
+static inline void TrackRecordSetString(TrackRecord* record, TrackRecordField field, NSString* _Nullable string) {
+  if (string != nil) {
+    record->values[field].string = string;
+    record->presentFields |= (1ULL << field);
+  }
+}
+
+static inline void TrackRecordSetInteger(TrackRecord* record, TrackRecordField field, int64_t integer) {
+  record->values[field].integer = integer;
+  record->presentFields |= (1ULL << field);
+}
+
+static inline void TrackRecordSetPersistentID(TrackRecord* record, TrackRecordField field, uint64_t persistentID) {
+  record->values[field].persistentID = persistentID;
+  record->presentFields |= (1ULL << field);
+}
+
+// NaN marks a missing date in the snapshot
+static inline void TrackRecordSetDate(TrackRecord* record, TrackRecordField field, NSTimeInterval date) {
+  if (!isnan(date)) {
+    record->values[field].date = date;
+    record->presentFields |= (1ULL << field);
+  }
+}
+
+static inline void TrackRecordSetTrue(TrackRecord* record, TrackRecordField field) {
+  record->presentFields |= (1ULL << field);
+}
+
+// Builds the equivalent ordered dictionary, for callers that need a track as an object
+MutableOrderedDictionary* TrackRecordDictionary(const TrackRecord* record);
+
+NS_ASSUME_NONNULL_END
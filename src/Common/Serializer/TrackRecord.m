@@ -0,0 +1,183 @@
+//
+//  TrackRecord.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "TrackRecord.h"
+
+#import "OrderedDictionary.h"
+#import "Utils.h"
+
+struct TrackRecordArenaBlock {
+  TrackRecordArenaBlock* next;
+  NSUInteger used;
+  TrackRecord records[];
+};
+
+const TrackRecordFieldSchema TrackRecordSchema[TrackRecordFieldCount] = {
+  [TrackRecordFieldTrackID] = { "Track ID", TrackRecordValueInteger },
+  [TrackRecordFieldName] = { "Name", TrackRecordValueString },
+  [TrackRecordFieldArtist] = { "Artist", TrackRecordValueString },
+  [TrackRecordFieldAlbumArtist] = { "Album Artist", TrackRecordValueString },
+  [TrackRecordFieldComposer] = { "Composer", TrackRecordValueString },
+  [TrackRecordFieldAlbum] = { "Album", TrackRecordValueString },
+  [TrackRecordFieldGrouping] = { "Grouping", TrackRecordValueString },
+  [TrackRecordFieldGenre] = { "Genre", TrackRecordValueString },
+  [TrackRecordFieldKind] = { "Kind", TrackRecordValueString },
+  [TrackRecordFieldComments] = { "Comments", TrackRecordValueString },
+  [TrackRecordFieldSize] = { "Size", TrackRecordValueInteger },
+  [TrackRecordFieldTotalTime] = { "Total Time", TrackRecordValueInteger },
+  [TrackRecordFieldStartTime] = { "Start Time", TrackRecordValueInteger },
+  [TrackRecordFieldStopTime] = { "Stop Time", TrackRecordValueInteger },
+  [TrackRecordFieldDiscNumber] = { "Disc Number", TrackRecordValueInteger },
+  [TrackRecordFieldDiscCount] = { "Disc Count", TrackRecordValueInteger },
+  [TrackRecordFieldTrackNumber] = { "Track Number", TrackRecordValueInteger },
+  [TrackRecordFieldTrackCount] = { "Track Count", TrackRecordValueInteger },
+  [TrackRecordFieldYear] = { "Year", TrackRecordValueInteger },
+  [TrackRecordFieldBPM] = { "BPM", TrackRecordValueInteger },
+  [TrackRecordFieldDateModified] = { "Date Modified", TrackRecordValueDate },
+  [TrackRecordFieldDateAdded] = { "Date Added", TrackRecordValueDate },
+  [TrackRecordFieldBitRate] = { "Bit Rate", TrackRecordValueInteger },
+  [TrackRecordFieldSampleRate] = { "Sample Rate", TrackRecordValueInteger },
+  [TrackRecordFieldVolumeAdjustment] = { "Volume Adjustment", TrackRecordValueInteger },
+  [TrackRecordFieldGapless] = { "Part Of Gapless Album", TrackRecordValueTrue },
+  [TrackRecordFieldRating] = { "Rating", TrackRecordValueInteger },
+  [TrackRecordFieldRatingComputed] = { "Rating Computed", TrackRecordValueTrue },
+  [TrackRecordFieldAlbumRating] = { "Album Rating", TrackRecordValueInteger },
+  [TrackRecordFieldAlbumRatingComputed] = { "Album Rating Computed", TrackRecordValueTrue },
+  [TrackRecordFieldPlayCount] = { "Play Count", TrackRecordValueInteger },
+  [TrackRecordFieldPlayDate] = { "Play Date UTC", TrackRecordValueDate },
+  [TrackRecordFieldSkipCount] = { "Skip Count", TrackRecordValueInteger },
+  [TrackRecordFieldSkipDate] = { "Skip Date", TrackRecordValueDate },
+  [TrackRecordFieldReleaseDate] = { "Release Date", TrackRecordValueDate },
+  [TrackRecordFieldNormalization] = { "Normalization", TrackRecordValueInteger },
+  [TrackRecordFieldCompilation] = { "Compilation", TrackRecordValueTrue },
+  [TrackRecordFieldSortAlbum] = { "Sort Album", TrackRecordValueString },
+  [TrackRecordFieldSortAlbumArtist] = { "Sort Album Artist", TrackRecordValueString },
+  [TrackRecordFieldSortArtist] = { "Sort Artist", TrackRecordValueString },
+  [TrackRecordFieldSortComposer] = { "Sort Composer", TrackRecordValueString },
+  [TrackRecordFieldSortName] = { "Sort Name", TrackRecordValueString },
+  [TrackRecordFieldDisabled] = { "Disabled", TrackRecordValueTrue },
+  [TrackRecordFieldPersistentID] = { "Persistent ID", TrackRecordValuePersistentID },
+  [TrackRecordFieldMediaKind] = { NULL, TrackRecordValueTrueForStringKey },
+  [TrackRecordFieldLocation] = { "Location", TrackRecordValueString },
+};
+
+static TrackRecordArenaBlock* TrackRecordArenaAllocateBlock(NSUInteger recordsPerBlock) {
+
+  TrackRecordArenaBlock* block = malloc(sizeof(TrackRecordArenaBlock) + (recordsPerBlock * sizeof(TrackRecord)));
+
+  block->next = NULL;
+  block->used = 0;
+
+  return block;
+}
+
+void TrackRecordArenaInit(TrackRecordArena* arena, NSUInteger recordsPerBlock) {
+
+  arena->recordsPerBlock = MAX(recordsPerBlock, 1);
+  arena->firstBlock = TrackRecordArenaAllocateBlock(arena->recordsPerBlock);
+  arena->currentBlock = arena->firstBlock;
+  arena->retainedObjects = CFArrayCreateMutable(kCFAllocatorDefault, 0, &kCFTypeArrayCallBacks);
+}
+
+void TrackRecordArenaFree(TrackRecordArena* arena) {
+
+  TrackRecordArenaBlock* block = arena->firstBlock;
+  while (block != NULL) {
+    TrackRecordArenaBlock* next = block->next;
+    free(block);
+    block = next;
+  }
+
+  if (arena->retainedObjects != NULL) {
+    CFRelease(arena->retainedObjects);
+  }
+
+  arena->firstBlock = NULL;
+  arena->currentBlock = NULL;
+  arena->retainedObjects = NULL;
+}
+
+void TrackRecordArenaReset(TrackRecordArena* arena) {
+
+  // blocks are kept for reuse
+  for (TrackRecordArenaBlock* block = arena->firstBlock; block != NULL; block = block->next) {
+    block->used = 0;
+  }
+  arena->currentBlock = arena->firstBlock;
+
+  CFArrayRemoveAllValues(arena->retainedObjects);
+}
+
+TrackRecord* TrackRecordArenaAllocate(TrackRecordArena* arena) {
+
+  TrackRecordArenaBlock* block = arena->currentBlock;
+
+  if (block->used == arena->recordsPerBlock) {
+    if (block->next == NULL) {
+      block->next = TrackRecordArenaAllocateBlock(arena->recordsPerBlock);
+    }
+    block = block->next;
+    arena->currentBlock = block;
+  }
+
+  // only the bitmask needs clearing, slots are never read unless their field is present
+  TrackRecord* record = &block->records[block->used++];
+  record->presentFields = 0;
+
+  return record;
+}
+
+id TrackRecordArenaRetainObject(TrackRecordArena* arena, id object) {
+
+  CFArrayAppendValue(arena->retainedObjects, (__bridge CFTypeRef)object);
+
+  return object;
+}
+
+MutableOrderedDictionary* TrackRecordDictionary(const TrackRecord* record) {
+
+  MutableOrderedDictionary* trackDict = [MutableOrderedDictionary dictionaryWithCapacity:__builtin_popcountll(record->presentFields)];
+
+  for (NSUInteger field = 0; field < TrackRecordFieldCount; field++) {
+
+    if (!TrackRecordHasField(record, field)) {
+      continue;
+    }
+
+    TrackRecordValue value = record->values[field];
+    NSString* key = TrackRecordSchema[field].key != NULL ? [NSString stringWithUTF8String:TrackRecordSchema[field].key] : nil;
+
+    switch (TrackRecordSchema[field].type) {
+      case TrackRecordValueString: {
+        [trackDict appendObject:value.string forUniqueKey:key];
+        break;
+      }
+      case TrackRecordValueInteger: {
+        [trackDict appendObject:[NSNumber numberWithLongLong:value.integer] forUniqueKey:key];
+        break;
+      }
+      case TrackRecordValueDate: {
+        [trackDict appendObject:[NSDate dateWithTimeIntervalSinceReferenceDate:value.date] forUniqueKey:key];
+        break;
+      }
+      case TrackRecordValueTrue: {
+        [trackDict appendObject:[NSNumber numberWithBool:YES] forUniqueKey:key];
+        break;
+      }
+      case TrackRecordValuePersistentID: {
+        [trackDict appendObject:[Utils hexStringForPersistentId:[NSNumber numberWithUnsignedLongLong:value.persistentID]] forUniqueKey:key];
+        break;
+      }
+      case TrackRecordValueTrueForStringKey: {
+        [trackDict appendObject:[NSNumber numberWithBool:YES] forUniqueKey:value.string];
+        break;
+      }
+    }
+  }
+
+  return trackDict;
+}
@@ -0,0 +1,158 @@
+//
+//  LibrarySnapshot.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+@class ITLibrary;
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSUInteger, LibrarySnapshotStringColumn) {
+  LibrarySnapshotStringTitle = 0,
+  LibrarySnapshotStringSortTitle,
+  LibrarySnapshotStringArtist,
+  LibrarySnapshotStringSortArtist,
+  LibrarySnapshotStringAlbumArtist,
+  LibrarySnapshotStringSortAlbumArtist,
+  LibrarySnapshotStringAlbum,
+  LibrarySnapshotStringSortAlbum,
+  LibrarySnapshotStringComposer,
+  LibrarySnapshotStringSortComposer,
+  LibrarySnapshotStringGrouping,
+  LibrarySnapshotStringGenre,
+  LibrarySnapshotStringKind,
+  LibrarySnapshotStringComments,
+  LibrarySnapshotStringCategory,
+  LibrarySnapshotStringDescription,
+  LibrarySnapshotStringMovementName,
+  LibrarySnapshotStringWork,
+  LibrarySnapshotStringLocation,
+  LibrarySnapshotStringColumnCount,
+};
+
+typedef NS_ENUM(NSUInteger, LibrarySnapshotIntegerColumn) {
+  LibrarySnapshotIntegerMediaKind = 0,
+  LibrarySnapshotIntegerFileSize,
+  LibrarySnapshotIntegerTotalTime,
+  LibrarySnapshotIntegerStartTime,
+  LibrarySnapshotIntegerStopTime,
+  LibrarySnapshotIntegerDiscNumber,
+  LibrarySnapshotIntegerDiscCount,
+  LibrarySnapshotIntegerTrackNumber,
+  LibrarySnapshotIntegerTrackCount,
+  LibrarySnapshotIntegerYear,
+  LibrarySnapshotIntegerBeatsPerMinute,
+  LibrarySnapshotIntegerBitRate,
+  LibrarySnapshotIntegerSampleRate,
+  LibrarySnapshotIntegerVolumeAdjustment,
+  LibrarySnapshotIntegerRating,
+  LibrarySnapshotIntegerAlbumRating,
+  LibrarySnapshotIntegerPlayCount,
+  LibrarySnapshotIntegerSkipCount,
+  LibrarySnapshotIntegerNormalization,
+  LibrarySnapshotIntegerMovementNumber,
+  LibrarySnapshotIntegerColumnCount,
+};
+
+typedef NS_ENUM(NSUInteger, LibrarySnapshotDateColumn) {
+  LibrarySnapshotDateModified = 0,
+  LibrarySnapshotDateAdded,
+  LibrarySnapshotDateLastPlayed,
+  LibrarySnapshotDateSkipped,
+  LibrarySnapshotDateReleased,
+  LibrarySnapshotDateColumnCount,
+};
+
+typedef NS_OPTIONS(uint8_t, LibrarySnapshotTrackFlags) {
+  LibrarySnapshotTrackGapless = 1 << 0,
+  LibrarySnapshotTrackRatingComputed = 1 << 1,
+  LibrarySnapshotTrackAlbumRatingComputed = 1 << 2,
+  LibrarySnapshotTrackCompilation = 1 << 3,
+  LibrarySnapshotTrackDisabled = 1 << 4,
+};
+
+typedef NS_OPTIONS(uint8_t, LibrarySnapshotPlaylistFlags) {
+  LibrarySnapshotPlaylistMaster = 1 << 0,
+  LibrarySnapshotPlaylistVisible = 1 << 1,
+};
+
+// Read-only, column-oriented copy of the library used by every export stage.
+//
+// Each track and playlist attribute is stored in its own contiguous column, indexed by the track's (or playlist's)
+// position in the library. Strings are interned and referenced by ID, where ID 0 represents a nil value.
+// Dates are stored as reference-date time intervals, with NAN representing a nil date.
+//
+// A snapshot can be loaded from an `ITLibrary`, or from a previously exported library XML file so that the pipeline
+// can be exercised without the iTunesLibrary framework.
+@interface LibrarySnapshot : NSObject
+
+extern NSErrorDomain const __MLE_ErrorDomain_LibrarySnapshot;
+
+typedef NS_ENUM(NSUInteger, LibrarySnapshotErrorCode) {
+  LibrarySnapshotErrorReadFailed = 0,
+  LibrarySnapshotErrorInvalidFormat,
+};
+
+
+#pragma mark - Properties
+
+@property (readonly) NSUInteger trackCount;
+@property (readonly) NSUInteger playlistCount;
+
+@property (readonly) NSUInteger apiMajorVersion;
+@property (readonly) NSUInteger apiMinorVersion;
+@property (nullable, readonly, copy) NSString* applicationVersion;
+@property (readonly) NSUInteger features;
+@property (readonly) BOOL showContentRating;
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithLibrary:(ITLibrary*)library;
+
++ (nullable instancetype)snapshotWithContentsOfURL:(NSURL*)url error:(NSError**)error;
+
+
+#pragma mark - Accessors
+
+- (nullable NSString*)stringWithID:(uint32_t)stringID;
+
+// Tracks
+- (NSUInteger)indexOfTrackWithPersistentID:(uint64_t)persistentID;
+
+- (uint64_t)persistentIDOfTrack:(NSUInteger)track;
+
+- (uint32_t)stringIDForColumn:(LibrarySnapshotStringColumn)column ofTrack:(NSUInteger)track;
+- (nullable NSString*)stringForColumn:(LibrarySnapshotStringColumn)column ofTrack:(NSUInteger)track;
+
+- (int64_t)integerForColumn:(LibrarySnapshotIntegerColumn)column ofTrack:(NSUInteger)track;
+
+- (NSTimeInterval)timeIntervalForColumn:(LibrarySnapshotDateColumn)column ofTrack:(NSUInteger)track;
+- (nullable NSDate*)dateForColumn:(LibrarySnapshotDateColumn)column ofTrack:(NSUInteger)track;
+
+- (LibrarySnapshotTrackFlags)flagsOfTrack:(NSUInteger)track;
+
+// Raw column storage, each holding `trackCount` values
+- (const uint32_t*)stringIDColumn:(LibrarySnapshotStringColumn)column;
+- (const int64_t*)integerColumn:(LibrarySnapshotIntegerColumn)column;
+- (const double*)dateColumn:(LibrarySnapshotDateColumn)column;
+
+// Playlists
+- (uint64_t)persistentIDOfPlaylist:(NSUInteger)playlist;
+- (uint64_t)parentIDOfPlaylist:(NSUInteger)playlist;
+
+- (nullable NSString*)nameOfPlaylist:(NSUInteger)playlist;
+- (NSUInteger)kindOfPlaylist:(NSUInteger)playlist;
+- (NSUInteger)distinguishedKindOfPlaylist:(NSUInteger)playlist;
+- (LibrarySnapshotPlaylistFlags)flagsOfPlaylist:(NSUInteger)playlist;
+
+- (NSUInteger)itemCountOfPlaylist:(NSUInteger)playlist;
+- (const uint32_t*)itemsOfPlaylist:(NSUInteger)playlist;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,669 @@
+//
+//  LibrarySnapshot.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "LibrarySnapshot.h"
+
+#import <iTunesLibrary/ITLibrary.h>
+#import <iTunesLibrary/ITLibAlbum.h>
+#import <iTunesLibrary/ITLibArtist.h>
+#import <iTunesLibrary/ITLibMediaItem.h>
+#import <iTunesLibrary/ITLibPlaylist.h>
+
+#import "Logger.h"
+#import "PersistentIDMap.h"
+
+// keys used by exported library files, indexed by column
+static NSString* const LibrarySnapshotStringKeys[LibrarySnapshotStringColumnCount] = {
+  @"Name",
+  @"Sort Name",
+  @"Artist",
+  @"Sort Artist",
+  @"Album Artist",
+  @"Sort Album Artist",
+  @"Album",
+  @"Sort Album",
+  @"Composer",
+  @"Sort Composer",
+  @"Grouping",
+  @"Genre",
+  @"Kind",
+  @"Comments",
+  @"Category",
+  @"Description",
+  @"Movement Name",
+  @"Work",
+  @"Location",
+};
+
+static NSString* const LibrarySnapshotIntegerKeys[LibrarySnapshotIntegerColumnCount] = {
+  @"", // media kind is exported as a boolean key
+  @"Size",
+  @"Total Time",
+  @"Start Time",
+  @"Stop Time",
+  @"Disc Number",
+  @"Disc Count",
+  @"Track Number",
+  @"Track Count",
+  @"Year",
+  @"BPM",
+  @"Bit Rate",
+  @"Sample Rate",
+  @"Volume Adjustment",
+  @"Rating",
+  @"Album Rating",
+  @"Play Count",
+  @"Skip Count",
+  @"Normalization",
+  @"Movement Number",
+};
+
+static NSString* const LibrarySnapshotDateKeys[LibrarySnapshotDateColumnCount] = {
+  @"Date Modified",
+  @"Date Added",
+  @"Play Date UTC",
+  @"Skip Date",
+  @"Release Date",
+};
+
+@implementation LibrarySnapshot {
+
+  // tracks - each column holds `_trackCount` values, stored column after column
+  NSMutableData* _trackPersistentIDData;
+  NSMutableData* _trackStringIDData;
+  NSMutableData* _trackIntegerData;
+  NSMutableData* _trackDateData;
+  NSMutableData* _trackFlagData;
+
+  uint64_t* _trackPersistentIDs;
+  uint32_t* _trackStringIDs;
+  int64_t* _trackIntegers;
+  double* _trackDates;
+  uint8_t* _trackFlags;
+
+  PersistentIDMap _trackIndexes;
+
+  // playlists
+  NSMutableData* _playlistData;
+  NSMutableData* _playlistItemOffsetData;
+  NSMutableData* _playlistItemData;
+
+  // interned strings, ID 0 is reserved for nil
+  NSMutableArray<NSString*>* _strings;
+  NSMutableDictionary<NSString*, NSNumber*>* _stringIDs;
+}
+
+typedef struct {
+  uint64_t persistentID;
+  uint64_t parentID;
+  uint32_t name;
+  uint32_t kind;
+  uint32_t distinguishedKind;
+  uint8_t flags;
+} LibrarySnapshotPlaylist;
+
+NSErrorDomain const __MLE_ErrorDomain_LibrarySnapshot = @"com.kylekingcdn.MusicLibraryExporter.LibrarySnapshotErrorDomain";
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithTrackCount:(NSUInteger)trackCount andPlaylistCount:(NSUInteger)playlistCount {
+
+  if (self = [super init]) {
+
+    _trackCount = trackCount;
+    _playlistCount = playlistCount;
+
+    _apiMajorVersion = 0;
+    _apiMinorVersion = 0;
+    _applicationVersion = nil;
+    _features = 0;
+    _showContentRating = NO;
+
+    _trackPersistentIDData = [NSMutableData dataWithLength:(trackCount * sizeof(uint64_t))];
+    _trackStringIDData = [NSMutableData dataWithLength:(trackCount * LibrarySnapshotStringColumnCount * sizeof(uint32_t))];
+    _trackIntegerData = [NSMutableData dataWithLength:(trackCount * LibrarySnapshotIntegerColumnCount * sizeof(int64_t))];
+    _trackDateData = [NSMutableData dataWithLength:(trackCount * LibrarySnapshotDateColumnCount * sizeof(double))];
+    _trackFlagData = [NSMutableData dataWithLength:(trackCount * sizeof(uint8_t))];
+
+    _trackPersistentIDs = _trackPersistentIDData.mutableBytes;
+    _trackStringIDs = _trackStringIDData.mutableBytes;
+    _trackIntegers = _trackIntegerData.mutableBytes;
+    _trackDates = _trackDateData.mutableBytes;
+    _trackFlags = _trackFlagData.mutableBytes;
+
+    for (NSUInteger index = 0; index < trackCount * LibrarySnapshotDateColumnCount; index++) {
+      _trackDates[index] = NAN;
+    }
+
+    PersistentIDMapInit(&_trackIndexes, trackCount);
+
+    _playlistData = [NSMutableData dataWithLength:(playlistCount * sizeof(LibrarySnapshotPlaylist))];
+    _playlistItemOffsetData = [NSMutableData dataWithLength:((playlistCount + 1) * sizeof(uint32_t))];
+    _playlistItemData = [NSMutableData data];
+
+    _strings = [NSMutableArray arrayWithObject:@""];
+    _stringIDs = [NSMutableDictionary dictionary];
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+- (instancetype)initWithLibrary:(ITLibrary*)library {
+
+  NSArray<ITLibMediaItem*>* items = library.allMediaItems;
+  NSArray<ITLibPlaylist*>* playlists = library.allPlaylists;
+
+  if (self = [self initWithTrackCount:items.count andPlaylistCount:playlists.count]) {
+
+    _apiMajorVersion = library.apiMajorVersion;
+    _apiMinorVersion = library.apiMinorVersion;
+    _applicationVersion = [library.applicationVersion copy];
+    _features = library.features;
+    _showContentRating = library.showContentRating;
+
+    NSUInteger track = 0;
+    for (ITLibMediaItem* item in items) {
+      @autoreleasepool {
+        [self loadTrack:track fromItem:item];
+      }
+      track++;
+    }
+
+    NSUInteger playlist = 0;
+    for (ITLibPlaylist* libraryPlaylist in playlists) {
+      @autoreleasepool {
+        [self loadPlaylist:playlist fromPlaylist:libraryPlaylist];
+      }
+      playlist++;
+    }
+
+    [self finishLoading];
+
+    MLE_Log_Info(@"LibrarySnapshot [initWithLibrary] loaded %lu tracks, %lu playlists, %lu unique strings", _trackCount, _playlistCount, _strings.count);
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
++ (nullable instancetype)snapshotWithContentsOfURL:(NSURL*)url error:(NSError**)error {
+
+  NSError* readError;
+  NSData* fileData = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:&readError];
+  if (fileData == nil) {
+    if (error) {
+      *error = [LibrarySnapshot generateErrorForCode:LibrarySnapshotErrorReadFailed underlyingError:readError];
+    }
+    return nil;
+  }
+
+  NSDictionary* libraryDict = [NSPropertyListSerialization propertyListWithData:fileData options:NSPropertyListImmutable format:nil error:&readError];
+  if (![libraryDict isKindOfClass:[NSDictionary class]] ||
+      ![libraryDict[@"Tracks"] isKindOfClass:[NSDictionary class]] ||
+      ![libraryDict[@"Playlists"] isKindOfClass:[NSArray class]]) {
+    if (error) {
+      *error = [LibrarySnapshot generateErrorForCode:LibrarySnapshotErrorInvalidFormat underlyingError:readError];
+    }
+    return nil;
+  }
+
+  NSDictionary<NSString*, NSDictionary*>* tracksDict = libraryDict[@"Tracks"];
+  NSArray<NSDictionary*>* playlistDicts = libraryDict[@"Playlists"];
+
+  // restore the original track order from the assigned track IDs
+  NSArray<NSDictionary*>* trackDicts = [tracksDict.allValues sortedArrayUsingComparator:^NSComparisonResult(NSDictionary* track1, NSDictionary* track2) {
+    return [track1[@"Track ID"] compare:track2[@"Track ID"]];
+  }];
+
+  LibrarySnapshot* snapshot = [[LibrarySnapshot alloc] initWithTrackCount:trackDicts.count andPlaylistCount:playlistDicts.count];
+
+  snapshot->_apiMajorVersion = [libraryDict[@"Major Version"] unsignedIntegerValue];
+  snapshot->_apiMinorVersion = [libraryDict[@"Minor Version"] unsignedIntegerValue];
+  snapshot->_applicationVersion = [libraryDict[@"Application Version"] copy];
+  snapshot->_features = [libraryDict[@"Features"] unsignedIntegerValue];
+  snapshot->_showContentRating = [libraryDict[@"Show Content Ratings"] boolValue];
+
+  // playlist items reference tracks by their exported track ID
+  PersistentIDMap trackIndexesByID;
+  PersistentIDMapInit(&trackIndexesByID, trackDicts.count);
+
+  NSUInteger track = 0;
+  for (NSDictionary* trackDict in trackDicts) {
+    @autoreleasepool {
+      [snapshot loadTrack:track fromDictionary:trackDict];
+      PersistentIDMapSet(&trackIndexesByID, [trackDict[@"Track ID"] unsignedLongLongValue], (uint32_t)(track + 1));
+    }
+    track++;
+  }
+
+  NSUInteger playlist = 0;
+  for (NSDictionary* playlistDict in playlistDicts) {
+    @autoreleasepool {
+      [snapshot loadPlaylist:playlist fromDictionary:playlistDict withTrackIndexes:&trackIndexesByID];
+    }
+    playlist++;
+  }
+
+  PersistentIDMapFree(&trackIndexesByID);
+
+  [snapshot finishLoading];
+
+  return snapshot;
+}
+
+- (void)dealloc {
+
+  PersistentIDMapFree(&_trackIndexes);
+}
+
+
+#pragma mark - Accessors
+
+- (nullable NSString*)stringWithID:(uint32_t)stringID {
+
+  if (stringID == 0) {
+    return nil;
+  }
+
+  return _strings[stringID];
+}
+
+- (NSUInteger)indexOfTrackWithPersistentID:(uint64_t)persistentID {
+
+  uint32_t trackIndex = PersistentIDMapGet(&_trackIndexes, persistentID);
+
+  return (trackIndex == 0) ? NSNotFound : (trackIndex - 1);
+}
+
+- (uint64_t)persistentIDOfTrack:(NSUInteger)track {
+
+  return _trackPersistentIDs[track];
+}
+
+- (uint32_t)stringIDForColumn:(LibrarySnapshotStringColumn)column ofTrack:(NSUInteger)track {
+
+  return _trackStringIDs[(column * _trackCount) + track];
+}
+
+- (nullable NSString*)stringForColumn:(LibrarySnapshotStringColumn)column ofTrack:(NSUInteger)track {
+
+  return [self stringWithID:_trackStringIDs[(column * _trackCount) + track]];
+}
+
+- (int64_t)integerForColumn:(LibrarySnapshotIntegerColumn)column ofTrack:(NSUInteger)track {
+
+  return _trackIntegers[(column * _trackCount) + track];
+}
+
+- (NSTimeInterval)timeIntervalForColumn:(LibrarySnapshotDateColumn)column ofTrack:(NSUInteger)track {
+
+  return _trackDates[(column * _trackCount) + track];
+}
+
+- (nullable NSDate*)dateForColumn:(LibrarySnapshotDateColumn)column ofTrack:(NSUInteger)track {
+
+  NSTimeInterval timeInterval = _trackDates[(column * _trackCount) + track];
+
+  if (isnan(timeInterval)) {
+    return nil;
+  }
+
+  return [NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval];
+}
+
+- (LibrarySnapshotTrackFlags)flagsOfTrack:(NSUInteger)track {
+
+  return _trackFlags[track];
+}
+
+- (const uint32_t*)stringIDColumn:(LibrarySnapshotStringColumn)column {
+
+  return _trackStringIDs + (column * _trackCount);
+}
+
+- (const int64_t*)integerColumn:(LibrarySnapshotIntegerColumn)column {
+
+  return _trackIntegers + (column * _trackCount);
+}
+
+- (const double*)dateColumn:(LibrarySnapshotDateColumn)column {
+
+  return _trackDates + (column * _trackCount);
+}
+
+- (uint64_t)persistentIDOfPlaylist:(NSUInteger)playlist {
+
+  return [self playlistAtIndex:playlist]->persistentID;
+}
+
+- (uint64_t)parentIDOfPlaylist:(NSUInteger)playlist {
+
+  return [self playlistAtIndex:playlist]->parentID;
+}
+
+- (nullable NSString*)nameOfPlaylist:(NSUInteger)playlist {
+
+  return [self stringWithID:[self playlistAtIndex:playlist]->name];
+}
+
+- (NSUInteger)kindOfPlaylist:(NSUInteger)playlist {
+
+  return [self playlistAtIndex:playlist]->kind;
+}
+
+- (NSUInteger)distinguishedKindOfPlaylist:(NSUInteger)playlist {
+
+  return [self playlistAtIndex:playlist]->distinguishedKind;
+}
+
+- (LibrarySnapshotPlaylistFlags)flagsOfPlaylist:(NSUInteger)playlist {
+
+  return [self playlistAtIndex:playlist]->flags;
+}
+
+- (NSUInteger)itemCountOfPlaylist:(NSUInteger)playlist {
+
+  const uint32_t* offsets = _playlistItemOffsetData.bytes;
+
+  return offsets[playlist + 1] - offsets[playlist];
+}
+
+- (const uint32_t*)itemsOfPlaylist:(NSUInteger)playlist {
+
+  const uint32_t* offsets = _playlistItemOffsetData.bytes;
+  const uint32_t* items = _playlistItemData.bytes;
+
+  return items + offsets[playlist];
+}
+
+- (LibrarySnapshotPlaylist*)playlistAtIndex:(NSUInteger)playlist {
+
+  NSAssert(playlist < _playlistCount, @"LibrarySnapshot playlist index out of bounds");
+
+  return ((LibrarySnapshotPlaylist*)_playlistData.mutableBytes) + playlist;
+}
+
+
+#pragma mark - Mutators
+
+- (uint32_t)internString:(nullable NSString*)string {
+
+  if (string == nil) {
+    return 0;
+  }
+
+  NSNumber* stringID = [_stringIDs objectForKey:string];
+
+  // not stored yet
+  if (stringID == nil) {
+    stringID = [NSNumber numberWithUnsignedInteger:_strings.count];
+    [_strings addObject:[string copy]];
+    [_stringIDs setObject:stringID forKey:_strings.lastObject];
+  }
+
+  return (uint32_t)stringID.unsignedIntegerValue;
+}
+
+- (void)setPersistentID:(uint64_t)persistentID ofTrack:(NSUInteger)track {
+
+  _trackPersistentIDs[track] = persistentID;
+  PersistentIDMapSet(&_trackIndexes, persistentID, (uint32_t)(track + 1));
+}
+
+- (void)setString:(nullable NSString*)string forColumn:(LibrarySnapshotStringColumn)column ofTrack:(NSUInteger)track {
+
+  _trackStringIDs[(column * _trackCount) + track] = [self internString:string];
+}
+
+- (void)setInteger:(int64_t)value forColumn:(LibrarySnapshotIntegerColumn)column ofTrack:(NSUInteger)track {
+
+  _trackIntegers[(column * _trackCount) + track] = value;
+}
+
+- (void)setDate:(nullable NSDate*)date forColumn:(LibrarySnapshotDateColumn)column ofTrack:(NSUInteger)track {
+
+  _trackDates[(column * _trackCount) + track] = (date != nil) ? date.timeIntervalSinceReferenceDate : NAN;
+}
+
+- (void)loadTrack:(NSUInteger)track fromItem:(ITLibMediaItem*)item {
+
+  [self setPersistentID:item.persistentID.unsignedLongLongValue ofTrack:track];
+
+  [self setString:item.title forColumn:LibrarySnapshotStringTitle ofTrack:track];
+  [self setString:item.sortTitle forColumn:LibrarySnapshotStringSortTitle ofTrack:track];
+  [self setString:item.artist.name forColumn:LibrarySnapshotStringArtist ofTrack:track];
+  [self setString:item.artist.sortName forColumn:LibrarySnapshotStringSortArtist ofTrack:track];
+  [self setString:item.album.albumArtist forColumn:LibrarySnapshotStringAlbumArtist ofTrack:track];
+  [self setString:item.album.sortAlbumArtist forColumn:LibrarySnapshotStringSortAlbumArtist ofTrack:track];
+  [self setString:item.album.title forColumn:LibrarySnapshotStringAlbum ofTrack:track];
+  [self setString:item.album.sortTitle forColumn:LibrarySnapshotStringSortAlbum ofTrack:track];
+  [self setString:item.composer forColumn:LibrarySnapshotStringComposer ofTrack:track];
+  [self setString:item.sortComposer forColumn:LibrarySnapshotStringSortComposer ofTrack:track];
+  [self setString:item.grouping forColumn:LibrarySnapshotStringGrouping ofTrack:track];
+  [self setString:item.genre forColumn:LibrarySnapshotStringGenre ofTrack:track];
+  [self setString:item.kind forColumn:LibrarySnapshotStringKind ofTrack:track];
+  [self setString:item.comments forColumn:LibrarySnapshotStringComments ofTrack:track];
+  [self setString:[item valueForProperty:ITLibMediaItemPropertyCategory] forColumn:LibrarySnapshotStringCategory ofTrack:track];
+  [self setString:[item valueForProperty:ITLibMediaItemPropertyDescription] forColumn:LibrarySnapshotStringDescription ofTrack:track];
+  [self setString:[item valueForProperty:ITLibMediaItemPropertyMovementName] forColumn:LibrarySnapshotStringMovementName ofTrack:track];
+  [self setString:[item valueForProperty:ITLibMediaItemPropertyWork] forColumn:LibrarySnapshotStringWork ofTrack:track];
+  [self setString:item.location.path forColumn:LibrarySnapshotStringLocation ofTrack:track];
+
+  [self setInteger:item.mediaKind forColumn:LibrarySnapshotIntegerMediaKind ofTrack:track];
+  [self setInteger:item.fileSize forColumn:LibrarySnapshotIntegerFileSize ofTrack:track];
+  [self setInteger:item.totalTime forColumn:LibrarySnapshotIntegerTotalTime ofTrack:track];
+  [self setInteger:item.startTime forColumn:LibrarySnapshotIntegerStartTime ofTrack:track];
+  [self setInteger:item.stopTime forColumn:LibrarySnapshotIntegerStopTime ofTrack:track];
+  [self setInteger:item.album.discNumber forColumn:LibrarySnapshotIntegerDiscNumber ofTrack:track];
+  [self setInteger:item.album.discCount forColumn:LibrarySnapshotIntegerDiscCount ofTrack:track];
+  [self setInteger:item.trackNumber forColumn:LibrarySnapshotIntegerTrackNumber ofTrack:track];
+  [self setInteger:item.album.trackCount forColumn:LibrarySnapshotIntegerTrackCount ofTrack:track];
+  [self setInteger:item.year forColumn:LibrarySnapshotIntegerYear ofTrack:track];
+  [self setInteger:item.beatsPerMinute forColumn:LibrarySnapshotIntegerBeatsPerMinute ofTrack:track];
+  [self setInteger:item.bitrate forColumn:LibrarySnapshotIntegerBitRate ofTrack:track];
+  [self setInteger:item.sampleRate forColumn:LibrarySnapshotIntegerSampleRate ofTrack:track];
+  [self setInteger:item.volumeAdjustment forColumn:LibrarySnapshotIntegerVolumeAdjustment ofTrack:track];
+  [self setInteger:item.rating forColumn:LibrarySnapshotIntegerRating ofTrack:track];
+  [self setInteger:item.album.rating forColumn:LibrarySnapshotIntegerAlbumRating ofTrack:track];
+  [self setInteger:item.playCount forColumn:LibrarySnapshotIntegerPlayCount ofTrack:track];
+  [self setInteger:item.skipCount forColumn:LibrarySnapshotIntegerSkipCount ofTrack:track];
+  [self setInteger:item.volumeNormalizationEnergy forColumn:LibrarySnapshotIntegerNormalization ofTrack:track];
+  [self setInteger:[[item valueForProperty:ITLibMediaItemPropertyMovementNumber] longLongValue] forColumn:LibrarySnapshotIntegerMovementNumber ofTrack:track];
+
+  [self setDate:item.modifiedDate forColumn:LibrarySnapshotDateModified ofTrack:track];
+  [self setDate:item.addedDate forColumn:LibrarySnapshotDateAdded ofTrack:track];
+  [self setDate:item.lastPlayedDate forColumn:LibrarySnapshotDateLastPlayed ofTrack:track];
+  [self setDate:item.skipDate forColumn:LibrarySnapshotDateSkipped ofTrack:track];
+  [self setDate:item.releaseDate forColumn:LibrarySnapshotDateReleased ofTrack:track];
+
+  LibrarySnapshotTrackFlags flags = 0;
+  if (item.album.gapless) {
+    flags |= LibrarySnapshotTrackGapless;
+  }
+  if (item.ratingComputed) {
+    flags |= LibrarySnapshotTrackRatingComputed;
+  }
+  if (item.album.ratingComputed) {
+    flags |= LibrarySnapshotTrackAlbumRatingComputed;
+  }
+  if (item.album.compilation) {
+    flags |= LibrarySnapshotTrackCompilation;
+  }
+  if (item.isUserDisabled) {
+    flags |= LibrarySnapshotTrackDisabled;
+  }
+  _trackFlags[track] = flags;
+}
+
+- (void)loadTrack:(NSUInteger)track fromDictionary:(NSDictionary*)trackDict {
+
+  NSString* persistentHexID = trackDict[@"Persistent ID"];
+  [self setPersistentID:strtoull(persistentHexID.UTF8String, NULL, 16) ofTrack:track];
+
+  for (NSUInteger column = 0; column < LibrarySnapshotStringColumnCount; column++) {
+    [self setString:trackDict[LibrarySnapshotStringKeys[column]] forColumn:column ofTrack:track];
+  }
+
+  // locations are exported as (possibly remapped) URLs
+  NSString* location = trackDict[@"Location"];
+  if (location != nil) {
+    [self setString:[NSURL URLWithString:location].path forColumn:LibrarySnapshotStringLocation ofTrack:track];
+  }
+
+  for (NSUInteger column = LibrarySnapshotIntegerMediaKind + 1; column < LibrarySnapshotIntegerColumnCount; column++) {
+    [self setInteger:[trackDict[LibrarySnapshotIntegerKeys[column]] longLongValue] forColumn:column ofTrack:track];
+  }
+
+  // media kinds other than song are exported as boolean keys
+  static NSDictionary<NSString*, NSNumber*>* mediaKindKeys;
+  static dispatch_once_t onceToken;
+
+  dispatch_once(&onceToken, ^{
+    mediaKindKeys = @{
+      @"Tone": @(ITLibMediaItemMediaKindAlertTone),
+      @"Audiobook": @(ITLibMediaItemMediaKindAudiobook),
+      @"Book": @(ITLibMediaItemMediaKindBook),
+      @"Movie": @(ITLibMediaItemMediaKindMovie),
+      @"Music Video": @(ITLibMediaItemMediaKindMusicVideo),
+      @"Podcast": @(ITLibMediaItemMediaKindPodcast),
+      @"TV Show": @(ITLibMediaItemMediaKindTVShow),
+      @"Ringtone": @(ITLibMediaItemMediaKindRingtone),
+    };
+  });
+
+  int64_t mediaKind = ITLibMediaItemMediaKindSong;
+  for (NSString* mediaKindKey in mediaKindKeys) {
+    if ([trackDict[mediaKindKey] boolValue]) {
+      mediaKind = mediaKindKeys[mediaKindKey].longLongValue;
+      break;
+    }
+  }
+  [self setInteger:mediaKind forColumn:LibrarySnapshotIntegerMediaKind ofTrack:track];
+
+  for (NSUInteger column = 0; column < LibrarySnapshotDateColumnCount; column++) {
+    [self setDate:trackDict[LibrarySnapshotDateKeys[column]] forColumn:column ofTrack:track];
+  }
+
+  LibrarySnapshotTrackFlags flags = 0;
+  if ([trackDict[@"Part Of Gapless Album"] boolValue]) {
+    flags |= LibrarySnapshotTrackGapless;
+  }
+  if ([trackDict[@"Rating Computed"] boolValue]) {
+    flags |= LibrarySnapshotTrackRatingComputed;
+  }
+  if ([trackDict[@"Album Rating Computed"] boolValue]) {
+    flags |= LibrarySnapshotTrackAlbumRatingComputed;
+  }
+  if ([trackDict[@"Compilation"] boolValue]) {
+    flags |= LibrarySnapshotTrackCompilation;
+  }
+  if ([trackDict[@"Disabled"] boolValue]) {
+    flags |= LibrarySnapshotTrackDisabled;
+  }
+  _trackFlags[track] = flags;
+}
+
+- (void)loadPlaylist:(NSUInteger)playlist fromPlaylist:(ITLibPlaylist*)libraryPlaylist {
+
+  LibrarySnapshotPlaylist* playlistData = [self playlistAtIndex:playlist];
+
+  playlistData->persistentID = libraryPlaylist.persistentID.unsignedLongLongValue;
+  playlistData->parentID = libraryPlaylist.parentID.unsignedLongLongValue;
+  playlistData->name = [self internString:libraryPlaylist.name];
+  playlistData->kind = (uint32_t)libraryPlaylist.kind;
+  playlistData->distinguishedKind = (uint32_t)libraryPlaylist.distinguishedKind;
+  playlistData->flags = (libraryPlaylist.master ? LibrarySnapshotPlaylistMaster : 0) | (libraryPlaylist.visible ? LibrarySnapshotPlaylistVisible : 0);
+
+  [self beginItemsOfPlaylist:playlist];
+  for (ITLibMediaItem* item in libraryPlaylist.items) {
+    [self appendItemWithPersistentID:item.persistentID.unsignedLongLongValue];
+  }
+}
+
+- (void)loadPlaylist:(NSUInteger)playlist fromDictionary:(NSDictionary*)playlistDict withTrackIndexes:(PersistentIDMap*)trackIndexesByID {
+
+  LibrarySnapshotPlaylist* playlistData = [self playlistAtIndex:playlist];
+
+  NSString* persistentHexID = playlistDict[@"Playlist Persistent ID"];
+  NSString* parentHexID = playlistDict[@"Parent Persistent ID"];
+
+  playlistData->persistentID = strtoull(persistentHexID.UTF8String, NULL, 16);
+  playlistData->parentID = (parentHexID != nil) ? strtoull(parentHexID.UTF8String, NULL, 16) : 0;
+  playlistData->name = [self internString:playlistDict[@"Name"]];
+  playlistData->kind = [playlistDict[@"Folder"] boolValue] ? ITLibPlaylistKindFolder : ITLibPlaylistKindRegular;
+  playlistData->distinguishedKind = [playlistDict[@"Distinguished Kind"] unsignedIntValue];
+
+  BOOL master = [playlistDict[@"Master"] boolValue];
+  BOOL visible = (playlistDict[@"Visible"] == nil || [playlistDict[@"Visible"] boolValue]);
+  playlistData->flags = (master ? LibrarySnapshotPlaylistMaster : 0) | (visible ? LibrarySnapshotPlaylistVisible : 0);
+
+  [self beginItemsOfPlaylist:playlist];
+  for (NSDictionary* itemDict in playlistDict[@"Playlist Items"]) {
+
+    uint32_t trackIndex = PersistentIDMapGet(trackIndexesByID, [itemDict[@"Track ID"] unsignedLongLongValue]);
+    if (trackIndex != 0) {
+      uint32_t item = trackIndex - 1;
+      [_playlistItemData appendBytes:&item length:sizeof(item)];
+    }
+  }
+}
+
+- (void)beginItemsOfPlaylist:(NSUInteger)playlist {
+
+  uint32_t* offsets = _playlistItemOffsetData.mutableBytes;
+
+  offsets[playlist] = (uint32_t)(_playlistItemData.length / sizeof(uint32_t));
+}
+
+- (void)appendItemWithPersistentID:(uint64_t)persistentID {
+
+  uint32_t trackIndex = PersistentIDMapGet(&_trackIndexes, persistentID);
+
+  // ignore items that are not part of the library's tracks
+  if (trackIndex != 0) {
+    uint32_t item = trackIndex - 1;
+    [_playlistItemData appendBytes:&item length:sizeof(item)];
+  }
+}
+
+- (void)finishLoading {
+
+  uint32_t* offsets = _playlistItemOffsetData.mutableBytes;
+  offsets[_playlistCount] = (uint32_t)(_playlistItemData.length / sizeof(uint32_t));
+
+  // interning is only needed while loading
+  _stringIDs = nil;
+}
+
++ (NSError*)generateErrorForCode:(LibrarySnapshotErrorCode)code underlyingError:(nullable NSError*)underlyingError {
+
+  NSMutableDictionary* userInfo = [NSMutableDictionary dictionary];
+  if (underlyingError != nil) {
+    [userInfo setObject:underlyingError forKey:NSUnderlyingErrorKey];
+  }
+
+  switch (code) {
+    case LibrarySnapshotErrorReadFailed: {
+      [userInfo setObject:@"Unable to read the library file" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+    case LibrarySnapshotErrorInvalidFormat: {
+      [userInfo setObject:@"The library file is not a valid exported library" forKey:NSLocalizedDescriptionKey];
+      break;
+    }
+  }
+
+  return [NSError errorWithDomain:__MLE_ErrorDomain_LibrarySnapshot code:code userInfo:userInfo];
+}
+
+@end
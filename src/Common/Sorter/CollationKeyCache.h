@@ -0,0 +1,45 @@
+//
+//  CollationKeyCache.h
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Caches binary collation keys for strings compared by MediaItemSorter.
+//
+// Keys are ordered with a plain byte comparison and follow the rules of `alphabeticallyCompareString`:
+// strings beginning with a letter come first, then case and diacritics are ignored and digit runs compare numerically.
+//
+// Strings whose order a key can't reproduce exactly (characters outside the BMP or non-ASCII digits) have no key and
+// must be compared with `compare:options:`.
+@interface CollationKeyCache : NSObject
+
+#pragma mark - Properties
+
+@property (readonly) NSUInteger count;
+
+
+#pragma mark - Accessors
+
+- (nullable NSData*)keyForString:(NSString*)string;
+
++ (nullable NSData*)generateKeyForString:(NSString*)string;
+
++ (NSComparisonResult)compareKey:(NSData*)key1 withKey:(NSData*)key2;
+
+// Orders the strings by their keys. Strings with equal keys (e.g. "Track 01" and "Track 1") are ordered by
+// `compare:options:`, as they were before keys were used.
++ (NSComparisonResult)compareKey:(NSData*)key1 ofString:(NSString*)string1 withKey:(NSData*)key2 ofString:(NSString*)string2;
+
+
+#pragma mark - Mutators
+
+- (void)removeAllKeys;
+
+@end
+
+NS_ASSUME_NONNULL_END
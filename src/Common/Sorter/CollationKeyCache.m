@@ -0,0 +1,189 @@
+//
+//  CollationKeyCache.m
+//  Music Library Exporter
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "CollationKeyCache.h"
+
+// keys always begin with the letter prefix byte, so an empty key marks a string that has no key
+static NSData* CollationKeyCacheNoKey(void) {
+
+  static NSData* noKey;
+  static dispatch_once_t onceToken;
+
+  dispatch_once(&onceToken, ^{
+    noKey = [NSData data];
+  });
+
+  return noKey;
+}
+
+
+@implementation CollationKeyCache {
+
+  NSMutableDictionary<NSString*, NSData*>* _keys;
+}
+
+
+#pragma mark - Initializers
+
+- (instancetype)init {
+
+  if (self = [super init]) {
+
+    _keys = [NSMutableDictionary dictionary];
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+
+#pragma mark - Accessors
+
+- (NSUInteger)count {
+
+  @synchronized (_keys) {
+    return _keys.count;
+  }
+}
+
+- (nullable NSData*)keyForString:(NSString*)string {
+
+  @synchronized (_keys) {
+
+    NSData* key = [_keys objectForKey:string];
+
+    // not stored yet
+    if (key == nil) {
+      key = [CollationKeyCache generateKeyForString:string] ?: CollationKeyCacheNoKey();
+      [_keys setObject:key forKey:[string copy]];
+    }
+
+    return (key.length > 0) ? key : nil;
+  }
+}
+
++ (nullable NSData*)generateKeyForString:(NSString*)string {
+
+  // letter-prefixed strings sort before strings beginning with a digit, special char, etc
+  BOOL letterPrefix = (string.length > 0 && [[NSCharacterSet letterCharacterSet] characterIsMember:[string characterAtIndex:0]]);
+
+  NSString* foldedString = [string stringByFoldingWithOptions:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch) locale:nil];
+
+  NSUInteger length = foldedString.length;
+  NSMutableData* charData = [NSMutableData dataWithLength:(length * sizeof(unichar))];
+  unichar* chars = (unichar*)charData.mutableBytes;
+  [foldedString getCharacters:chars range:NSMakeRange(0, length)];
+
+  // compare:options: orders surrogate pairs and numeric search treats other digits differently than code units
+  NSCharacterSet* decimalDigits = [NSCharacterSet decimalDigitCharacterSet];
+  for (NSUInteger index = 0; index < length; index++) {
+    unichar character = chars[index];
+    if (CFStringIsSurrogateHighCharacter(character) || CFStringIsSurrogateLowCharacter(character) ||
+        (character >= 0x80 && [decimalDigits characterIsMember:character])) {
+      return nil;
+    }
+  }
+
+  NSMutableData* key = [NSMutableData dataWithCapacity:((length * 2) + 1)];
+
+  uint8_t prefixByte = letterPrefix ? 0 : 1;
+  [key appendBytes:&prefixByte length:1];
+
+  NSUInteger index = 0;
+  while (index < length) {
+
+    unichar character = chars[index];
+
+    // digit runs are encoded as the '0' code unit, the count of significant digits, then the digits themselves.
+    // runs with more significant digits are larger, and runs of equal length compare digit by digit.
+    // leading zeros are dropped, so runs that only differ by them have equal keys.
+    if (character >= '0' && character <= '9') {
+
+      NSUInteger runStart = index;
+      while (runStart < length && chars[runStart] == '0') {
+        runStart++;
+      }
+
+      NSUInteger runEnd = runStart;
+      while (runEnd < length && chars[runEnd] >= '0' && chars[runEnd] <= '9') {
+        runEnd++;
+      }
+
+      NSUInteger digitCount = MIN(runEnd - runStart, (NSUInteger)UINT32_MAX);
+      uint8_t runHeader[6] = { 0, '0', (uint8_t)(digitCount >> 24), (uint8_t)(digitCount >> 16), (uint8_t)(digitCount >> 8), (uint8_t)(digitCount & 0xFF) };
+      [key appendBytes:runHeader length:6];
+
+      for (NSUInteger digitIndex = runStart; digitIndex < runStart + digitCount; digitIndex++) {
+        uint8_t digit = (uint8_t)chars[digitIndex];
+        [key appendBytes:&digit length:1];
+      }
+
+      index = runEnd;
+    }
+
+    // all other code units are stored big-endian so that byte order matches code unit order
+    else {
+      uint8_t unitBytes[2] = { (uint8_t)(character >> 8), (uint8_t)(character & 0xFF) };
+      [key appendBytes:unitBytes length:2];
+
+      index++;
+    }
+  }
+
+  return key;
+}
+
++ (NSComparisonResult)compareKey:(NSData*)key1 withKey:(NSData*)key2 {
+
+  NSUInteger key1Length = key1.length;
+  NSUInteger key2Length = key2.length;
+
+  int result = memcmp(key1.bytes, key2.bytes, MIN(key1Length, key2Length));
+
+  if (result < 0) {
+    return NSOrderedAscending;
+  }
+  else if (result > 0) {
+    return NSOrderedDescending;
+  }
+
+  // shorter keys are a prefix of the longer key
+  if (key1Length < key2Length) {
+    return NSOrderedAscending;
+  }
+  else if (key1Length > key2Length) {
+    return NSOrderedDescending;
+  }
+  else {
+    return NSOrderedSame;
+  }
+}
+
++ (NSComparisonResult)compareKey:(NSData*)key1 ofString:(NSString*)string1 withKey:(NSData*)key2 ofString:(NSString*)string2 {
+
+  NSComparisonResult result = [CollationKeyCache compareKey:key1 withKey:key2];
+
+  if (result == NSOrderedSame) {
+    return [string1 compare:string2 options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSNumericSearch)];
+  }
+
+  return result;
+}
+
+
+#pragma mark - Mutators
+
+- (void)removeAllKeys {
+
+  @synchronized (_keys) {
+    [_keys removeAllObjects];
+  }
+}
+
+@end
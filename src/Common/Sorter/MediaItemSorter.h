@@ -10,6 +10,9 @@
 
 #import "Defines.h"
 
+@class CollationKeyCache;
+@class LibrarySnapshot;
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface MediaItemSorter : NSObject
@@ -17,6 +20,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nullable, nonatomic, copy) NSString* sortProperty;
 @property (readonly) PlaylistSortOrderType sortOrder;
 
+// When set, string values are compared using cached collation keys instead of `compare:options:`
+@property (nullable) CollationKeyCache* collationKeyCache;
+
 #pragma mark - Initializers
 
 - (instancetype)initWithSortProperty:(nullable NSString*)sortProperty andSortOrder:(PlaylistSortOrderType)sortOrder;
@@ -25,6 +31,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSArray<ITLibMediaItem*>*)sortItems:(NSArray<ITLibMediaItem*>*)items;
 
+// Sorts the given snapshot track indices in place
+- (void)sortTracks:(uint32_t*)tracks count:(NSUInteger)count inSnapshot:(LibrarySnapshot*)snapshot;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -11,19 +11,52 @@
 #import <iTunesLibrary/ITLibArtist.h>
 #import <iTunesLibrary/ITLibMediaItem.h>
 
+#import "CollationKeyCache.h"
+#import "LibrarySnapshot.h"
 #import "Logger.h"
 #import "SorterDefines.h"
 
+// pre-extracted value of a single sort property for a single item
+typedef struct {
+  __unsafe_unretained id value;
+  __unsafe_unretained NSData* collationKey;
+  BOOL isString;
+  BOOL letterPrefix;
+} MediaItemSortValue;
+
+typedef NS_ENUM(NSUInteger, MediaItemSnapshotColumnType) {
+  MediaItemSnapshotColumnTypeString = 0,
+  MediaItemSnapshotColumnTypeInteger,
+  MediaItemSnapshotColumnTypeDate,
+};
+
+// pre-extracted value of a single sort property for a single snapshot track
+typedef struct {
+  __unsafe_unretained NSString* string;
+  __unsafe_unretained NSData* collationKey;
+  double number;
+  BOOL isNil;
+  BOOL isString;
+  BOOL letterPrefix;
+} MediaItemSnapshotSortValue;
+
 @interface MediaItemSorter()
 
 - (instancetype)init;
 
+- (NSArray<NSString*>*)sortKeyProperties;
+
 - (nullable id)valueOfItem:(ITLibMediaItem*)item forProperty:(NSString*)property;
 
-- (NSComparisonResult)compareItem:(ITLibMediaItem*)item1 withItem:(ITLibMediaItem*)item2;
-- (NSComparisonResult)compareProperty:(NSString*)property ofItem:(ITLibMediaItem*)item1 withItem:(ITLibMediaItem*)item2 order:(PlaylistSortOrderType)order;
+- (NSComparisonResult)compareValue:(const MediaItemSortValue*)value1 withValue:(const MediaItemSortValue*)value2 order:(PlaylistSortOrderType)order;
+
+- (NSComparisonResult)alphabeticallyCompareValue:(const MediaItemSortValue*)value1 withValue:(const MediaItemSortValue*)value2;
+
++ (NSDictionary<NSString*, NSArray<NSNumber*>*>*)snapshotColumnsForProperties;
 
-- (NSComparisonResult)alphabeticallyCompareString:(NSString*)str1 withString:(NSString*)str2;
+- (void)getValue:(MediaItemSnapshotSortValue*)value ofTrack:(NSUInteger)track forProperty:(NSString*)property inSnapshot:(LibrarySnapshot*)snapshot;
+
+- (NSComparisonResult)compareSnapshotValue:(const MediaItemSnapshotSortValue*)value1 withValue:(const MediaItemSnapshotSortValue*)value2 order:(PlaylistSortOrderType)order;
 
 @end
 
@@ -43,6 +76,8 @@
     _sortProperty = sortProperty;
     _sortOrder = sortOrder;
 
+    _collationKeyCache = nil;
+
     return self;
   }
   else {
@@ -65,9 +100,140 @@
   }
 
 
-  return [items sortedArrayUsingComparator:^NSComparisonResult(id item1, id item2) {
-    return [self compareItem:item1 withItem:item2];
+  NSArray<NSString*>* keyProperties = [self sortKeyProperties];
+  NSUInteger keyCount = keyProperties.count;
+  NSUInteger itemCount = items.count;
+
+  // extract the sort key tuple of each item once, rather than on every comparison
+  NS_VALID_UNTIL_END_OF_SCOPE NSMutableData* keyData = [NSMutableData dataWithLength:(itemCount * keyCount * sizeof(MediaItemSortValue))];
+  MediaItemSortValue* keys = (MediaItemSortValue*)keyData.mutableBytes;
+
+  // keeps extracted values alive for the duration of the sort
+  NS_VALID_UNTIL_END_OF_SCOPE NSMutableArray* keyValues = [NSMutableArray arrayWithCapacity:(itemCount * keyCount)];
+  NSMutableArray<NSNumber*>* itemIndices = [NSMutableArray arrayWithCapacity:itemCount];
+
+  NSCharacterSet* letterCharacterSet = [NSCharacterSet letterCharacterSet];
+
+  for (NSUInteger itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+
+    ITLibMediaItem* item = items[itemIndex];
+
+    for (NSUInteger keyIndex = 0; keyIndex < keyCount; keyIndex++) {
+
+      id value = [self valueOfItem:item forProperty:keyProperties[keyIndex]];
+      MediaItemSortValue* key = &keys[(itemIndex * keyCount) + keyIndex];
+
+      if (value != nil) {
+        [keyValues addObject:value];
+        key->value = value;
+
+        if ([value isKindOfClass:[NSString class]]) {
+          key->isString = YES;
+          key->letterPrefix = ([value length] > 0 && [letterCharacterSet characterIsMember:[value characterAtIndex:0]]);
+
+          if (_collationKeyCache != nil) {
+            key->collationKey = [_collationKeyCache keyForString:value];
+          }
+        }
+      }
+    }
+
+    [itemIndices addObject:@(itemIndex)];
+  }
+
+  NSArray<NSNumber*>* sortedIndices = [itemIndices sortedArrayUsingComparator:^NSComparisonResult(NSNumber* index1, NSNumber* index2) {
+
+    const MediaItemSortValue* item1Keys = &keys[index1.unsignedIntegerValue * keyCount];
+    const MediaItemSortValue* item2Keys = &keys[index2.unsignedIntegerValue * keyCount];
+
+    NSComparisonResult result = NSOrderedSame;
+
+    // values are identical, attempt to sort by fallback properties (always in ascending order)
+    for (NSUInteger keyIndex = 0; keyIndex < keyCount && result == NSOrderedSame; keyIndex++) {
+      PlaylistSortOrderType order = (keyIndex == 0) ? self->_sortOrder : PlaylistSortOrderAscending;
+      result = [self compareValue:&item1Keys[keyIndex] withValue:&item2Keys[keyIndex] order:order];
+    }
+
+    return result;
   }];
+
+  NSMutableArray<ITLibMediaItem*>* sortedItems = [NSMutableArray arrayWithCapacity:itemCount];
+  for (NSNumber* itemIndex in sortedIndices) {
+    [sortedItems addObject:items[itemIndex.unsignedIntegerValue]];
+  }
+
+  return sortedItems;
+}
+
+- (void)sortTracks:(uint32_t*)tracks count:(NSUInteger)count inSnapshot:(LibrarySnapshot*)snapshot {
+
+  // don't sort if sort property is null
+  if (_sortProperty == nil || count < 2) {
+    return;
+  }
+
+  // default to ascending sort order
+  if (_sortOrder == PlaylistSortOrderNull) {
+    _sortOrder = PlaylistSortOrderAscending;
+  }
+
+  NSArray<NSString*>* keyProperties = [self sortKeyProperties];
+  NSUInteger keyCount = keyProperties.count;
+
+  // keys are extracted per position rather than per track since a playlist may contain a track more than once
+  NS_VALID_UNTIL_END_OF_SCOPE NSMutableData* keyData = [NSMutableData dataWithLength:(count * keyCount * sizeof(MediaItemSnapshotSortValue))];
+  MediaItemSnapshotSortValue* keys = (MediaItemSnapshotSortValue*)keyData.mutableBytes;
+
+  NS_VALID_UNTIL_END_OF_SCOPE NSMutableData* positionData = [NSMutableData dataWithLength:(count * sizeof(uint32_t))];
+  uint32_t* positions = (uint32_t*)positionData.mutableBytes;
+
+  for (NSUInteger position = 0; position < count; position++) {
+
+    for (NSUInteger keyIndex = 0; keyIndex < keyCount; keyIndex++) {
+      [self getValue:&keys[(position * keyCount) + keyIndex] ofTrack:tracks[position] forProperty:keyProperties[keyIndex] inSnapshot:snapshot];
+    }
+
+    positions[position] = (uint32_t)position;
+  }
+
+  // merge sort keeps the relative order of equal tracks, matching `sortItems:`
+  mergesort_b(positions, count, sizeof(uint32_t), ^int(const void* position1, const void* position2) {
+
+    const MediaItemSnapshotSortValue* track1Keys = &keys[(*(const uint32_t*)position1) * keyCount];
+    const MediaItemSnapshotSortValue* track2Keys = &keys[(*(const uint32_t*)position2) * keyCount];
+
+    NSComparisonResult result = NSOrderedSame;
+
+    // values are identical, attempt to sort by fallback properties (always in ascending order)
+    for (NSUInteger keyIndex = 0; keyIndex < keyCount && result == NSOrderedSame; keyIndex++) {
+      PlaylistSortOrderType order = (keyIndex == 0) ? self->_sortOrder : PlaylistSortOrderAscending;
+      result = [self compareSnapshotValue:&track1Keys[keyIndex] withValue:&track2Keys[keyIndex] order:order];
+    }
+
+    return (int)result;
+  });
+
+  NS_VALID_UNTIL_END_OF_SCOPE NSData* unsortedTracks = [NSData dataWithBytes:tracks length:(count * sizeof(uint32_t))];
+  const uint32_t* unsorted = unsortedTracks.bytes;
+
+  for (NSUInteger position = 0; position < count; position++) {
+    tracks[position] = unsorted[positions[position]];
+  }
+}
+
+- (NSArray<NSString*>*)sortKeyProperties {
+
+  NSMutableArray<NSString*>* keyProperties = [NSMutableArray arrayWithObject:_sortProperty];
+
+  for (NSString* fallbackProperty in [SorterDefines fallbackPropertiesForProperty:_sortProperty]) {
+
+    // skip redundant fallback properties (useful when fallbacks are the default list)
+    if (fallbackProperty != _sortProperty) {
+      [keyProperties addObject:fallbackProperty];
+    }
+  }
+
+  return keyProperties;
 }
 
 - (nullable id)valueOfItem:(ITLibMediaItem*)item forProperty:(NSString*)property {
@@ -103,36 +269,157 @@
   return itemValue;
 }
 
-- (NSComparisonResult)compareItem:(ITLibMediaItem*)item1 withItem:(ITLibMediaItem*)item2 {
++ (NSDictionary<NSString*, NSArray<NSNumber*>*>*)snapshotColumnsForProperties {
+
+  static NSDictionary<NSString*, NSArray<NSNumber*>*>* columns;
+  static dispatch_once_t onceToken;
+
+  dispatch_once(&onceToken, ^{
+    columns = @{
+      ITLibMediaItemPropertyTitle: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringTitle)],
+      ITLibMediaItemPropertySortTitle: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringSortTitle)],
+      ITLibMediaItemPropertyArtistName: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringArtist)],
+      ITLibMediaItemPropertySortArtistName: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringSortArtist)],
+      ITLibMediaItemPropertyAlbumArtist: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringAlbumArtist)],
+      ITLibMediaItemPropertySortAlbumArtist: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringSortAlbumArtist)],
+      ITLibMediaItemPropertyAlbumTitle: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringAlbum)],
+      ITLibMediaItemPropertySortAlbumTitle: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringSortAlbum)],
+      ITLibMediaItemPropertyComposer: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringComposer)],
+      ITLibMediaItemPropertySortComposer: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringSortComposer)],
+      ITLibMediaItemPropertyGrouping: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringGrouping)],
+      ITLibMediaItemPropertyGenre: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringGenre)],
+      ITLibMediaItemPropertyKind: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringKind)],
+      ITLibMediaItemPropertyComments: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringComments)],
+      ITLibMediaItemPropertyCategory: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringCategory)],
+      ITLibMediaItemPropertyDescription: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringDescription)],
+      ITLibMediaItemPropertyMovementName: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringMovementName)],
+      ITLibMediaItemPropertyWork: @[@(MediaItemSnapshotColumnTypeString), @(LibrarySnapshotStringWork)],
+
+      ITLibMediaItemPropertySize: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerFileSize)],
+      ITLibMediaItemPropertyTotalTime: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerTotalTime)],
+      ITLibMediaItemPropertyAlbumDiscNumber: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerDiscNumber)],
+      ITLibMediaItemPropertyTrackNumber: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerTrackNumber)],
+      ITLibMediaItemPropertyYear: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerYear)],
+      ITLibMediaItemPropertyBeatsPerMinute: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerBeatsPerMinute)],
+      ITLibMediaItemPropertyBitRate: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerBitRate)],
+      ITLibMediaItemPropertySampleRate: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerSampleRate)],
+      ITLibMediaItemPropertyRating: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerRating)],
+      ITLibMediaItemPropertyAlbumRating: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerAlbumRating)],
+      ITLibMediaItemPropertyPlayCount: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerPlayCount)],
+      ITLibMediaItemPropertyUserSkipCount: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerSkipCount)],
+      ITLibMediaItemPropertyMovementNumber: @[@(MediaItemSnapshotColumnTypeInteger), @(LibrarySnapshotIntegerMovementNumber)],
+
+      ITLibMediaItemPropertyModifiedDate: @[@(MediaItemSnapshotColumnTypeDate), @(LibrarySnapshotDateModified)],
+      ITLibMediaItemPropertyAddedDate: @[@(MediaItemSnapshotColumnTypeDate), @(LibrarySnapshotDateAdded)],
+      ITLibMediaItemPropertyLastPlayDate: @[@(MediaItemSnapshotColumnTypeDate), @(LibrarySnapshotDateLastPlayed)],
+      ITLibMediaItemPropertySkipDate: @[@(MediaItemSnapshotColumnTypeDate), @(LibrarySnapshotDateSkipped)],
+      ITLibMediaItemPropertyReleaseDate: @[@(MediaItemSnapshotColumnTypeDate), @(LibrarySnapshotDateReleased)],
+    };
+  });
+
+  return columns;
+}
 
-  NSComparisonResult result = [self compareProperty:_sortProperty ofItem:item1 withItem:item2 order:_sortOrder];
+- (void)getValue:(MediaItemSnapshotSortValue*)value ofTrack:(NSUInteger)track forProperty:(NSString*)property inSnapshot:(LibrarySnapshot*)snapshot {
 
-  // values are identical, attempt to sort by fallback properties
-  if (result == NSOrderedSame) {
+  NSDictionary<NSString*, NSArray<NSNumber*>*>* snapshotColumns = [MediaItemSorter snapshotColumnsForProperties];
 
-    for (NSString* fallbackProperty in [SorterDefines fallbackPropertiesForProperty:_sortProperty]) {
+  value->isNil = YES;
 
-      // skip redundant fallback properties (useful when fallbacks are the default list)
-      if (fallbackProperty != _sortProperty) {
-        // use ascending order for fallback properties
-        result = [self compareProperty:fallbackProperty ofItem:item1 withItem:item2 order:PlaylistSortOrderAscending];
+  // if substitutions exist for the property, use the first non-empty value
+  NSArray<NSString*>* properties = [SorterDefines substitutionsForProperty:property];
+  if (properties.count == 0) {
+    properties = @[property];
+  }
+
+  for (NSString* valueProperty in properties) {
+
+    NSArray<NSNumber*>* columnInfo = [snapshotColumns objectForKey:valueProperty];
+    if (columnInfo == nil) {
+      continue;
+    }
+
+    NSUInteger column = columnInfo[1].unsignedIntegerValue;
+
+    switch (columnInfo[0].unsignedIntegerValue) {
+
+      case MediaItemSnapshotColumnTypeString: {
+        NSString* string = [snapshot stringForColumn:column ofTrack:track];
+        if (string != nil) {
+          value->isNil = NO;
+          value->isString = YES;
+          value->string = string;
+          value->letterPrefix = (string.length > 0 && [[NSCharacterSet letterCharacterSet] characterIsMember:[string characterAtIndex:0]]);
 
-        // use first result that is not equal
-        if (result != NSOrderedSame) {
-  //        MLE_Log_Info(@"MediaItemSorter [compareItem] used fallback %@ for property %@ ('%@ - %@', '%@ - %@')", fallbackProperty, _sortProperty, item1.album.albumArtist, item1.title, item2.album.albumArtist, item2.title);
-          break;
+          if (_collationKeyCache != nil) {
+            value->collationKey = [_collationKeyCache keyForString:string];
+          }
         }
+        break;
+      }
+      case MediaItemSnapshotColumnTypeInteger: {
+        value->isNil = NO;
+        value->number = (double)[snapshot integerForColumn:column ofTrack:track];
+        break;
+      }
+      case MediaItemSnapshotColumnTypeDate: {
+        NSTimeInterval timeInterval = [snapshot timeIntervalForColumn:column ofTrack:track];
+        if (!isnan(timeInterval)) {
+          value->isNil = NO;
+          value->number = timeInterval;
+        }
+        break;
       }
     }
+
+    // return first non-empty value
+    if (!value->isNil) {
+      return;
+    }
+  }
+}
+
+- (NSComparisonResult)compareSnapshotValue:(const MediaItemSnapshotSortValue*)value1 withValue:(const MediaItemSnapshotSortValue*)value2 order:(PlaylistSortOrderType)order {
+
+  // handle nil values - mirrors `compareValue:`, where two nil values are never considered equal
+  if (value1->isNil) {
+    return NSOrderedDescending;
+  }
+  else if (value2->isNil) {
+    return NSOrderedAscending;
+  }
+
+  NSComparisonResult result;
+  if (value1->isString) {
+    if (value1->collationKey != nil && value2->collationKey != nil) {
+      result = [CollationKeyCache compareKey:value1->collationKey ofString:value1->string withKey:value2->collationKey ofString:value2->string];
+    }
+    else if (value1->letterPrefix != value2->letterPrefix) {
+      result = value1->letterPrefix ? NSOrderedAscending : NSOrderedDescending;
+    }
+    else {
+      result = [value1->string compare:value2->string options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSNumericSearch)];
+    }
+  }
+  else if (value1->number != value2->number) {
+    result = (value1->number < value2->number) ? NSOrderedAscending : NSOrderedDescending;
+  }
+  else {
+    result = NSOrderedSame;
   }
 
-  return result;
+  if (order == PlaylistSortOrderAscending) {
+    return result;
+  }
+  else {
+    return -result;
+  }
 }
 
-- (NSComparisonResult)compareProperty:(NSString*)property ofItem:(ITLibMediaItem*)item1 withItem:(ITLibMediaItem*)item2 order:(PlaylistSortOrderType)order {
+- (NSComparisonResult)compareValue:(const MediaItemSortValue*)value1 withValue:(const MediaItemSortValue*)value2 order:(PlaylistSortOrderType)order {
 
-  id item1Value = [self valueOfItem:item1 forProperty:property];
-  id item2Value = [self valueOfItem:item2 forProperty:property];
+  id item1Value = value1->value;
+  id item2Value = value2->value;
 
   // handle nil values
   if (item1Value == nil || item2Value == nil) {
@@ -148,8 +435,8 @@
   }
 
   NSComparisonResult result;
-  if (item1Value && [item1Value isKindOfClass:[NSString class]]) {
-    result = [self alphabeticallyCompareString:item1Value withString:item2Value];
+  if (value1->isString) {
+    result = [self alphabeticallyCompareValue:value1 withValue:value2];
   }
   else {
     result = [item1Value compare:item2Value];
@@ -163,15 +450,21 @@
   }
 }
 
-- (NSComparisonResult)alphabeticallyCompareString:(NSString*)str1 withString:(NSString*)str2 {
+- (NSComparisonResult)alphabeticallyCompareValue:(const MediaItemSortValue*)value1 withValue:(const MediaItemSortValue*)value2 {
+
+  // collation keys already encode the letter-prefix rule
+  if (value1->collationKey != nil && value2->collationKey != nil) {
+    return [CollationKeyCache compareKey:value1->collationKey ofString:value1->value withKey:value2->collationKey ofString:value2->value];
+  }
 
   // sort so that strings that begin with letters come before non-letter strings (begin with digit, special char, etc)
-  BOOL str1LetterPrefix = [[NSCharacterSet letterCharacterSet] characterIsMember:[str1 characterAtIndex:0]];
-  BOOL str2LetterPrefix = [[NSCharacterSet letterCharacterSet] characterIsMember:[str2 characterAtIndex:0]];
-  if (str1LetterPrefix != str2LetterPrefix) {
-    return str1LetterPrefix ? NSOrderedAscending : NSOrderedDescending;
+  if (value1->letterPrefix != value2->letterPrefix) {
+    return value1->letterPrefix ? NSOrderedAscending : NSOrderedDescending;
   }
 
+  NSString* str1 = value1->value;
+  NSString* str2 = value2->value;
+
   return [str1 compare:str2 options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSNumericSearch)];
 }
 
@@ -15,6 +15,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (nullable NSString*)hexStringForPersistentId:(nullable NSNumber*)persistentId;
 
+// Inverse of hexStringForPersistentId, returns 0 for nil or malformed strings
++ (uint64_t)persistentIdForHexString:(nullable NSString*)hexString;
+
 + (PlaylistSortOrderType)playlistSortOrderForTitle:(nullable NSString*)title;
 
 @end
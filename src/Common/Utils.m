@@ -23,6 +23,23 @@
   return [NSString stringWithFormat:@"%016llX", persistentId.unsignedLongLongValue];
 }
 
++ (uint64_t)persistentIdForHexString:(nullable NSString*)hexString {
+
+  if (hexString == nil || hexString.length == 0) {
+    return 0;
+  }
+
+  const char* hexChars = hexString.UTF8String;
+  char* end = NULL;
+  uint64_t persistentId = strtoull(hexChars, &end, 16);
+
+  if (end == NULL || *end != '\0') {
+    return 0;
+  }
+
+  return persistentId;
+}
+
 + (PlaylistSortOrderType)playlistSortOrderForTitle:(nullable NSString*)title {
 
   if (title == nil) {
@@ -0,0 +1,164 @@
+//
+//  BatchExportManagerTests.m
+//  Music Library Exporter Helper Tests
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "BatchExportManager.h"
+#import "ExportConfiguration.h"
+#import "ExportManager.h"
+#import "ExportManagerDelegate.h"
+#import "LibrarySnapshot.h"
+#import "SyntheticLibraryGenerator.h"
+
+static NSString* const BatchExportManagerTestsPreviousOutput = @"previous export";
+
+// Cancels the batch as soon as its target starts serializing tracks
+@interface BatchCancellingDelegate : NSObject<ExportManagerDelegate>
+
+@property (weak) BatchExportManager* batchExportManager;
+
+@end
+
+@implementation BatchCancellingDelegate
+
+- (void)exportStateChangedFrom:(ExportState)oldState toState:(ExportState)newState {
+
+  if (newState == ExportGeneratingTracks) {
+    [_batchExportManager cancel];
+  }
+}
+
+@end
+
+
+@interface BatchExportManagerTests : XCTestCase
+
+@end
+
+@implementation BatchExportManagerTests {
+
+  NSURL* _directoryURL;
+  LibrarySnapshot* _snapshot;
+
+  BatchExportManager* _batchExportManager;
+  NSArray<NSURL*>* _outputFileURLs;
+}
+
+- (void)setUp {
+
+  _directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:NSUUID.UUID.UUIDString isDirectory:YES];
+  XCTAssertTrue([[NSFileManager defaultManager] createDirectoryAtURL:_directoryURL withIntermediateDirectories:YES attributes:nil error:nil]);
+
+  SyntheticLibraryGenerator* generator = [[SyntheticLibraryGenerator alloc] init];
+  XCTAssertTrue([generator applySpecifier:@"tracks=500,playlists=20" error:nil]);
+
+  NSURL* libraryURL = [_directoryURL URLByAppendingPathComponent:@"Fixture.xml"];
+  XCTAssertTrue([generator writeLibraryToURL:libraryURL error:nil]);
+
+  _snapshot = [LibrarySnapshot snapshotWithContentsOfURL:libraryURL error:nil];
+  XCTAssertNotNil(_snapshot);
+
+  _batchExportManager = [[BatchExportManager alloc] init];
+
+  NSMutableArray<NSURL*>* outputFileURLs = [NSMutableArray array];
+  for (NSUInteger targetIndex = 0; targetIndex < 3; targetIndex++) {
+
+    NSString* outputFileName = [NSString stringWithFormat:@"Library-%lu.xml", targetIndex];
+    NSURL* outputFileURL = [_directoryURL URLByAppendingPathComponent:outputFileName];
+
+    ExportConfiguration* configuration = [[ExportConfiguration alloc] init];
+    [configuration setGeneratedPersistentLibraryId:[ExportConfiguration generatePersistentLibraryId]];
+    [configuration setMusicLibraryPath:@"/Users/Shared/Music/Media/"];
+    [configuration setOutputDirectoryUrl:_directoryURL];
+    [configuration setOutputFileName:outputFileName];
+
+    ExportManager* target = [[ExportManager alloc] initWithConfiguration:configuration];
+    [target setOutputFileURL:outputFileURL];
+    [_batchExportManager addTarget:target];
+
+    [outputFileURLs addObject:outputFileURL];
+  }
+  _outputFileURLs = outputFileURLs;
+}
+
+- (void)tearDown {
+
+  [[NSFileManager defaultManager] removeItemAtURL:_directoryURL error:nil];
+}
+
+- (void)writePreviousOutput {
+
+  for (NSURL* outputFileURL in _outputFileURLs) {
+    XCTAssertTrue([BatchExportManagerTestsPreviousOutput writeToURL:outputFileURL atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+  }
+}
+
+- (BOOL)isPreviousOutputAtURL:(NSURL*)outputFileURL {
+
+  NSString* contents = [NSString stringWithContentsOfURL:outputFileURL encoding:NSUTF8StringEncoding error:nil];
+
+  return [contents isEqualToString:BatchExportManagerTestsPreviousOutput];
+}
+
+- (void)testExportWritesEveryTarget {
+
+  NSError* exportError;
+  XCTAssertTrue([_batchExportManager exportSnapshot:_snapshot withError:&exportError], @"%@", exportError);
+
+  for (NSURL* outputFileURL in _outputFileURLs) {
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:outputFileURL.path]);
+  }
+}
+
+- (void)testCancelBeforeExportSkipsEveryTarget {
+
+  [self writePreviousOutput];
+
+  [_batchExportManager cancel];
+
+  NSError* exportError;
+  XCTAssertFalse([_batchExportManager exportSnapshot:_snapshot withError:&exportError]);
+  XCTAssertEqualObjects(exportError.domain, __MLE_ErrorDomain_BatchExportManager);
+  XCTAssertEqual(exportError.code, (NSInteger)BatchExportManagerErrorCancelled);
+
+  for (NSURL* outputFileURL in _outputFileURLs) {
+    XCTAssertTrue([self isPreviousOutputAtURL:outputFileURL], @"output replaced: %@", outputFileURL.lastPathComponent);
+  }
+}
+
+- (void)testCancelIsNotClearedWhenTargetStarts {
+
+  [self writePreviousOutput];
+
+  // a cancel sent to a target before it starts must survive exportSnapshot:
+  ExportManager* target = _batchExportManager.targets.firstObject;
+  [target cancel];
+
+  NSError* exportError;
+  XCTAssertFalse([target exportSnapshot:_snapshot withError:&exportError]);
+  XCTAssertEqual(exportError.code, (NSInteger)ExportManagerErrorCancelled);
+  XCTAssertTrue([self isPreviousOutputAtURL:_outputFileURLs.firstObject]);
+}
+
+- (void)testCancelDuringExportKeepsExistingOutput {
+
+  [self writePreviousOutput];
+
+  BatchCancellingDelegate* delegate = [[BatchCancellingDelegate alloc] init];
+  [delegate setBatchExportManager:_batchExportManager];
+  [_batchExportManager.targets.firstObject setDelegate:delegate];
+
+  NSError* exportError;
+  XCTAssertFalse([_batchExportManager exportSnapshot:_snapshot withError:&exportError]);
+  XCTAssertEqual(exportError.code, (NSInteger)BatchExportManagerErrorCancelled);
+  XCTAssertTrue(_batchExportManager.isCancelled);
+
+  // the cancelling target was running, so it stopped before its output was moved into place
+  XCTAssertTrue([self isPreviousOutputAtURL:_outputFileURLs.firstObject]);
+}
+
+@end
@@ -0,0 +1,138 @@
+//
+//  CollationKeyCacheTests.m
+//  Music Library Exporter Helper Tests
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "CollationKeyCache.h"
+
+@interface CollationKeyCacheTests : XCTestCase
+
+@end
+
+@implementation CollationKeyCacheTests
+
+// the order MediaItemSorter used before collation keys
+- (NSComparisonResult)expectedCompareString:(NSString*)string1 withString:(NSString*)string2 {
+
+  NSCharacterSet* letters = [NSCharacterSet letterCharacterSet];
+  BOOL letterPrefix1 = (string1.length > 0 && [letters characterIsMember:[string1 characterAtIndex:0]]);
+  BOOL letterPrefix2 = (string2.length > 0 && [letters characterIsMember:[string2 characterAtIndex:0]]);
+
+  if (letterPrefix1 != letterPrefix2) {
+    return letterPrefix1 ? NSOrderedAscending : NSOrderedDescending;
+  }
+
+  return [string1 compare:string2 options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSNumericSearch)];
+}
+
+- (NSArray<NSString*>*)adversarialStrings {
+
+  return @[
+    // leading zeros
+    @"Track 1", @"Track 01", @"Track 001", @"Track 2", @"Track 10", @"Track 010", @"Track 9", @"track 1", @"TRACK 1",
+    @"1", @"01", @"001", @"0", @"00", @"10", @"010",
+    // precomposed + decomposed accents
+    @"Beyonc\u00E9", @"Beyonce\u0301", @"Beyonce", @"beyonce", @"BEYONC\u00C9", @"BEYONCE\u0301", @"Beyoncf", @"Beyonc\u00E9 2", @"Beyonce\u0301 10",
+    @"Zo\u00EB", @"Zoe\u0308", @"Zoe", @"\u00C5ngstr\u00F6m", @"A\u030Angstro\u0308m", @"Angstrom",
+    // punctuation next to digits
+    @"A-1", @"A 1", @"A1", @"A.1", @"A/1", @"A:1", @"A_1", @"A~1", @"A1-", @"A1.5", @"A1a", @"A-", @"A", @"Aa", @"A10", @"A1:",
+    @"1a", @"1-", @"-1", @"!", @"#1", @"(1)", @"[1]", @"1 ", @" 1",
+    // long digit runs
+    @"99999999999999999999", @"100000000000000000000", @"099999999999999999999",
+    @"1234567890123456789012345678901234567890", @"1234567890123456789012345678901234567891",
+    @"Disc 12345678901234567890 Track 1", @"Disc 12345678901234567890 Track 2",
+    // characters outside the BMP
+    @"\U0001F3B5 Track", @"Track \U0001F3B5", @"Track \U0001F3B6", @"Track \uFF01", @"Track \uFFFD", @"\U0001D400 Bold",
+    // other digits
+    @"\uFF11 Track", @"Track \u0661", @"Track \u0662",
+    @"", @"a b", @"ab",
+  ];
+}
+
+- (void)testKeysOrderLikeCompareOptions {
+
+  NSArray<NSString*>* strings = [self adversarialStrings];
+
+  for (NSString* string1 in strings) {
+
+    NSData* key1 = [CollationKeyCache generateKeyForString:string1];
+
+    for (NSString* string2 in strings) {
+
+      NSData* key2 = [CollationKeyCache generateKeyForString:string2];
+      if (key1 == nil || key2 == nil) {
+        continue;
+      }
+
+      NSComparisonResult expected = [self expectedCompareString:string1 withString:string2];
+
+      // keys alone may only tie where compare:options: decides
+      NSComparisonResult keyResult = [CollationKeyCache compareKey:key1 withKey:key2];
+      if (keyResult != NSOrderedSame) {
+        XCTAssertEqual((NSInteger)keyResult, (NSInteger)expected, @"'%@' vs '%@'", string1, string2);
+      }
+
+      NSComparisonResult result = [CollationKeyCache compareKey:key1 ofString:string1 withKey:key2 ofString:string2];
+      XCTAssertEqual((NSInteger)result, (NSInteger)expected, @"'%@' vs '%@'", string1, string2);
+    }
+  }
+}
+
+- (void)testSortingByKeysMatchesCompareOptions {
+
+  CollationKeyCache* cache = [[CollationKeyCache alloc] init];
+
+  NSArray<NSString*>* strings = [self adversarialStrings];
+
+  NSArray<NSString*>* expected = [strings sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSString* string1, NSString* string2) {
+    return [self expectedCompareString:string1 withString:string2];
+  }];
+
+  // mirrors MediaItemSorter, strings without a key are compared directly
+  NSArray<NSString*>* sorted = [strings sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSString* string1, NSString* string2) {
+    NSData* key1 = [cache keyForString:string1];
+    NSData* key2 = [cache keyForString:string2];
+    if (key1 != nil && key2 != nil) {
+      return [CollationKeyCache compareKey:key1 ofString:string1 withKey:key2 ofString:string2];
+    }
+    return [self expectedCompareString:string1 withString:string2];
+  }];
+
+  XCTAssertEqualObjects(sorted, expected);
+}
+
+- (void)testLeadingZerosFallBackToCompareOptions {
+
+  NSData* key1 = [CollationKeyCache generateKeyForString:@"Track 01"];
+  NSData* key2 = [CollationKeyCache generateKeyForString:@"Track 1"];
+
+  XCTAssertEqualObjects(key1, key2);
+  XCTAssertEqual((NSInteger)[CollationKeyCache compareKey:key1 ofString:@"Track 01" withKey:key2 ofString:@"Track 1"],
+                 (NSInteger)[@"Track 01" compare:@"Track 1" options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSNumericSearch)]);
+}
+
+- (void)testAccentFormsHaveEqualKeys {
+
+  XCTAssertEqualObjects([CollationKeyCache generateKeyForString:@"Beyonc\u00E9"], [CollationKeyCache generateKeyForString:@"Beyonce\u0301"]);
+}
+
+- (void)testStringsWithoutExactKeysAreNotCached {
+
+  CollationKeyCache* cache = [[CollationKeyCache alloc] init];
+
+  XCTAssertNil([CollationKeyCache generateKeyForString:@"Track \U0001F3B5"]);
+  XCTAssertNil([CollationKeyCache generateKeyForString:@"Track \u0661"]);
+
+  // the missing key is remembered
+  XCTAssertNil([cache keyForString:@"Track \U0001F3B5"]);
+  XCTAssertNil([cache keyForString:@"Track \U0001F3B5"]);
+  XCTAssertEqual(cache.count, (NSUInteger)1);
+
+  XCTAssertNotNil([cache keyForString:@"Track 1"]);
+}
+
+@end
@@ -0,0 +1,110 @@
+//
+//  FSEventsFileWatcherTests.m
+//  Music Library Exporter Helper Tests
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "FSEventsFileWatcher.h"
+#import "LibraryChangeMonitor.h"
+
+// FSEvents delivers events asynchronously, this is long enough on a loaded CI machine
+static NSTimeInterval const FSEventsFileWatcherTestsTimeout = 10;
+
+@interface FSEventsFileWatcherTests : XCTestCase
+
+@end
+
+@implementation FSEventsFileWatcherTests {
+
+  NSURL* _directoryURL;
+  FSEventsFileWatcher* _watcher;
+}
+
+- (void)setUp {
+
+  // FSEvents reports real paths, /var is a symlink to /private/var
+  NSURL* temporaryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByResolvingSymlinksInPath];
+  _directoryURL = [temporaryURL URLByAppendingPathComponent:NSUUID.UUID.UUIDString isDirectory:YES];
+  XCTAssertTrue([NSFileManager.defaultManager createDirectoryAtURL:_directoryURL withIntermediateDirectories:YES attributes:nil error:nil]);
+
+  _watcher = [[FSEventsFileWatcher alloc] init];
+  [_watcher setLatency:0.05];
+}
+
+- (void)tearDown {
+
+  [_watcher stopWatching];
+
+  [NSFileManager.defaultManager removeItemAtURL:_directoryURL error:nil];
+}
+
+- (void)waitFor:(NSTimeInterval)interval {
+
+  [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:interval]];
+}
+
+- (void)writeFileNamed:(NSString*)name {
+
+  NSData* data = [NSUUID.UUID.UUIDString dataUsingEncoding:NSUTF8StringEncoding];
+  XCTAssertTrue([data writeToURL:[_directoryURL URLByAppendingPathComponent:name] atomically:NO]);
+}
+
+- (void)testWritingFileCallsHandler {
+
+  XCTestExpectation* changeReported = [self expectationWithDescription:@"change reported"];
+  [changeReported setAssertForOverFulfill:NO];
+
+  NSError* error;
+  XCTAssertTrue([_watcher startWatchingPaths:@[ _directoryURL.path ] queue:dispatch_get_main_queue() handler:^{
+    [changeReported fulfill];
+  } error:&error], @"%@", error);
+  XCTAssertTrue(_watcher.isWatching);
+
+  [self writeFileNamed:@"Music Library.musiclibrary"];
+
+  [self waitForExpectations:@[ changeReported ] timeout:FSEventsFileWatcherTestsTimeout];
+}
+
+- (void)testStopWatchingStopsDelivery {
+
+  __block NSUInteger handlerCallCount = 0;
+
+  XCTAssertTrue([_watcher startWatchingPaths:@[ _directoryURL.path ] queue:dispatch_get_main_queue() handler:^{
+    handlerCallCount++;
+  } error:nil]);
+
+  [_watcher stopWatching];
+  XCTAssertFalse(_watcher.isWatching);
+
+  [self writeFileNamed:@"Music Library.musiclibrary"];
+  [self waitFor:1];
+
+  XCTAssertEqual(handlerCallCount, (NSUInteger)0);
+}
+
+- (void)testLibraryChangeMonitorReportsWrittenFile {
+
+  LibraryChangeMonitor* monitor = [[LibraryChangeMonitor alloc] initWithWatcher:_watcher quietPeriod:0.2];
+
+  XCTestExpectation* changeReported = [self expectationWithDescription:@"change reported"];
+  [changeReported setAssertForOverFulfill:NO];
+  [monitor setChangeHandler:^{
+    [changeReported fulfill];
+  }];
+
+  XCTAssertTrue([monitor startMonitoringPath:_directoryURL.path error:nil]);
+
+  // reported once the writes have settled for the quiet period
+  for (NSUInteger file = 0; file < 5; file++) {
+    [self writeFileNamed:[NSString stringWithFormat:@"Track %lu", file]];
+  }
+
+  [self waitForExpectations:@[ changeReported ] timeout:FSEventsFileWatcherTestsTimeout];
+
+  [monitor stopMonitoring];
+}
+
+@end
@@ -0,0 +1,172 @@
+//
+//  LibraryChangeMonitorTests.m
+//  Music Library Exporter Helper Tests
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "FileWatcher.h"
+#import "LibraryChangeMonitor.h"
+
+static NSTimeInterval const LibraryChangeMonitorTestsQuietPeriod = 0.2;
+
+// Reports changes on demand instead of watching the file system
+@interface FakeFileWatcher : NSObject<FileWatcher>
+
+@property (readonly) NSArray<NSString*>* watchedPaths;
+
+- (void)emitChange;
+
+@end
+
+@implementation FakeFileWatcher {
+
+  dispatch_queue_t _queue;
+  FileWatcherHandler _handler;
+}
+
+- (BOOL)startWatchingPaths:(NSArray<NSString*>*)paths queue:(dispatch_queue_t)queue handler:(FileWatcherHandler)handler error:(NSError**)error {
+
+  _watchedPaths = [paths copy];
+  _queue = queue;
+  _handler = handler;
+
+  return YES;
+}
+
+- (void)stopWatching {
+
+  _queue = nil;
+  _handler = nil;
+}
+
+- (BOOL)isWatching {
+
+  return _handler != nil;
+}
+
+- (void)emitChange {
+
+  FileWatcherHandler handler = _handler;
+  if (handler != nil) {
+    dispatch_async(_queue, handler);
+  }
+}
+
+@end
+
+
+@interface LibraryChangeMonitorTests : XCTestCase
+
+@end
+
+@implementation LibraryChangeMonitorTests {
+
+  NSURL* _libraryURL;
+
+  FakeFileWatcher* _watcher;
+  LibraryChangeMonitor* _monitor;
+
+  NSUInteger _handlerCallCount;
+  NSDate* _handlerCalledAt;
+}
+
+- (void)setUp {
+
+  // the monitor only watches a library that exists
+  NSURL* directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:NSUUID.UUID.UUIDString isDirectory:YES];
+  _libraryURL = [directoryURL URLByAppendingPathComponent:@"Music Library.musiclibrary" isDirectory:YES];
+  XCTAssertTrue([NSFileManager.defaultManager createDirectoryAtURL:_libraryURL withIntermediateDirectories:YES attributes:nil error:nil]);
+
+  _watcher = [[FakeFileWatcher alloc] init];
+  _monitor = [[LibraryChangeMonitor alloc] initWithWatcher:_watcher quietPeriod:LibraryChangeMonitorTestsQuietPeriod];
+
+  _handlerCallCount = 0;
+  _handlerCalledAt = nil;
+
+  __weak LibraryChangeMonitorTests* weakSelf = self;
+  [_monitor setChangeHandler:^{
+    LibraryChangeMonitorTests* strongSelf = weakSelf;
+    strongSelf->_handlerCallCount++;
+    strongSelf->_handlerCalledAt = [NSDate date];
+  }];
+
+  XCTAssertTrue([_monitor startMonitoringPath:_libraryURL.path error:nil]);
+}
+
+- (void)tearDown {
+
+  [_monitor stopMonitoring];
+
+  [NSFileManager.defaultManager removeItemAtURL:_libraryURL.URLByDeletingLastPathComponent error:nil];
+}
+
+- (void)waitFor:(NSTimeInterval)interval {
+
+  [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:interval]];
+}
+
+- (void)testStartMonitoringWatchesPath {
+
+  XCTAssertTrue(_monitor.isMonitoring);
+  XCTAssertEqualObjects(_watcher.watchedPaths, @[ _libraryURL.path ]);
+}
+
+- (void)testStartMonitoringMissingLibraryFails {
+
+  [_monitor stopMonitoring];
+
+  NSString* missingPath = [_libraryURL.URLByDeletingLastPathComponent URLByAppendingPathComponent:@"Missing.musiclibrary"].path;
+
+  NSError* error;
+  XCTAssertFalse([_monitor startMonitoringPath:missingPath error:&error]);
+  XCTAssertEqualObjects(error.domain, __MLE_ErrorDomain_LibraryChangeMonitor);
+  XCTAssertEqual(error.code, (NSInteger)LibraryChangeMonitorErrorLibraryNotFound);
+  XCTAssertFalse(_monitor.isMonitoring);
+}
+
+- (void)testBurstOfChangesCallsHandlerOnceAfterQuietPeriod {
+
+  // changes arrive closer together than the quiet period
+  NSUInteger burstLength = 5;
+  NSTimeInterval spacing = LibraryChangeMonitorTestsQuietPeriod / 4;
+
+  for (NSUInteger change = 0; change < burstLength; change++) {
+    [_watcher emitChange];
+    [self waitFor:spacing];
+    XCTAssertEqual(_handlerCallCount, (NSUInteger)0, @"handler called during the burst");
+  }
+  NSDate* lastChangeAt = [NSDate date];
+
+  [self waitFor:(LibraryChangeMonitorTestsQuietPeriod * 3)];
+
+  XCTAssertEqual(_handlerCallCount, (NSUInteger)1);
+  XCTAssertGreaterThanOrEqual([_handlerCalledAt timeIntervalSinceDate:lastChangeAt], LibraryChangeMonitorTestsQuietPeriod - spacing);
+}
+
+- (void)testSeparateBurstsCallHandlerForEach {
+
+  [_watcher emitChange];
+  [self waitFor:(LibraryChangeMonitorTestsQuietPeriod * 2)];
+  XCTAssertEqual(_handlerCallCount, (NSUInteger)1);
+
+  [_watcher emitChange];
+  [self waitFor:(LibraryChangeMonitorTestsQuietPeriod * 2)];
+  XCTAssertEqual(_handlerCallCount, (NSUInteger)2);
+}
+
+- (void)testStopMonitoringDropsPendingChange {
+
+  [_watcher emitChange];
+  [self waitFor:(LibraryChangeMonitorTestsQuietPeriod / 4)];
+
+  [_monitor stopMonitoring];
+  XCTAssertFalse(_monitor.isMonitoring);
+
+  [self waitFor:(LibraryChangeMonitorTestsQuietPeriod * 2)];
+  XCTAssertEqual(_handlerCallCount, (NSUInteger)0);
+}
+
+@end
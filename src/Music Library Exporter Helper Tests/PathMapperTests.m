@@ -0,0 +1,202 @@
+//
+//  PathMapperTests.m
+//  Music Library Exporter Helper Tests
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "PathMapper.h"
+
+@interface PathMapperTests : XCTestCase
+
+@end
+
+@implementation PathMapperTests {
+
+  PathMapper* _pathMapper;
+}
+
+- (void)setUp {
+
+  _pathMapper = [[PathMapper alloc] init];
+}
+
+// the URL string exports used before PathMapper encoded paths itself
+- (NSString*)expectedURLForPath:(NSString*)path {
+
+  NSURL* url = [NSURL fileURLWithPath:path isDirectory:NO relativeToURL:[NSURL fileURLWithPath:@"/" isDirectory:YES]];
+
+  return url.absoluteString;
+}
+
+- (void)assertMapsLikeNSURL:(NSString*)path {
+
+  NSString* expectedURL = [self expectedURLForPath:path];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:path], expectedURL, @"path: %@", path);
+
+  // the second lookup reuses the cached directory prefix
+  XCTAssertEqualObjects([_pathMapper mapFilePath:path], expectedURL, @"path (cached): %@", path);
+}
+
+- (void)testEveryASCIICharacterIsEncodedLikeNSURL {
+
+  for (unichar character = 0x20; character < 0x7F; character++) {
+
+    NSString* name = [NSString stringWithFormat:@"a%Cb", character];
+
+    [self assertMapsLikeNSURL:[NSString stringWithFormat:@"/Music/%@/track.mp3", name]];
+    [self assertMapsLikeNSURL:[NSString stringWithFormat:@"/Music/Album/%@.mp3", name]];
+  }
+}
+
+- (void)testReservedCharactersAreEncodedLikeNSURL {
+
+  NSArray<NSString*>* paths = @[
+    @"/Music/Artist; Other/Album/01 Track.mp3",
+    @"/Music/Artist/Album?/01 Track #1.mp3",
+    @"/Music/Artist/100% Album/[Live] Track.m4a",
+    @"/Music/Artist/Album/Track; Part 1 ? # % [ ].mp3",
+    @"/Music/AC+DC/Back & Forth (Remastered)/It's = @ $1!.mp3",
+  ];
+
+  for (NSString* path in paths) {
+    [self assertMapsLikeNSURL:path];
+  }
+}
+
+- (void)testNonASCIICharactersAreEncodedLikeNSURL {
+
+  NSArray<NSString*>* paths = @[
+    @"/Music/Beyonc\u00E9/Album/01 Track.mp3",
+    @"/Music/Beyonce\u0301/Album/01 Track.mp3",
+    @"/Music/坂本九/上を向いて歩こう.mp3",
+    @"/Music/Artist/Album/\U0001F3B5 Track.mp3",
+  ];
+
+  for (NSString* path in paths) {
+    [self assertMapsLikeNSURL:path];
+  }
+}
+
+- (void)testConcurrentMappingMatchesNSURL {
+
+  // tracks of the same directory are spread out so that workers race to insert each directory
+  NSUInteger directoryCount = 2000;
+  NSUInteger tracksPerDirectory = 8;
+
+  NSMutableArray<NSString*>* paths = [NSMutableArray arrayWithCapacity:(directoryCount * tracksPerDirectory)];
+  for (NSUInteger track = 0; track < tracksPerDirectory; track++) {
+    for (NSUInteger directory = 0; directory < directoryCount; directory++) {
+      [paths addObject:[NSString stringWithFormat:@"/Music/Artist %lu; Beyonc\u00E9/Album/%02lu Track.m4a", directory, track]];
+    }
+  }
+
+  NSMutableArray<NSString*>* mappedPaths = [NSMutableArray arrayWithCapacity:paths.count];
+  for (NSUInteger index = 0; index < paths.count; index++) {
+    [mappedPaths addObject:@""];
+  }
+
+  dispatch_apply(paths.count, DISPATCH_APPLY_AUTO, ^(size_t index) {
+    NSString* mappedPath = [self->_pathMapper mapFilePath:paths[index]];
+    @synchronized (mappedPaths) {
+      mappedPaths[index] = mappedPath;
+    }
+  });
+
+  for (NSUInteger index = 0; index < paths.count; index++) {
+    XCTAssertEqualObjects(mappedPaths[index], [self expectedURLForPath:paths[index]]);
+  }
+}
+
+- (void)testLocalhostPrefix {
+
+  NSString* path = @"/Music/Artist; Other/01 Track.mp3";
+  NSString* expectedURL = [[self expectedURLForPath:path] stringByReplacingOccurrencesOfString:@"file:///" withString:@"file://localhost/"];
+
+  [_pathMapper setAddLocalhostPrefix:YES];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:path], expectedURL);
+}
+
+- (void)testPrefixRuleIsEncodedLikeNSURL {
+
+  [_pathMapper addRuleWithPrefix:@"/Users/me/Music/" replacement:@"/mnt/music; shared/"];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Users/me/Music/Artist/01 Track.mp3"],
+                        [self expectedURLForPath:@"/mnt/music; shared/Artist/01 Track.mp3"]);
+}
+
+- (void)testPrefixRuleOnlyMatchesWholePathComponents {
+
+  [_pathMapper addRuleWithPrefix:@"/Volumes/Music" replacement:@"/mnt/music"];
+  [_pathMapper addRuleWithPrefix:@"/Volumes/Other/" replacement:@"/mnt/other/"];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Volumes/Music/Artist/01 Track.mp3"], [self expectedURLForPath:@"/mnt/music/Artist/01 Track.mp3"]);
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Volumes/Music"], [self expectedURLForPath:@"/mnt/music"]);
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Volumes/Other/01 Track.mp3"], [self expectedURLForPath:@"/mnt/other/01 Track.mp3"]);
+
+  // the same prefix followed by more of a name is a different directory
+  [self assertMapsLikeNSURL:@"/Volumes/Music2/Artist/01 Track.mp3"];
+  [self assertMapsLikeNSURL:@"/Volumes/Music Backup/01 Track.mp3"];
+  [self assertMapsLikeNSURL:@"/Volumes/Othering/01 Track.mp3"];
+}
+
+- (void)testLongestWholeComponentPrefixRuleIsUsed {
+
+  [_pathMapper addRuleWithPrefix:@"/Volumes/Music" replacement:@"/mnt/music"];
+  [_pathMapper addRuleWithPrefix:@"/Volumes/Music2" replacement:@"/mnt/music2"];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Volumes/Music/01 Track.mp3"], [self expectedURLForPath:@"/mnt/music/01 Track.mp3"]);
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Volumes/Music2/01 Track.mp3"], [self expectedURLForPath:@"/mnt/music2/01 Track.mp3"]);
+}
+
+- (void)testPrefixRuleMatchesEitherNormalizationForm {
+
+  // precomposed rule, decomposed path
+  [_pathMapper addRuleWithPrefix:@"/Music/Beyonc\u00E9" replacement:@"/mnt/beyonce"];
+  // decomposed rule, precomposed path
+  [_pathMapper addRuleWithPrefix:@"/Music/Ame\u0301lie/" replacement:@"/mnt/amelie/"];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Music/Beyonce\u0301/Album/01 Track.mp3"],
+                        [self expectedURLForPath:@"/mnt/beyonce/Album/01 Track.mp3"]);
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Music/Beyonc\u00E9/Album/01 Track.mp3"],
+                        [self expectedURLForPath:@"/mnt/beyonce/Album/01 Track.mp3"]);
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Music/Am\u00E9lie/01 Track.mp3"],
+                        [self expectedURLForPath:@"/mnt/amelie/01 Track.mp3"]);
+
+  // the rest of the path keeps its own form
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Music/Beyonce\u0301/Caf\u00E9/01 Track.mp3"],
+                        [self expectedURLForPath:@"/mnt/beyonce/Caf\u00E9/01 Track.mp3"]);
+
+  // still only whole components
+  [self assertMapsLikeNSURL:@"/Music/Beyonce\u0301s/01 Track.mp3"];
+}
+
+- (void)testAbsoluteSearchStringIsMatchedAsPrefix {
+
+  [_pathMapper setSearchString:@"/Users/me/Music"];
+  [_pathMapper setReplaceString:@"/mnt/music"];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Users/me/Music/Artist/01 Track.mp3"], [self expectedURLForPath:@"/mnt/music/Artist/01 Track.mp3"]);
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Users/me/Music/Artist/02 Track.mp3"], [self expectedURLForPath:@"/mnt/music/Artist/02 Track.mp3"]);
+  [self assertMapsLikeNSURL:@"/Users/me/Music2/Artist/01 Track.mp3"];
+
+  // takes precedence over a rule with the same prefix
+  [_pathMapper addRuleWithPrefix:@"/Users/me/Music" replacement:@"/mnt/rule"];
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Users/me/Music/Artist/01 Track.mp3"], [self expectedURLForPath:@"/mnt/music/Artist/01 Track.mp3"]);
+}
+
+- (void)testRelativeSearchStringIsReplacedAnywhere {
+
+  [_pathMapper setSearchString:@"Old Artist"];
+  [_pathMapper setReplaceString:@"New Artist"];
+
+  XCTAssertEqualObjects([_pathMapper mapFilePath:@"/Music/Old Artist/Old Artist - 01 Track.mp3"],
+                        [self expectedURLForPath:@"/Music/New Artist/New Artist - 01 Track.mp3"]);
+  [self assertMapsLikeNSURL:@"/Music/Other Artist/01 Track.mp3"];
+}
+
+@end
@@ -17,6 +17,11 @@
 #import "ExportManager.h"
 #import "ScheduleConfiguration.h"
 #import "DirectoryPermissionsWindowController.h"
+#import "FSEventsFileWatcher.h"
+#import "LibraryChangeMonitor.h"
+
+// exports triggered by library changes wait until the library has been left alone for this long
+static NSTimeInterval const ExportSchedulerLibraryQuietPeriod = 30;
 
 @implementation ExportScheduler {
 
@@ -25,6 +30,16 @@
 
   NSTimer* _timer;
 
+  // exports once the library settles after a change, the timer is kept as an upper bound between exports
+  LibraryChangeMonitor* _changeMonitor;
+  NSString* _monitoredLibraryPath;
+
+  // set when the library changed while an export was running, that export may have missed the change
+  BOOL _libraryChangePending;
+
+  // set while a scheduled export is running in the background
+  ExportManager* _exportManager;
+
   DirectoryPermissionsWindowController* _permissionsWindowController;
 }
 
@@ -40,6 +55,12 @@
 
     _timer = nil;
 
+    _changeMonitor = nil;
+    _monitoredLibraryPath = nil;
+    _libraryChangePending = NO;
+
+    _exportManager = nil;
+
     _permissionsWindowController = nil;
 
     return self;
@@ -193,15 +214,42 @@
     [_timer invalidate];
     _timer = nil;
   }
+
+  [self stopMonitoringLibrary];
+  _libraryChangePending = NO;
+
+  // stop a scheduled export that is still running, the previous output is left in place
+  if (_exportManager) {
+    [_exportManager cancel];
+  }
 }
 
 - (void)onTimerFinished {
 
   MLE_Log_Info(@"ExportScheduler [onTimerFinished]");
 
+  [self runExportForLibraryChange:NO];
+}
+
+- (void)runExportForLibraryChange:(BOOL)forLibraryChange {
+
+  if (_exportManager) {
+    if (forLibraryChange) {
+      MLE_Log_Info(@"ExportScheduler [runExportForLibraryChange] previous export is still running, exporting again once it finishes");
+      _libraryChangePending = YES;
+    }
+    else {
+      MLE_Log_Info(@"ExportScheduler [runExportForLibraryChange] previous export is still running, skipping");
+    }
+    return;
+  }
+
   ExportDeferralReason deferralReason = [self reasonToDeferExport];
   if (deferralReason == ExportNoDeferralReason) {
 
+    // this export includes any change that was waiting on the previous one
+    _libraryChangePending = NO;
+
     // resolve output filename (fallback to default if none provided)
     NSString* outputFileName = _exportConfiguration.outputFileName;
     if (outputFileName == nil || outputFileName.length == 0) {
@@ -221,29 +269,57 @@
     NSURL* outputFileURL = [outputDirectoryURL URLByAppendingPathComponent:outputFileName];
 
     ExportManager* exportManager = [[ExportManager alloc] initWithConfiguration:_exportConfiguration];
+    [exportManager setDelegateQueue:dispatch_get_main_queue()];
     [exportManager setOutputFileURL:outputFileURL];
 
+    // reuse unchanged tracks from the previous scheduled export
+    NSURL* cachesDirectoryURL = [NSFileManager.defaultManager URLForDirectory:NSCachesDirectory inDomain:NSUserDomainMask appropriateForURL:nil create:YES error:nil];
+    if (cachesDirectoryURL != nil) {
+      [exportManager setFragmentCacheURL:[cachesDirectoryURL URLByAppendingPathComponent:@"TrackFragments.cache"]];
+    }
+
     /* ---- scoped security access started ---- */
     [outputDirectoryURL startAccessingSecurityScopedResource];
 
-    // run export
-    NSError* exportError;
-    BOOL exportSuccessful = [exportManager exportLibraryWithError:&exportError];
+    // run export without blocking the main thread, the completion handler is called on the main queue
+    _exportManager = exportManager;
+    [exportManager exportLibraryInBackgroundWithCompletionHandler:^(BOOL exportSuccessful, NSError* exportError) {
 
-    [outputDirectoryURL stopAccessingSecurityScopedResource];
-    /* ---- scoped security access stopped ---- */
+      [outputDirectoryURL stopAccessingSecurityScopedResource];
+      /* ---- scoped security access stopped ---- */
 
-    if (!exportSuccessful) {
-      // ... handle export error
-      return;
-    }
+      self->_exportManager = nil;
+
+      if (!exportSuccessful) {
+        MLE_Log_Info(@"ExportScheduler [runExportForLibraryChange] export failed: %@", exportError.localizedDescription);
+        // ... handle export error
+      }
+      else {
+        if (exportManager.state == ExportUnchanged) {
+          MLE_Log_Info(@"ExportScheduler [runExportForLibraryChange] library is unchanged, output file was not modified");
+        }
+
+        [self->_scheduleConfiguration setLastExportedAt:[NSDate date]];
+      }
+
+      // export the changes that were made while this export was running
+      if (self->_libraryChangePending) {
+        self->_libraryChangePending = NO;
+        [self runExportForLibraryChange:YES];
+      }
+    }];
+
+    return;
   }
 
   else {
-    MLE_Log_Info(@"ExportScheduler [onTimerFinished] export task is being skipped for reason: %@", ExportDeferralReasonNames[deferralReason]);
+    MLE_Log_Info(@"ExportScheduler [runExportForLibraryChange] export task is being skipped for reason: %@", ExportDeferralReasonNames[deferralReason]);
   }
 
-  [_scheduleConfiguration setLastExportedAt:[NSDate date]];
+  // a deferred change is left to the interval timer, which must not be pushed back by it
+  if (!forLibraryChange) {
+    [_scheduleConfiguration setLastExportedAt:[NSDate date]];
+  }
 }
 
 - (void)updateSchedule {
@@ -258,12 +334,67 @@
 
   if (nextExportDate) {
     [self activateScheduler];
+
+    if (_scheduleConfiguration.exportOnLibraryChange) {
+      [self startMonitoringLibrary];
+    }
+    else {
+      [self stopMonitoringLibrary];
+    }
   }
   else {
     [self deactivateScheduler];
   }
 }
 
+- (void)startMonitoringLibrary {
+
+  NSString* libraryPath = _scheduleConfiguration.libraryPath.length > 0 ? _scheduleConfiguration.libraryPath : [LibraryChangeMonitor defaultLibraryPath];
+
+  if (_changeMonitor && _changeMonitor.isMonitoring) {
+    if ([_monitoredLibraryPath isEqualToString:libraryPath]) {
+      return;
+    }
+    [_changeMonitor stopMonitoring];
+  }
+
+  if (_changeMonitor == nil) {
+    _changeMonitor = [[LibraryChangeMonitor alloc] initWithWatcher:[[FSEventsFileWatcher alloc] init] quietPeriod:ExportSchedulerLibraryQuietPeriod];
+
+    __weak ExportScheduler* weakSelf = self;
+    [_changeMonitor setChangeHandler:^{
+      [weakSelf onLibraryChanged];
+    }];
+  }
+
+  _monitoredLibraryPath = libraryPath;
+
+  NSError* monitorError;
+  if (![_changeMonitor startMonitoringPath:libraryPath error:&monitorError]) {
+    MLE_Log_Info(@"ExportScheduler [startMonitoringLibrary] unable to watch library, only exporting every %.0fs: %@ (set %@ to the library's location)",
+                 _scheduleConfiguration.scheduleInterval, monitorError.localizedDescription, ScheduleConfigurationKeyLibraryPath);
+  }
+}
+
+- (void)stopMonitoringLibrary {
+
+  if (_changeMonitor) {
+    [_changeMonitor stopMonitoring];
+  }
+}
+
+- (void)onLibraryChanged {
+
+  MLE_Log_Info(@"ExportScheduler [onLibraryChanged]");
+
+  if (_timer == nil) {
+    return;
+  }
+
+  // setting lastExportedAt afterwards re-arms the interval timer
+  [self runExportForLibraryChange:YES];
+}
+
 - (void)requestOutputDirectoryPermissions {
 
   if (_permissionsWindowController) {
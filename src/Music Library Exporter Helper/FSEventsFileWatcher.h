@@ -0,0 +1,35 @@
+//
+//  FSEventsFileWatcher.h
+//  Music Library Exporter Helper
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FileWatcher.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// FileWatcher backed by an FSEvents stream
+@interface FSEventsFileWatcher : NSObject <FileWatcher>
+
+extern NSErrorDomain const __MLE_ErrorDomain_FSEventsFileWatcher;
+
+typedef NS_ENUM(NSUInteger, FSEventsFileWatcherErrorCode) {
+  FSEventsFileWatcherErrorStreamFailed = 0,
+};
+
+#pragma mark - Properties
+
+// Time FSEvents waits to coalesce events before delivering them, defaults to 1s
+@property NSTimeInterval latency;
+
+
+#pragma mark - Initializers
+
+- (instancetype)init;
+
+@end
+
+NS_ASSUME_NONNULL_END
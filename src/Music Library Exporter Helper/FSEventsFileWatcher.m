@@ -0,0 +1,139 @@
+//
+//  FSEventsFileWatcher.m
+//  Music Library Exporter Helper
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "FSEventsFileWatcher.h"
+
+#import <CoreServices/CoreServices.h>
+
+#import "Logger.h"
+
+@interface FSEventsFileWatcher ()
+
+- (void)handleEventCount:(size_t)eventCount;
+
+@end
+
+static void FSEventsFileWatcherCallback(ConstFSEventStreamRef stream, void* info, size_t eventCount, void* eventPaths,
+                                        const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[]) {
+
+  FSEventsFileWatcher* watcher = (__bridge FSEventsFileWatcher*)info;
+
+  [watcher handleEventCount:eventCount];
+}
+
+@implementation FSEventsFileWatcher {
+
+  FSEventStreamRef _stream;
+  FileWatcherHandler _handler;
+}
+
+NSErrorDomain const __MLE_ErrorDomain_FSEventsFileWatcher = @"com.kylekingcdn.MusicLibraryExporter.FSEventsFileWatcherErrorDomain";
+
+
+#pragma mark - Initializers
+
+- (instancetype)init {
+
+  if (self = [super init]) {
+
+    _latency = 1.0;
+
+    _stream = NULL;
+    _handler = nil;
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+- (void)dealloc {
+
+  [self stopWatching];
+}
+
+
+#pragma mark - Accessors
+
+- (BOOL)isWatching {
+
+  return _stream != NULL;
+}
+
+
+#pragma mark - Mutators
+
+- (BOOL)startWatchingPaths:(NSArray<NSString*>*)paths queue:(dispatch_queue_t)queue handler:(FileWatcherHandler)handler error:(NSError**)error {
+
+  [self stopWatching];
+
+  MLE_Log_Info(@"FSEventsFileWatcher [startWatchingPaths] %@", paths);
+
+  // the stream doesn't retain its context info, the watcher stops the stream before it is deallocated
+  FSEventStreamContext context = { 0, (__bridge void*)self, NULL, NULL, NULL };
+
+  _stream = FSEventStreamCreate(kCFAllocatorDefault, &FSEventsFileWatcherCallback, &context, (__bridge CFArrayRef)paths,
+                                kFSEventStreamEventIdSinceNow, _latency, kFSEventStreamCreateFlagNone);
+
+  if (_stream == NULL) {
+    MLE_Log_Info(@"FSEventsFileWatcher [startWatchingPaths] unable to create event stream");
+    if (error) {
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_FSEventsFileWatcher code:FSEventsFileWatcherErrorStreamFailed userInfo:@{
+        NSLocalizedDescriptionKey:@"Unable to watch the Music library for changes",
+      }];
+    }
+    return NO;
+  }
+
+  _handler = handler;
+
+  FSEventStreamSetDispatchQueue(_stream, queue);
+
+  if (!FSEventStreamStart(_stream)) {
+    MLE_Log_Info(@"FSEventsFileWatcher [startWatchingPaths] unable to start event stream");
+    [self stopWatching];
+    if (error) {
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_FSEventsFileWatcher code:FSEventsFileWatcherErrorStreamFailed userInfo:@{
+        NSLocalizedDescriptionKey:@"Unable to watch the Music library for changes",
+      }];
+    }
+    return NO;
+  }
+
+  return YES;
+}
+
+- (void)stopWatching {
+
+  if (_stream == NULL) {
+    return;
+  }
+
+  MLE_Log_Info(@"FSEventsFileWatcher [stopWatching]");
+
+  FSEventStreamStop(_stream);
+  FSEventStreamInvalidate(_stream);
+  FSEventStreamRelease(_stream);
+  _stream = NULL;
+
+  _handler = nil;
+}
+
+
+#pragma mark - Helper functions
+
+- (void)handleEventCount:(size_t)eventCount {
+
+  MLE_Log_Debug(@"FSEventsFileWatcher [handleEventCount] received %zu events", eventCount);
+
+  if (_handler != nil) {
+    _handler();
+  }
+}
+
+@end
@@ -0,0 +1,29 @@
+//
+//  FileWatcher.h
+//  Music Library Exporter Helper
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^FileWatcherHandler)(void);
+
+// Backend that reports changes to the contents of a set of directories.
+//
+// Events only signal that something changed, not what did, so a backend is free to coalesce them. Keeping the backend
+// behind this protocol lets LibraryChangeMonitor be driven by any event source.
+@protocol FileWatcher <NSObject>
+
+// The handler is called on the given queue for changes anywhere below the watched paths
+- (BOOL)startWatchingPaths:(NSArray<NSString*>*)paths queue:(dispatch_queue_t)queue handler:(FileWatcherHandler)handler error:(NSError**)error;
+
+- (void)stopWatching;
+
+- (BOOL)isWatching;
+
+@end
+
+NS_ASSUME_NONNULL_END
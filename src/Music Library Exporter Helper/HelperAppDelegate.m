@@ -38,6 +38,8 @@
     [_groupDefaults addObserver:self forKeyPath:ScheduleConfigurationKeyScheduleEnabled options:NSKeyValueObservingOptionNew context:NULL];
     [_groupDefaults addObserver:self forKeyPath:ScheduleConfigurationKeyScheduleInterval options:NSKeyValueObservingOptionNew context:NULL];
     [_groupDefaults addObserver:self forKeyPath:ScheduleConfigurationKeyLastExportedAt options:NSKeyValueObservingOptionNew context:NULL];
+    [_groupDefaults addObserver:self forKeyPath:ScheduleConfigurationKeyExportOnLibraryChange options:NSKeyValueObservingOptionNew context:NULL];
+    [_groupDefaults addObserver:self forKeyPath:ScheduleConfigurationKeyLibraryPath options:NSKeyValueObservingOptionNew context:NULL];
     [_groupDefaults addObserver:self forKeyPath:ExportConfigurationKeyOutputDirectoryPath options:NSKeyValueObservingOptionNew context:NULL];
 
     _exportConfiguration = nil;
@@ -88,6 +90,8 @@
   if ([keyPath isEqualToString:ScheduleConfigurationKeyScheduleEnabled] ||
       [keyPath isEqualToString:ScheduleConfigurationKeyScheduleInterval] ||
       [keyPath isEqualToString:ScheduleConfigurationKeyLastExportedAt] ||
+      [keyPath isEqualToString:ScheduleConfigurationKeyExportOnLibraryChange] ||
+      [keyPath isEqualToString:ScheduleConfigurationKeyLibraryPath] ||
       [keyPath isEqualToString:ExportConfigurationKeyOutputDirectoryPath]) {
 
     // fetch latest configuration values
@@ -0,0 +1,60 @@
+//
+//  LibraryChangeMonitor.h
+//  Music Library Exporter Helper
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FileWatcher.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^LibraryChangeMonitorHandler)(void);
+
+// Debounces changes to the Music library into a single callback.
+//
+// Every change restarts the quiet period, the handler is called on the main queue once no change has been seen for
+// `quietPeriod` seconds. A burst of edits (e.g. while tags are being edited) therefore triggers a single export.
+@interface LibraryChangeMonitor : NSObject
+
+extern NSErrorDomain const __MLE_ErrorDomain_LibraryChangeMonitor;
+
+typedef NS_ENUM(NSUInteger, LibraryChangeMonitorErrorCode) {
+  LibraryChangeMonitorErrorLibraryNotFound = 0,
+};
+
+#pragma mark - Properties
+
+@property (readonly) NSTimeInterval quietPeriod;
+
+@property (nullable, copy) LibraryChangeMonitorHandler changeHandler;
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithWatcher:(NSObject<FileWatcher>*)watcher quietPeriod:(NSTimeInterval)quietPeriod;
+
+
+#pragma mark - Accessors
+
+- (BOOL)isMonitoring;
+
+// Default location of the Music library database, ~/Music/Music/Music Library.musiclibrary
++ (NSString*)defaultLibraryPath;
+
+
+#pragma mark - Mutators
+
+// Fails with LibraryChangeMonitorErrorLibraryNotFound when nothing exists at the path, since a path that is never
+// written to would otherwise be watched without ever reporting a change
+- (BOOL)startMonitoringPath:(NSString*)path error:(NSError**)error;
+- (void)stopMonitoring;
+
+// Restarts the quiet period, called for every event reported by the watcher
+- (void)noteChange;
+
+@end
+
+NS_ASSUME_NONNULL_END
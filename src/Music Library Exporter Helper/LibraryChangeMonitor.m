@@ -0,0 +1,137 @@
+//
+//  LibraryChangeMonitor.m
+//  Music Library Exporter Helper
+//
+//  Created by Kyle King on 2026-10-17.
+//
+
+#import "LibraryChangeMonitor.h"
+
+#import <pwd.h>
+
+#import "Logger.h"
+
+@implementation LibraryChangeMonitor {
+
+  NSObject<FileWatcher>* _watcher;
+
+  dispatch_source_t _quietPeriodTimer;
+}
+
+NSErrorDomain const __MLE_ErrorDomain_LibraryChangeMonitor = @"com.kylekingcdn.MusicLibraryExporter.LibraryChangeMonitorErrorDomain";
+
+
+#pragma mark - Initializers
+
+- (instancetype)initWithWatcher:(NSObject<FileWatcher>*)watcher quietPeriod:(NSTimeInterval)quietPeriod {
+
+  if (self = [super init]) {
+
+    _quietPeriod = quietPeriod;
+    _changeHandler = nil;
+
+    _watcher = watcher;
+
+    _quietPeriodTimer = nil;
+
+    return self;
+  }
+  else {
+    return nil;
+  }
+}
+
+- (void)dealloc {
+
+  [self stopMonitoring];
+}
+
+
+#pragma mark - Accessors
+
+- (BOOL)isMonitoring {
+
+  return [_watcher isWatching];
+}
+
++ (NSString*)defaultLibraryPath {
+
+  // NSHomeDirectory() is the container directory when sandboxed
+  struct passwd* userInfo = getpwuid(getuid());
+  NSString* homePath = (userInfo != NULL && userInfo->pw_dir != NULL) ? [NSString stringWithUTF8String:userInfo->pw_dir] : NSHomeDirectory();
+
+  return [homePath stringByAppendingPathComponent:@"Music/Music/Music Library.musiclibrary"];
+}
+
+
+#pragma mark - Mutators
+
+- (BOOL)startMonitoringPath:(NSString*)path error:(NSError**)error {
+
+  MLE_Log_Info(@"LibraryChangeMonitor [startMonitoringPath] %@ (quiet period: %.0fs)", path, _quietPeriod);
+
+  if (![NSFileManager.defaultManager fileExistsAtPath:path]) {
+    MLE_Log_Info(@"LibraryChangeMonitor [startMonitoringPath] no Music library found at: %@", path);
+    if (error) {
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_LibraryChangeMonitor code:LibraryChangeMonitorErrorLibraryNotFound userInfo:@{
+        NSLocalizedDescriptionKey:[NSString stringWithFormat:@"No Music library was found (or it can't be accessed) at: %@", path],
+        NSLocalizedRecoverySuggestionErrorKey:@"Set the library path if the Music library is stored in another location.",
+      }];
+    }
+    return NO;
+  }
+
+  __weak LibraryChangeMonitor* weakSelf = self;
+
+  return [_watcher startWatchingPaths:@[ path ] queue:dispatch_get_main_queue() handler:^{
+    [weakSelf noteChange];
+  } error:error];
+}
+
+- (void)stopMonitoring {
+
+  [_watcher stopWatching];
+
+  if (_quietPeriodTimer != nil) {
+    dispatch_source_cancel(_quietPeriodTimer);
+    _quietPeriodTimer = nil;
+  }
+}
+
+- (void)noteChange {
+
+  if (_quietPeriodTimer == nil) {
+
+    MLE_Log_Info(@"LibraryChangeMonitor [noteChange] library changed, waiting for it to settle");
+
+    __weak LibraryChangeMonitor* weakSelf = self;
+
+    _quietPeriodTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_event_handler(_quietPeriodTimer, ^{
+      [weakSelf quietPeriodElapsed];
+    });
+    dispatch_resume(_quietPeriodTimer);
+  }
+
+  // a later change pushes the deadline back
+  dispatch_source_set_timer(_quietPeriodTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_quietPeriod * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, NSEC_PER_SEC);
+}
+
+
+#pragma mark - Helper functions
+
+- (void)quietPeriodElapsed {
+
+  if (_quietPeriodTimer != nil) {
+    dispatch_source_cancel(_quietPeriodTimer);
+    _quietPeriodTimer = nil;
+  }
+
+  MLE_Log_Info(@"LibraryChangeMonitor [quietPeriodElapsed] no changes for %.0fs", _quietPeriod);
+
+  if (_changeHandler != nil) {
+    _changeHandler();
+  }
+}
+
+@end
@@ -301,9 +301,6 @@ NSErrorDomain const __MLE_ErrorDomain_ConfigurationView = @"com.kylekingcdn.Musi
   // catch any changes made to configuration form before updating UI
   [[[self view] window] makeFirstResponder:self.view.window];
 
-  dispatch_queue_attr_t queuePriorityAttr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
-  dispatch_queue_t gcdQueue = dispatch_queue_create("ExportQueue", queuePriorityAttr);
-
   // reset track progress values in main thread first
   [_exportProgressBar setDoubleValue:0];
   [_exportProgressBar setMinValue:0];
@@ -328,16 +325,14 @@ NSErrorDomain const __MLE_ErrorDomain_ConfigurationView = @"com.kylekingcdn.Musi
 
   ExportManager* exportManager = [[ExportManager alloc] initWithConfiguration:_exportConfiguration];
   [exportManager setDelegate:self];
+  [exportManager setDelegateQueue:dispatch_get_main_queue()];
   [exportManager setOutputFileURL:outputFileURL];
 
-  dispatch_async(gcdQueue, ^{
-
-    /* ---- scoped security access started ---- */
-    [outputDirectoryURL startAccessingSecurityScopedResource];
+  /* ---- scoped security access started ---- */
+  [outputDirectoryURL startAccessingSecurityScopedResource];
 
-    // run export
-    NSError* exportError;
-    BOOL exportSuccessful = [exportManager exportLibraryWithError:&exportError];
+  // run export
+  [exportManager exportLibraryInBackgroundWithCompletionHandler:^(BOOL exportSuccessful, NSError* exportError) {
 
     [outputDirectoryURL stopAccessingSecurityScopedResource];
     /* ---- scoped security access stopped ---- */
@@ -355,7 +350,7 @@ NSErrorDomain const __MLE_ErrorDomain_ConfigurationView = @"com.kylekingcdn.Musi
       }
       return;
     }
-  });
+  }];
 }
 
 
@@ -509,6 +504,7 @@ NSErrorDomain const __MLE_ErrorDomain_ConfigurationView = @"com.kylekingcdn.Musi
     BOOL exportAllowed;
     switch (newState) {
       case ExportFinished:
+      case ExportUnchanged:
         [self->_scheduleConfiguration setLastExportedAt:[NSDate date]];
       case ExportStopped:
       case ExportError: {
@@ -53,6 +53,7 @@ typedef NS_ENUM(NSUInteger, ArgParserErrorCode) {
 - (nullable XPMArgumentSignature*)signatureForOption:(CLIOptionKind)option;
 
 - (BOOL)isOptionSet:(CLIOptionKind)option;
+- (nullable NSString*)stringValueForOption:(CLIOptionKind)option;
 
 - (NSSet<NSNumber*>*)determineCommandTypes;
 
@@ -80,6 +80,15 @@ NSErrorDomain const __MLE_ErrorDomain_ArgParser = @"com.kylekingcdn.MusicLibrary
   return (signatureCount != NSNotFound && signatureCount > 0);
 }
 
+- (nullable NSString*)stringValueForOption:(CLIOptionKind)option {
+
+  if (![self isOptionSet:option]) {
+    return nil;
+  }
+
+  return [_package firstObjectForSignature:[self signatureForOption:option]];
+}
+
 - (NSSet<NSNumber*>*)determineCommandTypes {
 
   NSMutableSet<NSNumber*>* commmandTypes = [NSMutableSet set];
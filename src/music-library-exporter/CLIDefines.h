@@ -17,6 +17,7 @@ typedef NS_ENUM(NSUInteger, CLICommandKind) {
   CLICommandKindVersion,
   CLICommandKindPrint,
   CLICommandKindExport,
+  CLICommandKindBenchmark,
   CLICommandKindUnknown,
 };
 
@@ -42,8 +43,18 @@ typedef NS_ENUM(NSUInteger, CLIOptionKind) {
   CLIOptionKindRemapSearch,
   CLIOptionKindRemapReplace,
   CLIOptionKindRemapLocalhostPrefix,
+  CLIOptionKindRemapRules,
   CLIOptionKindOutputPath,
+  CLIOptionKindOutputFormat,
+  CLIOptionKindBatch,
+  CLIOptionKindStats,
+  CLIOptionKindStatsFile,
 
+  // - benchmark only - //
+
+  CLIOptionKindFixture,
+  CLIOptionKindSynthetic,
+  CLIOptionKindIterations,
 
   CLIOptionKind_MAX,
 };
@@ -49,7 +49,22 @@
         @(CLIOptionKindRemapSearch),
         @(CLIOptionKindRemapReplace),
         @(CLIOptionKindRemapLocalhostPrefix),
+        @(CLIOptionKindRemapRules),
         @(CLIOptionKindOutputPath),
+        @(CLIOptionKindOutputFormat),
+        @(CLIOptionKindBatch),
+        @(CLIOptionKindStats),
+        @(CLIOptionKindStatsFile),
+      ];
+    }
+
+    case CLICommandKindBenchmark: {
+      return @[
+        @(CLIOptionKindHelp),
+        @(CLIOptionKindSort),
+        @(CLIOptionKindFixture),
+        @(CLIOptionKindSynthetic),
+        @(CLIOptionKindIterations),
       ];
     }
 
@@ -84,6 +99,10 @@
       ];
     }
 
+    case CLICommandKindBenchmark: {
+      return @[ ];
+    }
+
     case CLICommandKindUnknown: {
       return @[ ];
     }
@@ -105,6 +124,9 @@
     case CLICommandKindExport: {
       return @"export";
     }
+    case CLICommandKindBenchmark: {
+      return @"benchmark";
+    }
     case CLICommandKindUnknown: {
       return nil;
     }
@@ -151,9 +173,34 @@
     case CLIOptionKindRemapLocalhostPrefix: {
       return @"--localhost_path_prefix";
     }
+    case CLIOptionKindRemapRules: {
+      return @"--remap_rules";
+    }
     case CLIOptionKindOutputPath: {
       return @"--output_path";
     }
+    case CLIOptionKindOutputFormat: {
+      return @"--output_format";
+    }
+    case CLIOptionKindBatch: {
+      return @"--batch";
+    }
+    case CLIOptionKindStats: {
+      return @"--stats";
+    }
+    case CLIOptionKindStatsFile: {
+      return @"--stats_file";
+    }
+
+    case CLIOptionKindFixture: {
+      return @"--fixture";
+    }
+    case CLIOptionKindSynthetic: {
+      return @"--synthetic";
+    }
+    case CLIOptionKindIterations: {
+      return @"--iterations";
+    }
 
     case CLIOptionKind_MAX: {
       return nil;
@@ -188,6 +235,9 @@
     case CLICommandKindExport: {
       return @"[export]";
     }
+    case CLICommandKindBenchmark: {
+      return @"[benchmark]";
+    }
 
     case CLICommandKindUnknown: {
       return nil;
@@ -236,9 +286,34 @@
     case CLIOptionKindRemapLocalhostPrefix: {
       return @"[--localhost_path_prefix]";
     }
+    case CLIOptionKindRemapRules: {
+      return @"[--remap_rules]={1,1}";
+    }
     case CLIOptionKindOutputPath: {
       return @"[-o --output_path]={1,1}";
     }
+    case CLIOptionKindOutputFormat: {
+      return @"[--output_format]={1,1}";
+    }
+    case CLIOptionKindBatch: {
+      return @"[--batch]={1,1}";
+    }
+    case CLIOptionKindStats: {
+      return @"[--stats]";
+    }
+    case CLIOptionKindStatsFile: {
+      return @"[--stats_file]";
+    }
+
+    case CLIOptionKindFixture: {
+      return @"[--fixture]={1,1}";
+    }
+    case CLIOptionKindSynthetic: {
+      return @"[--synthetic]={1,1}";
+    }
+    case CLIOptionKindIterations: {
+      return @"[--iterations]={1,1}";
+    }
 
     case CLIOptionKind_MAX: {
       return nil;
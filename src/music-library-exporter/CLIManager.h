@@ -25,6 +25,8 @@ typedef NS_ENUM(NSUInteger, CLIManagerErrorCode) {
   CLIManagerErrorInvalidOutputPath,
   CLIManagerErrorInvalidMusicMediaDirectory,
   CLIManagerErrorInvalidRemapping,
+  CLIManagerErrorInvalidBenchmarkOption,
+  CLIManagerErrorInvalidOutputFormat,
 };
 
 
@@ -53,6 +55,8 @@ typedef NS_ENUM(NSUInteger, CLIManagerErrorCode) {
 
 - (BOOL)exportLibraryAndReturnError:(NSError**)error;
 
+- (BOOL)runBenchmarkAndReturnError:(NSError**)error;
+
 
 @end
 
@@ -8,17 +8,24 @@
 #import "CLIManager.h"
 
 #import <iTunesLibrary/ITLibPlaylist.h>
+#import <signal.h>
 #import <sys/ioctl.h>
 
 #import "Logger.h"
 #import "ArgParser.h"
+#import "BatchExportManager.h"
+#import "ExportBenchmark.h"
 #import "ExportConfiguration.h"
 #import "ExportManager.h"
+#import "PlistWriter.h"
+#import "ExportMetrics.h"
 #import "PlaylistTreeNode.h"
 #import "PlaylistTreeGenerator.h"
 #import "OrderedDictionary.h"
+#import "PathMapper.h"
 #import "PlaylistFilterGroup.h"
 #import "PlaylistParentIDFilter.h"
+#import "SyntheticLibraryGenerator.h"
 
 
 @interface CLIManager ()
@@ -27,8 +34,12 @@
 
 - (BOOL)validateExportConfigurationAndReturnError:(NSError**)error;
 - (BOOL)validateOutputPathAndReturnError:(NSError**)error;
+- (BOOL)validateOutputFormatAndReturnError:(NSError**)error;
 - (BOOL)validateMusicMediaDirectoryAndReturnError:(NSError**)error;
 - (BOOL)validatePathMappingAndReturnError:(NSError**)error;
+- (BOOL)validateBenchmarkOptionsAndReturnError:(NSError**)error;
+
+- (BOOL)exportBatchAndReturnError:(NSError**)error;
 
 - (void)clearBuffer;
 - (void)printStatus:(NSString*)message;
@@ -47,6 +58,20 @@
 
   PlaylistParentIDFilter* _playlistParentIDFilter;
 
+  BOOL _printStats;
+  BOOL _writeStatsFile;
+
+  NSString* _outputFormatName;
+  PlistWriterFormat _outputFormat;
+
+  NSString* _remapRulesPath;
+
+  NSString* _batchConfigPath;
+
+  NSString* _benchmarkFixturePath;
+  NSString* _benchmarkSyntheticSpecifier;
+  NSString* _benchmarkIterations;
+
   BOOL _printProgress;
   NSUInteger _termWidth;
 }
@@ -66,6 +91,20 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
 
     _playlistParentIDFilter = nil;
 
+    _printStats = NO;
+    _writeStatsFile = NO;
+
+    _outputFormatName = nil;
+    _outputFormat = PlistWriterFormatXML;
+
+    _remapRulesPath = nil;
+
+    _batchConfigPath = nil;
+
+    _benchmarkFixturePath = nil;
+    _benchmarkSyntheticSpecifier = nil;
+    _benchmarkIterations = nil;
+
     if ([CLIManager isRunningInTerminal]) {
 
       _printProgress = YES;
@@ -129,12 +168,26 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
   printf("\n            --read_prefs");
   printf("\n            --music_media_dir  <music_media_dir>");
   printf("\n            --output_path  <path>");
+  printf("\n            --batch  <path>");
   printf("\n            --flatten");
   printf("\n            --exclude_internal ");
   printf("\n            --exclude_ids  <playlist_ids>");
   printf("\n            --sort  <playlist_sorting_specifers>");
   printf("\n            --remap_search  <text_to_find>");
   printf("\n            --remap_replace  <replacement text>");
+  printf("\n            --stats");
+  printf("\n            --stats_file");
+  printf("\n");
+  printf("\n    benchmark");
+  printf("\n");
+  printf("\n        Measures the time and memory used by each stage of an export.");
+  printf("\n        A synthetic library is generated unless --fixture is given, your Music library is never read.");
+  printf("\n");
+  printf("\n        Supported options:");
+  printf("\n            --fixture  <path>");
+  printf("\n            --synthetic  <library_parameters>");
+  printf("\n            --iterations  <count>");
+  printf("\n            --sort  <playlist_sorting_specifers>");
   printf("\n");
   printf("\nOPTIONS");
   printf("\n");
@@ -157,14 +210,40 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
   printf("\n    --output_path <path>, -o <path>");
   printf("\n");
   printf("\n        The desired output path of the generated library (directory and filename).");
-  printf("\n        Export behaviour is undetermined when using file extensions other than '.xml'.");
-  printf("\n        If you must change the extension: first run the export command and then run 'mv' afterwards to relocate it to the desired location.");
+  printf("\n        The file extension is used as-is, it should match the --output_format (e.g. '.xml.gz' for xml.gz).");
   printf("\n");
   printf("\n        NOTE: This option is mandatory unless the value is being imported via --read_prefs.");
   printf("\n");
   printf("\n        Example value:");
   printf("\n            --output_path ~/Music/Music/GeneratedLibrary.xml");
   printf("\n");
+  printf("\n    --output_format <format>");
+  printf("\n");
+  printf("\n        The encoding of the generated library (default: xml).");
+  printf("\n");
+  printf("\n        Available Formats:");
+  printf("\n");
+  printf("\n            xml       XML property list, the format written by iTunes");
+  printf("\n            bplist    Binary property list, smaller and faster to parse than XML");
+  printf("\n            xml.gz    gzip compressed XML property list");
+  printf("\n");
+  printf("\n        Example value:");
+  printf("\n            --output_format xml.gz --output_path ~/Music/Music/GeneratedLibrary.xml.gz");
+  printf("\n");
+  printf("\n    --batch <path>");
+  printf("\n");
+  printf("\n        Exports several variants of your library from a single read of it, e.g. with different path mappings for each media server.");
+  printf("\n        The value is a property list with a 'Targets' array, each target is a dictionary of app preference keys plus:");
+  printf("\n");
+  printf("\n            OutputPath        The output path of the target's library (required)");
+  printf("\n            OutputFormat      The encoding of the target's library, see --output_format");
+  printf("\n            RemapRulesPath    A path prefix rules file, see --remap_rules");
+  printf("\n");
+  printf("\n        Other options given on the command line apply to every target unless the target overrides them. --output_path is not needed.");
+  printf("\n");
+  printf("\n        Example target:");
+  printf("\n            <dict><key>OutputPath</key><string>~/Exports/Plex.xml</string><key>FlattenPlaylistHierarchy</key><true/></dict>");
+  printf("\n");
   printf("\n    --flatten, -f");
   printf("\n");
   printf("\n        Setting this flag will flatten the generated playlist hierarchy, or in other words, folders will not be included.");
@@ -259,6 +338,44 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
   printf("\n");
   printf("\n        Example result:");
   printf("\n            Track paths will be generated as 'file://localhost/Path/to/track.mp3' rather than 'file:///Path/to/track.mp3'.");
+  printf("\n");
+  printf("\n    --remap_rules <path>");
+  printf("\n");
+  printf("\n        A file of path prefix rules, useful when tracks are spread across several volumes.");
+  printf("\n        Each line contains one rule formatted as '<prefix> => <replacement>', blank lines and lines starting with '#' are ignored.");
+  printf("\n        A rule only matches at the start of a track's path. When several prefixes match, the longest one is used.");
+  printf("\n        Rules are applied after --remap_search/--remap_replace, and are compatible with --localhost_path_prefix.");
+  printf("\n");
+  printf("\n        Example file:");
+  printf("\n            /Volumes/Music A => /data/music-a");
+  printf("\n            /Volumes/Music B => /data/music-b");
+  printf("\n");
+  printf("\n    --stats");
+  printf("\n");
+  printf("\n        Prints the time, CPU time, memory footprint growth and item count of each export stage once the export has finished.");
+  printf("\n");
+  printf("\n    --stats_file");
+  printf("\n");
+  printf("\n        Writes the export stage statistics as JSON next to the exported library.");
+  printf("\n");
+  printf("\n        Example result:");
+  printf("\n            --output_path ~/Music/GeneratedLibrary.xml will also generate ~/Music/GeneratedLibrary.metrics.json");
+  printf("\n");
+  printf("\n    --fixture <path>");
+  printf("\n");
+  printf("\n        Benchmark against a previously exported library XML file instead of a synthetic library.");
+  printf("\n");
+  printf("\n    --synthetic <library_parameters>");
+  printf("\n");
+  printf("\n        A comma separated list of parameters for the generated benchmark library.");
+  printf("\n        Supported parameters: tracks, playlists, depth (folder nesting), items (per playlist), sorted (custom sorted playlists), unicode (0 or 1), seed.");
+  printf("\n");
+  printf("\n        Example value:");
+  printf("\n            --synthetic \"tracks=50000,playlists=500,depth=4,sorted=50,unicode=1\"");
+  printf("\n");
+  printf("\n    --iterations <count>");
+  printf("\n");
+  printf("\n        The number of times each benchmark stage is run (default: 5).");
   printf("\n\n");
 }
 
@@ -317,7 +434,12 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
 
 - (BOOL)validateExportConfigurationAndReturnError:(NSError**)error {
 
-  if (![self validateOutputPathAndReturnError:error]) {
+  // batch targets each set their own output path
+  if (_batchConfigPath == nil && ![self validateOutputPathAndReturnError:error]) {
+    return NO;
+  }
+
+  if (![self validateOutputFormatAndReturnError:error]) {
     return NO;
   }
 
@@ -412,6 +534,28 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
   return YES;
 }
 
+- (BOOL)validateOutputFormatAndReturnError:(NSError**)error {
+
+  if (_outputFormatName == nil) {
+    _outputFormat = PlistWriterFormatXML;
+    return YES;
+  }
+
+  for (PlistWriterFormat format = PlistWriterFormatXML; format < PlistWriterFormat_MAX; format++) {
+    if ([_outputFormatName.lowercaseString isEqualToString:PlistWriterFormatNames[format]]) {
+      _outputFormat = format;
+      return YES;
+    }
+  }
+
+  if (error) {
+    *error = [NSError errorWithDomain:__MLE_ErrorDomain_CLIManager code:CLIManagerErrorInvalidOutputFormat userInfo:@{
+      NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Error: Unsupported value for --output_format: %@. Supported formats are: xml, bplist, xml.gz", _outputFormatName],
+    }];
+  }
+  return NO;
+}
+
 - (BOOL)validateMusicMediaDirectoryAndReturnError:(NSError**)error {
 
   NSString* musicDirPath = _configuration.musicLibraryPath;
@@ -444,6 +588,51 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
     return NO;
   }
 
+  if (_remapRulesPath != nil) {
+    NSError* rulesError;
+    PathMapper* pathMapper = [[PathMapper alloc] init];
+    if (![pathMapper addRulesFromURL:[NSURL fileURLWithPath:_remapRulesPath] error:&rulesError]) {
+      if (error) {
+        *error = [NSError errorWithDomain:__MLE_ErrorDomain_CLIManager code:CLIManagerErrorInvalidRemapping userInfo:@{
+          NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Error: The value for --remap_rules is invalid. %@", rulesError.localizedDescription],
+        }];
+      }
+      return NO;
+    }
+  }
+
+  return YES;
+}
+
+- (BOOL)validateBenchmarkOptionsAndReturnError:(NSError**)error {
+
+  if (_benchmarkFixturePath != nil && _benchmarkSyntheticSpecifier != nil) {
+    if (error) {
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_CLIManager code:CLIManagerErrorInvalidBenchmarkOption userInfo:@{
+        NSLocalizedDescriptionKey:@"Error: --fixture and --synthetic can not be used together",
+      }];
+    }
+    return NO;
+  }
+
+  if (_benchmarkFixturePath != nil && ![[NSFileManager defaultManager] isReadableFileAtPath:_benchmarkFixturePath]) {
+    if (error) {
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_CLIManager code:CLIManagerErrorInvalidBenchmarkOption userInfo:@{
+        NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Error: The specified fixture is not readable: %@", _benchmarkFixturePath],
+      }];
+    }
+    return NO;
+  }
+
+  if (_benchmarkIterations != nil && _benchmarkIterations.integerValue <= 0) {
+    if (error) {
+      *error = [NSError errorWithDomain:__MLE_ErrorDomain_CLIManager code:CLIManagerErrorInvalidBenchmarkOption userInfo:@{
+        NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Error: The value for --iterations must be a positive number: %@", _benchmarkIterations],
+      }];
+    }
+    return NO;
+  }
+
   return YES;
 }
 
@@ -525,6 +714,11 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
 
 - (void)drawProgressBarWithStatus:(NSString*)status forCurrentValue:(NSUInteger)currentVal andTotalValue:(NSUInteger)totalVal {
 
+  // nothing to draw (e.g. every track was filtered)
+  if (totalVal == 0) {
+    return;
+  }
+
   NSUInteger totalSize = MIN(_termWidth,100);
 
   NSUInteger statusSize = status.length + 4; // 4 extra for '... '
@@ -601,6 +795,16 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
     return NO;
   }
 
+  // statistics, output format, path rules, batch + benchmark options aren't part of the export configuration
+  _printStats = [argParser isOptionSet:CLIOptionKindStats];
+  _writeStatsFile = [argParser isOptionSet:CLIOptionKindStatsFile];
+  _outputFormatName = [argParser stringValueForOption:CLIOptionKindOutputFormat];
+  _remapRulesPath = [[argParser stringValueForOption:CLIOptionKindRemapRules] stringByExpandingTildeInPath];
+  _batchConfigPath = [[argParser stringValueForOption:CLIOptionKindBatch] stringByExpandingTildeInPath];
+  _benchmarkFixturePath = [[argParser stringValueForOption:CLIOptionKindFixture] stringByExpandingTildeInPath];
+  _benchmarkSyntheticSpecifier = [argParser stringValueForOption:CLIOptionKindSynthetic];
+  _benchmarkIterations = [argParser stringValueForOption:CLIOptionKindIterations];
+
   // extended configuration validation
   switch (_command) {
     case CLICommandKindHelp:
@@ -615,6 +819,12 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
       }
       break;
     }
+    case CLICommandKindBenchmark: {
+      if (![self validateBenchmarkOptionsAndReturnError:error]) {
+        return NO;
+      }
+      break;
+    }
   }
 
   return YES;
@@ -624,14 +834,138 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
 
   MLE_Log_Info(@"CLIManager [exportLibraryAndReturnError]");
 
+  if (_batchConfigPath != nil) {
+    return [self exportBatchAndReturnError:error];
+  }
+
   ExportManager* exportManager = [[ExportManager alloc] initWithConfiguration:_configuration];
   [exportManager setDelegate:self];
   [exportManager setOutputFileURL:_configuration.outputFileUrl];
+  [exportManager setOutputFormat:_outputFormat];
+  if (_remapRulesPath != nil) {
+    [exportManager setRemapRulesFileURL:[NSURL fileURLWithPath:_remapRulesPath]];
+  }
+  [exportManager setWriteMetricsFile:_writeStatsFile];
 
   NSError* exportError;
   return [exportManager exportLibraryWithError:&exportError];
 }
 
+- (BOOL)exportBatchAndReturnError:(NSError**)error {
+
+  MLE_Log_Info(@"CLIManager [exportBatchAndReturnError]");
+
+  // options given on the command line are the defaults for every target
+  NSMutableDictionary* baseValues = [[_configuration dictionaryRepresentation] mutableCopy];
+  [baseValues setValue:PlistWriterFormatNames[_outputFormat] forKey:BatchExportManagerKeyOutputFormat];
+  [baseValues setValue:_remapRulesPath forKey:BatchExportManagerKeyRemapRulesPath];
+
+  BatchExportManager* batchExportManager = [[BatchExportManager alloc] init];
+  if (![batchExportManager addTargetsFromURL:[NSURL fileURLWithPath:_batchConfigPath] withBaseValues:baseValues error:error]) {
+    return NO;
+  }
+
+  // targets are exported concurrently, so there is no per-target progress
+  for (ExportManager* target in batchExportManager.targets) {
+    [target setWriteMetricsFile:_writeStatsFile];
+  }
+
+  // ctrl-c stops every target without replacing the existing output files
+  signal(SIGINT, SIG_IGN);
+  dispatch_source_t interruptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_SIGNAL, SIGINT, 0, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0));
+  dispatch_source_set_event_handler(interruptSource, ^{
+    [batchExportManager cancel];
+  });
+  dispatch_resume(interruptSource);
+
+  NSString* status = [NSString stringWithFormat:@"exporting %lu libraries", batchExportManager.targets.count];
+  [self printStatus:status];
+  BOOL exportSuccessful = [batchExportManager exportLibraryWithError:error];
+
+  dispatch_source_cancel(interruptSource);
+  signal(SIGINT, SIG_DFL);
+
+  if (!exportSuccessful) {
+    printf("\n");
+    return NO;
+  }
+  [self printStatusDone:status];
+
+  for (ExportManager* target in batchExportManager.targets) {
+    printf("  %s\n", target.outputFileURL.path.UTF8String);
+    if (_printStats) {
+      printf("\n%s", [target.metrics describe].UTF8String);
+    }
+  }
+
+  return YES;
+}
+
+- (BOOL)runBenchmarkAndReturnError:(NSError**)error {
+
+  MLE_Log_Info(@"CLIManager [runBenchmarkAndReturnError]");
+
+  NSURL* libraryURL;
+  NSURL* syntheticLibraryURL = nil;
+  NSDictionary* sortProperties = _configuration.playlistCustomSortPropertyDict;
+  NSDictionary* sortOrders = _configuration.playlistCustomSortOrderDict;
+
+  if (_benchmarkFixturePath != nil) {
+    libraryURL = [NSURL fileURLWithPath:_benchmarkFixturePath];
+  }
+  else {
+
+    SyntheticLibraryGenerator* generator = [[SyntheticLibraryGenerator alloc] init];
+    if (_benchmarkSyntheticSpecifier != nil && ![generator applySpecifier:_benchmarkSyntheticSpecifier error:error]) {
+      return NO;
+    }
+
+    NSString* fileName = [NSString stringWithFormat:@"mle-benchmark-library-%@.xml", NSUUID.UUID.UUIDString];
+    syntheticLibraryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+
+    NSString* status = [NSString stringWithFormat:@"generating synthetic library (%@)", [generator describeParameters]];
+    [self printStatus:status];
+    if (![generator writeLibraryToURL:syntheticLibraryURL error:error]) {
+      return NO;
+    }
+    [self printStatusDone:status];
+
+    libraryURL = syntheticLibraryURL;
+
+    // custom sorting from --sort can't refer to generated playlists
+    sortProperties = generator.sortProperties;
+    sortOrders = generator.sortOrders;
+  }
+
+  ExportBenchmark* benchmark = [[ExportBenchmark alloc] initWithLibraryURL:libraryURL];
+  [benchmark setCustomSortProperties:sortProperties];
+  [benchmark setCustomSortOrders:sortOrders];
+  if (_benchmarkIterations != nil) {
+    [benchmark setIterations:_benchmarkIterations.integerValue];
+  }
+
+  [self printStatus:@"running benchmark"];
+  NSArray<ExportBenchmarkStageResult*>* results = [benchmark runAndReturnError:error];
+  if (results != nil) {
+    [self printStatusDone:@"running benchmark"];
+  }
+
+  if (syntheticLibraryURL != nil) {
+    [[NSFileManager defaultManager] removeItemAtURL:syntheticLibraryURL error:nil];
+  }
+
+  if (results == nil) {
+    return NO;
+  }
+
+  printf("\n");
+  for (ExportBenchmarkStageResult* result in results) {
+    printf("%s\n", [result describe].UTF8String);
+  }
+
+  return YES;
+}
+
 
 #pragma mark - ExportManagerDelegate
 
@@ -639,6 +973,7 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
 
   switch (oldState) {
     case ExportFinished:
+    case ExportUnchanged:
     case ExportStopped:
     case ExportError: {
       break;
@@ -677,6 +1012,10 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
     case ExportError: {
       break;
     }
+    case ExportUnchanged: {
+      printf("library is unchanged, the existing file was kept\n");
+      break;
+    }
     case ExportPreparing: {
       [self printStatus:@"preparing for export"];
       break;
@@ -714,6 +1053,13 @@ NSUInteger const __MLE_PlaylistTableColumnMargin = 2;
   }
 }
 
+- (void)exportFinishedWithMetrics:(ExportMetrics*)metrics {
+
+  if (_printStats) {
+    printf("\n%s", [metrics describe].UTF8String);
+  }
+}
+
 - (void)excludedPlaylist:(ITLibPlaylist*)playlist {
 
   if (_playlistParentIDFilter != nil) {
@@ -40,6 +40,11 @@ int main(int argc, const char * argv[]) {
         break;
       }
 
+      case CLICommandKindBenchmark: {
+        commandSuccess = [cliManager runBenchmarkAndReturnError:&commandError];
+        break;
+      }
+
       case CLICommandKindPrint: {
         [cliManager printPlaylists];
         break;